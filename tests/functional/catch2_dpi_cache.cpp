@@ -0,0 +1,186 @@
+/**
+ * Per-monitor DPI Cache Tests
+ * Using Catch2 framework
+ *
+ * Runs upstream/src/dpi_cache.cpp against a mocked platform layer that counts the
+ * system calls the cache makes, no display needed.
+ */
+
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "dpi_cache.h"
+
+namespace {
+
+class CountingPlatform : public DpiPlatform {
+public:
+    struct Monitor {
+        ScreenRect area;
+        unsigned int dpi;  // 0: GetDpiForMonitor fails
+    };
+
+    std::vector<Monitor> monitors;
+    unsigned int systemDpi = 96;
+
+    int enumCalls = 0;
+    int monitorDpiCalls = 0;
+    int systemDpiCalls = 0;
+
+    void EnumMonitors(std::vector<MonitorArea>& result) override {
+        ++enumCalls;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            MonitorArea area = {Handle(i), monitors[i].area};
+            result.push_back(area);
+        }
+    }
+
+    unsigned int QueryMonitorDpi(MonitorHandle monitor) override {
+        ++monitorDpiCalls;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            if (Handle(i) == monitor)
+                return monitors[i].dpi;
+        }
+        return 0;
+    }
+
+    unsigned int QuerySystemDpi() override {
+        ++systemDpiCalls;
+        return systemDpi;
+    }
+
+    int TotalCalls() const { return enumCalls + monitorDpiCalls + systemDpiCalls; }
+
+    // Handles are opaque: any distinct non-null values will do
+    static MonitorHandle Handle(size_t index) {
+        return reinterpret_cast<MonitorHandle>(static_cast<size_t>(0x1000 + index * 0x10));
+    }
+};
+
+// 1920x1080 at 100% on the left, 2560x1440 at 150% on the right, 1280x1024 at 125% above
+CountingPlatform MakeThreeMonitors() {
+    CountingPlatform platform;
+    platform.monitors.push_back({{0, 0, 1920, 1080}, 96});
+    platform.monitors.push_back({{1920, 0, 2560, 1440}, 144});
+    platform.monitors.push_back({{0, -1024, 1280, 1024}, 120});
+    return platform;
+}
+
+}  // namespace
+
+TEST_CASE("DPI lookups resolve monitors like the system", "[functional][dpi][cache]") {
+    CountingPlatform platform = MakeThreeMonitors();
+    DpiCache cache(platform);
+
+    SECTION("Point inside a monitor") {
+        CHECK(cache.GetDpiForPoint(100, 100) == 96);
+        CHECK(cache.GetDpiForPoint(3000, 700) == 144);
+        CHECK(cache.GetDpiForPoint(640, -500) == 120);
+        CHECK(cache.GetMonitorFromPoint(1920, 0) == CountingPlatform::Handle(1));
+    }
+
+    SECTION("Point outside every monitor goes to the nearest one") {
+        CHECK(cache.GetDpiForPoint(-50, 500) == 96);
+        CHECK(cache.GetDpiForPoint(5000, 100) == 144);
+        CHECK(cache.GetDpiForPoint(600, -2000) == 120);
+    }
+
+    SECTION("Rect goes to the monitor with the largest intersection") {
+        ScreenRect mostlyRight = {1800, 100, 800, 600};
+        ScreenRect mostlyLeft = {1500, 100, 800, 600};
+        ScreenRect offScreen = {1900, 1500, 100, 100};
+        CHECK(cache.GetDpiForRect(mostlyRight) == 144);
+        CHECK(cache.GetDpiForRect(mostlyLeft) == 96);
+        CHECK(cache.GetMonitorFromRect(offScreen) == CountingPlatform::Handle(1));
+    }
+
+    SECTION("Monitor handle lookup") {
+        CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(2)) == 120);
+    }
+}
+
+TEST_CASE("DPI queries per 1000 lookups", "[functional][dpi][cache][performance]") {
+    CountingPlatform platform = MakeThreeMonitors();
+    DpiCache cache(platform);
+
+    for (int i = 0; i < 1000; ++i) {
+        cache.GetDpiForPoint((i * 37) % 4480 - 100, (i * 53) % 2500 - 1024);
+        ScreenRect rect = {(i * 61) % 4000, (i * 17) % 1200 - 500, 800, 600};
+        cache.GetDpiForRect(rect);
+        cache.GetDpiForMonitor(CountingPlatform::Handle(i % 3));
+    }
+
+    // One enumeration and one DPI query per monitor, whatever the number of lookups
+    INFO("enum " << platform.enumCalls << ", monitor dpi " << platform.monitorDpiCalls
+                 << ", system dpi " << platform.systemDpiCalls);
+    CHECK(platform.enumCalls == 1);
+    CHECK(platform.monitorDpiCalls == 3);
+    CHECK(platform.systemDpiCalls == 0);
+    CHECK(platform.TotalCalls() == 4);
+}
+
+TEST_CASE("DPI cache follows display changes", "[functional][dpi][cache]") {
+    CountingPlatform platform = MakeThreeMonitors();
+    DpiCache cache(platform);
+
+    CHECK(cache.GetDpiForPoint(3000, 700) == 144);
+
+    SECTION("Invalidate rebuilds once, on the next lookup") {
+        platform.monitors[1].dpi = 192;
+        cache.Invalidate();
+        CHECK(platform.enumCalls == 1);
+
+        for (int i = 0; i < 1000; ++i)
+            CHECK(cache.GetDpiForPoint(3000, 700) == 192);
+
+        CHECK(platform.enumCalls == 2);
+        CHECK(platform.monitorDpiCalls == 6);
+    }
+
+    SECTION("Unknown handle rebuilds once per invalidation") {
+        platform.monitors.push_back({{-1920, 0, 1920, 1080}, 168});
+        CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(3)) == 168);
+        CHECK(platform.enumCalls == 2);
+
+        // A stale handle held by a caller: system DPI, no rebuild until Invalidate()
+        for (int i = 0; i < 1000; ++i)
+            CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(9)) == 96);
+        CHECK(platform.enumCalls == 2);
+        CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(0)) == 96);
+        CHECK(platform.enumCalls == 2);
+
+        // After Invalidate(), the next lookup enumerates once and the handle is still stale
+        cache.Invalidate();
+        CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(9)) == 96);
+        CHECK(platform.enumCalls == 3);
+        CHECK(cache.GetDpiForMonitor(CountingPlatform::Handle(9)) == 96);
+        CHECK(platform.enumCalls == 3);
+    }
+}
+
+TEST_CASE("GDI system DPI is only a fallback", "[functional][dpi][cache]") {
+    CountingPlatform platform = MakeThreeMonitors();
+    platform.monitors[2].dpi = 0;
+    platform.systemDpi = 120;
+    DpiCache cache(platform);
+
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(cache.GetDpiForPoint(640, -500) == 120);
+        CHECK(cache.GetDpiForPoint(100, 100) == 96);
+    }
+
+    // Read once for the failing monitor, then cached with it
+    CHECK(platform.systemDpiCalls == 1);
+
+    SECTION("No monitor at all") {
+        CountingPlatform empty;
+        empty.systemDpi = 144;
+        DpiCache emptyCache(empty);
+
+        CHECK(emptyCache.GetDpiForPoint(0, 0) == 144);
+        CHECK(emptyCache.GetDpiForPoint(10, 10) == 144);
+        CHECK(empty.systemDpiCalls == 1);
+        CHECK(emptyCache.GetMonitorFromPoint(0, 0) == nullptr);
+    }
+}
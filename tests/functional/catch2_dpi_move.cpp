@@ -0,0 +1,220 @@
+/**
+ * DPI-correct Cross-Monitor Move Tests
+ * Using Catch2 framework
+ *
+ * Runs upstream/src/dpi_move.cpp against simulated monitors, no display needed.
+ * The simulated window behaves like a per-monitor DPI aware application: when it
+ * lands on a monitor with another scale factor it rescales itself (WM_DPICHANGED).
+ */
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "dpi_move.h"
+
+namespace {
+
+struct SimulatedMonitor {
+    ScreenRect work;
+    unsigned int dpi;
+};
+
+class SimulatedWindow : public WindowMoveBackend {
+public:
+    SimulatedWindow(const std::vector<SimulatedMonitor>& monitors, ScreenRect rect, bool perMonitorAware)
+        : m_monitors(monitors), m_rect(rect), m_perMonitorAware(perMonitorAware),
+          m_setCount(0), m_relayouts(0) {
+        m_dpi = m_monitors[MonitorOf(rect)].dpi;
+    }
+
+    ScreenRect GetRect() override { return m_rect; }
+
+    void SetRect(const ScreenRect& rect, bool resize) override {
+        ++m_setCount;
+
+        ScreenRect next = rect;
+        if (!resize) {
+            next.width = m_rect.width;
+            next.height = m_rect.height;
+        }
+        if (next.width != m_rect.width || next.height != m_rect.height)
+            ++m_relayouts;
+
+        // The system picks the monitor with the largest intersection
+        unsigned int newDpi = m_monitors[MonitorOf(next)].dpi;
+        if (m_perMonitorAware && newDpi != m_dpi) {
+            // WM_DPICHANGED: the application rescales itself, keeping its top-left corner
+            next.width = ScaleDimension(next.width, newDpi, m_dpi);
+            next.height = ScaleDimension(next.height, newDpi, m_dpi);
+            ++m_relayouts;
+        }
+
+        m_dpi = newDpi;
+        m_rect = next;
+    }
+
+    bool IsPerMonitorDpiAware() override { return m_perMonitorAware; }
+
+    int SetCount() const { return m_setCount; }
+    int Relayouts() const { return m_relayouts; }
+
+private:
+    size_t MonitorOf(const ScreenRect& rect) const {
+        size_t best = 0;
+        long long bestArea = -1;
+        for (size_t i = 0; i < m_monitors.size(); ++i) {
+            const ScreenRect& m = m_monitors[i].work;
+            long long w = (std::min)(rect.x + rect.width, m.x + m.width) - (std::max)(rect.x, m.x);
+            long long h = (std::min)(rect.y + rect.height, m.y + m.height) - (std::max)(rect.y, m.y);
+            long long area = (w > 0 && h > 0) ? w * h : 0;
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    std::vector<SimulatedMonitor> m_monitors;
+    ScreenRect m_rect;
+    bool m_perMonitorAware;
+    unsigned int m_dpi;
+    int m_setCount;
+    int m_relayouts;
+};
+
+// Physical work area of a 1920x1080 logical screen (minus a 40px taskbar) at the given DPI
+SimulatedMonitor MakeMonitor(int x, unsigned int dpi) {
+    SimulatedMonitor monitor;
+    monitor.work.x = x;
+    monitor.work.y = 0;
+    monitor.work.width = ScaleDimension(1920, dpi, 96);
+    monitor.work.height = ScaleDimension(1040, dpi, 96);
+    monitor.dpi = dpi;
+    return monitor;
+}
+
+ScreenInfo ToScreenInfo(const SimulatedMonitor& monitor) {
+    ScreenInfo info = {monitor.work, monitor.dpi};
+    return info;
+}
+
+bool IsNear(const ScreenRect& a, const ScreenRect& b) {
+    return std::abs(a.x - b.x) <= 1 && std::abs(a.y - b.y) <= 1 &&
+           std::abs(a.width - b.width) <= 1 && std::abs(a.height - b.height) <= 1;
+}
+
+}  // namespace
+
+TEST_CASE("DPI scaling helpers", "[functional][dpi][unit]") {
+    SECTION("ScaleDimension rounds like MulDiv") {
+        CHECK(ScaleDimension(100, 144, 96) == 150);
+        CHECK(ScaleDimension(101, 120, 96) == 126);  // 126.25
+        CHECK(ScaleDimension(-100, 144, 96) == -150);
+        CHECK(ScaleDimension(100, 96, 0) == 100);
+    }
+
+    SECTION("PreScaleForDpi is the inverse of the application rescale") {
+        ScreenRect target = {100, 50, 1201, 801};
+        ScreenRect sent = PreScaleForDpi(target, 96, 144);
+        CHECK(sent.x == 100);
+        CHECK(sent.y == 50);
+        CHECK(std::abs(ScaleDimension(sent.width, 144, 96) - target.width) <= 1);
+        CHECK(std::abs(ScaleDimension(sent.height, 144, 96) - target.height) <= 1);
+    }
+
+    SECTION("Same DPI leaves the rect untouched") {
+        ScreenRect target = {10, 20, 300, 400};
+        ScreenRect sent = PreScaleForDpi(target, 120, 120);
+        CHECK(sent.width == 300);
+        CHECK(sent.height == 400);
+    }
+}
+
+TEST_CASE("Cross-monitor move matrix", "[functional][dpi][multimonitor]") {
+    const unsigned int dpis[] = {96, 120, 144, 192};  // 100%, 125%, 150%, 200%
+
+    for (unsigned int fromDpi : dpis) {
+        for (unsigned int toDpi : dpis) {
+            DYNAMIC_SECTION("Per-monitor aware window " << fromDpi * 100 / 96 << "% -> "
+                                                        << toDpi * 100 / 96 << "%") {
+                SimulatedMonitor from = MakeMonitor(0, fromDpi);
+                SimulatedMonitor to = MakeMonitor(from.work.width, toDpi);
+                std::vector<SimulatedMonitor> monitors = {from, to};
+
+                ScreenRect start = {from.work.x + from.work.width / 8, from.work.height / 8,
+                                    from.work.width / 2, from.work.height / 2};
+                SimulatedWindow window(monitors, start, true);
+
+                ScreenRect expected = MapRectToScreen(start, ToScreenInfo(from), ToScreenInfo(to));
+                int moves = MoveWindowToScreen(window, ToScreenInfo(from), ToScreenInfo(to), true);
+
+                INFO("final " << window.GetRect().width << "x" << window.GetRect().height
+                              << " expected " << expected.width << "x" << expected.height);
+                CHECK(IsNear(window.GetRect(), expected));
+                CHECK(moves == 1);
+                CHECK(window.SetCount() == 1);
+            }
+
+            DYNAMIC_SECTION("DPI unaware window " << fromDpi * 100 / 96 << "% -> "
+                                                  << toDpi * 100 / 96 << "%") {
+                SimulatedMonitor from = MakeMonitor(0, fromDpi);
+                SimulatedMonitor to = MakeMonitor(from.work.width, toDpi);
+                std::vector<SimulatedMonitor> monitors = {from, to};
+
+                ScreenRect start = {from.work.width / 4, from.work.height / 4, 640, 480};
+                SimulatedWindow window(monitors, start, false);
+
+                ScreenRect expected = MapRectToScreen(start, ToScreenInfo(from), ToScreenInfo(to));
+                int moves = MoveWindowToScreen(window, ToScreenInfo(from), ToScreenInfo(to), true);
+
+                CHECK(IsNear(window.GetRect(), expected));
+                CHECK(moves == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Cross-monitor move without pre-scaling bounces", "[functional][dpi][multimonitor]") {
+    // Documents the behaviour the pre-scaling avoids: sending the final size directly
+    // leaves an aware window rescaled a second time by the application
+    SimulatedMonitor from = MakeMonitor(0, 96);
+    SimulatedMonitor to = MakeMonitor(from.work.width, 192);
+    std::vector<SimulatedMonitor> monitors = {from, to};
+
+    ScreenRect start = {100, 100, 800, 600};
+    SimulatedWindow window(monitors, start, true);
+
+    ScreenRect expected = MapRectToScreen(start, ToScreenInfo(from), ToScreenInfo(to));
+    window.SetRect(expected, true);
+
+    CHECK_FALSE(IsNear(window.GetRect(), expected));
+    CHECK(window.Relayouts() == 2);
+}
+
+TEST_CASE("Verification corrects an application ignoring WM_DPICHANGED", "[functional][dpi]") {
+    // Claims per-monitor awareness but keeps the size it is given
+    class StubbornWindow : public WindowMoveBackend {
+    public:
+        ScreenRect rect;
+        int setCount = 0;
+        ScreenRect GetRect() override { return rect; }
+        void SetRect(const ScreenRect& r, bool) override { rect = r; ++setCount; }
+        bool IsPerMonitorDpiAware() override { return true; }
+    };
+
+    SimulatedMonitor from = MakeMonitor(0, 96);
+    SimulatedMonitor to = MakeMonitor(from.work.width, 144);
+
+    StubbornWindow window;
+    window.rect = {200, 200, 800, 600};
+
+    ScreenRect expected = MapRectToScreen(window.rect, ToScreenInfo(from), ToScreenInfo(to));
+    int moves = MoveWindowToScreen(window, ToScreenInfo(from), ToScreenInfo(to), true);
+
+    CHECK(IsNear(window.rect, expected));
+    CHECK(moves == 2);
+}
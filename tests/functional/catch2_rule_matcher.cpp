@@ -0,0 +1,141 @@
+/**
+ * Placement Rule Matcher Tests
+ * Using Catch2 framework
+ *
+ * Runs upstream/src/rule_matcher.cpp directly, no window needed.
+ */
+
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+#include "rule_matcher.h"
+
+namespace {
+
+// A rules file as written by hand: specific rules first, catch-alls last
+void AddTypicalRules(RuleMatcher& matcher, int count) {
+    for (int i = 0; i < count; ++i) {
+        std::wstring n = std::to_wstring(i);
+        matcher.AddRule(L"app" + n + L".exe", L"", L"");
+        matcher.AddRule(L"tool" + n + L"*", L"Window" + n, L"");
+        matcher.AddRule(L"", L"", L"*Report " + n + L" - *");
+    }
+    matcher.AddRule(L"re:.*editor[0-9]+\\.exe", L"", L"");
+    matcher.AddRule(L"*", L"ConsoleWindowClass", L"");
+}
+
+}  // namespace
+
+TEST_CASE("Pattern kinds", "[functional][rules]") {
+    RuleMatcher matcher;
+
+    SECTION("Empty and star match anything") {
+        REQUIRE(matcher.AddRule(L"", L"*", L"") == 0);
+        CHECK(matcher.Match(L"any.exe", L"AnyClass", L"Any title") == 0);
+        CHECK(matcher.Match(L"", L"", L"") == 0);
+    }
+
+    SECTION("Exact is case-insensitive and whole") {
+        matcher.AddRule(L"Notepad.exe", L"", L"");
+        CHECK(matcher.Match(L"NOTEPAD.EXE", L"Notepad", L"") == 0);
+        CHECK(matcher.Match(L"notepad.exe2", L"Notepad", L"") == -1);
+        CHECK(matcher.Match(L"notepad", L"Notepad", L"") == -1);
+    }
+
+    SECTION("Prefix") {
+        matcher.AddRule(L"", L"Chrome_*", L"");
+        CHECK(matcher.Match(L"chrome.exe", L"Chrome_WidgetWin_1", L"") == 0);
+        CHECK(matcher.Match(L"chrome.exe", L"chrome_", L"") == 0);
+        CHECK(matcher.Match(L"chrome.exe", L"Chrome", L"") == -1);
+    }
+
+    SECTION("Glob with star and question mark") {
+        matcher.AddRule(L"", L"", L"*- Visual Studio ?ode");
+        CHECK(matcher.Match(L"code.exe", L"", L"main.cpp - Visual Studio Code") == 0);
+        CHECK(matcher.Match(L"code.exe", L"", L"- visual studio code") == 0);
+        CHECK(matcher.Match(L"code.exe", L"", L"main.cpp - Visual Studio Codes") == -1);
+        CHECK(RuleMatcher::GlobMatch(L"a*b*c", L"axxbyyc"));
+        CHECK_FALSE(RuleMatcher::GlobMatch(L"a*b*c", L"axxbyy"));
+        CHECK(RuleMatcher::GlobMatch(L"*", L""));
+    }
+
+    SECTION("Regex must match the whole string, case-insensitive") {
+        matcher.AddRule(L"", L"", L"re:Untitled - [a-z]+");
+        CHECK(matcher.Match(L"", L"", L"untitled - NOTEPAD") == 0);
+        CHECK(matcher.Match(L"", L"", L"Untitled - Notepad 2") == -1);
+    }
+
+    SECTION("Glob and regex process patterns") {
+        matcher.AddRule(L"*player?.exe", L"", L"");
+        matcher.AddRule(L"re:(vlc|mpv)\\.exe", L"", L"");
+        CHECK(matcher.Match(L"MediaPlayer2.exe", L"", L"") == 0);
+        CHECK(matcher.Match(L"mpv.exe", L"", L"") == 1);
+        CHECK(matcher.Match(L"mpv2.exe", L"", L"") == -1);
+    }
+
+    SECTION("Invalid regex is rejected without side effect") {
+        CHECK(matcher.AddRule(L"re:(unclosed", L"", L"") == -1);
+        CHECK(matcher.AddRule(L"a.exe", L"re:[", L"") == -1);
+        CHECK(matcher.IsEmpty());
+        REQUIRE(matcher.AddRule(L"", L"", L"re:ok") == 0);
+        CHECK(matcher.Match(L"", L"", L"OK") == 0);
+    }
+}
+
+TEST_CASE("First rule of the file wins", "[functional][rules]") {
+    RuleMatcher matcher;
+    REQUIRE(matcher.AddRule(L"", L"", L"*Draft*") == 0);
+    REQUIRE(matcher.AddRule(L"word*", L"", L"") == 1);
+    REQUIRE(matcher.AddRule(L"winword.exe", L"", L"") == 2);
+    REQUIRE(matcher.AddRule(L"re:win.*", L"", L"") == 3);
+
+    SECTION("An earlier catch-all beats a later exact process") {
+        CHECK(matcher.Match(L"winword.exe", L"", L"Draft.docx") == 0);
+    }
+
+    SECTION("Exact, then regex, in file order") {
+        CHECK(matcher.Match(L"winword.exe", L"", L"Report.docx") == 2);
+        CHECK(matcher.Match(L"winamp.exe", L"", L"") == 3);
+    }
+
+    SECTION("Prefix found along the trie") {
+        CHECK(matcher.Match(L"wordpad.exe", L"", L"") == 1);
+    }
+
+    SECTION("Every pattern of a rule must match") {
+        RuleMatcher strict;
+        strict.AddRule(L"notepad.exe", L"Notepad", L"*.txt*");
+        strict.AddRule(L"notepad.exe", L"", L"");
+        CHECK(strict.Match(L"notepad.exe", L"Notepad", L"a.txt - Notepad") == 0);
+        CHECK(strict.Match(L"notepad.exe", L"Notepad", L"a.log - Notepad") == 1);
+    }
+
+    SECTION("Clear forgets every rule") {
+        matcher.Clear();
+        CHECK(matcher.IsEmpty());
+        CHECK(matcher.Match(L"winword.exe", L"", L"Draft") == -1);
+        CHECK(matcher.AddRule(L"a.exe", L"", L"") == 0);
+    }
+}
+
+TEST_CASE("Matching against 300 rules", "[functional][rules][!benchmark]") {
+    RuleMatcher matcher;
+    AddTypicalRules(matcher, 100);
+    REQUIRE(matcher.Size() == 302);
+
+    CHECK(matcher.Match(L"app57.exe", L"", L"") == 171);
+    CHECK(matcher.Match(L"conhost.exe", L"ConsoleWindowClass", L"") == 301);
+
+    BENCHMARK("exact process") {
+        return matcher.Match(L"app57.exe", L"Main", L"Untitled");
+    };
+
+    BENCHMARK("no rule matches") {
+        return matcher.Match(L"explorer.exe", L"CabinetWClass", L"Documents");
+    };
+
+    BENCHMARK("title glob") {
+        return matcher.Match(L"excel.exe", L"XLMAIN", L"Monthly Report 99 - Excel");
+    };
+}
@@ -0,0 +1,128 @@
+/**
+ * Fusion Split Tree Tests
+ * Using Catch2 framework
+ *
+ * Runs upstream/src/split_tree.cpp on a simulated work area, no display needed.
+ */
+
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "split_tree.h"
+
+namespace {
+
+const ScreenRect WORK = {0, 0, 1920, 1040};
+
+long long Area(const ScreenRect& rect) {
+    return (long long)rect.width * rect.height;
+}
+
+bool Overlap(const ScreenRect& a, const ScreenRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height &&
+           b.y < a.y + a.height;
+}
+
+void CheckPartition(const std::vector<ScreenRect>& rects) {
+    long long total = 0;
+    for (size_t i = 0; i < rects.size(); ++i) {
+        total += Area(rects[i]);
+        for (size_t j = i + 1; j < rects.size(); ++j)
+            CHECK_FALSE(Overlap(rects[i], rects[j]));
+    }
+    CHECK(total == Area(WORK));
+}
+
+}  // namespace
+
+TEST_CASE("Two windows behave like the former Fusion", "[functional][fusion]") {
+    SplitTree tree;
+    std::vector<ScreenRect> rects;
+
+    tree.Build(2);
+    REQUIRE(tree.GetSplitCount() == 1);
+
+    SECTION("Side by side, slider at 30%") {
+        tree.SetRatio(0, 15 / 50.);
+        tree.Layout(WORK, rects);
+        CHECK(rects[0].width == 576);
+        CHECK(rects[1].x == 576);
+        CHECK(rects[1].width == 1344);
+        CHECK(rects[1].height == WORK.height);
+    }
+
+    SECTION("Stacked, centred") {
+        tree.SetOrientation(SPLIT_STACKED);
+        tree.Layout(WORK, rects);
+        CHECK(rects[0].height == 520);
+        CHECK(rects[1].y == 520);
+        CHECK(rects[1].width == WORK.width);
+    }
+}
+
+TEST_CASE("N windows share the area without gap", "[functional][fusion]") {
+    SplitTree tree;
+    std::vector<ScreenRect> rects;
+
+    for (size_t count = 1; count <= 6; ++count) {
+        INFO(count << " windows");
+        tree.Build(count);
+        CHECK(tree.GetSplitCount() == count - 1);
+
+        tree.Layout(WORK, rects);
+        REQUIRE(rects.size() == count);
+        CheckPartition(rects);
+
+        // Default ratios: same area for every window (up to rounding)
+        double share = double(Area(WORK)) / count;
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(Area(rects[i]) > share * 0.99);
+            CHECK(Area(rects[i]) < share * 1.01);
+        }
+
+        // Any ratio keeps the partition
+        for (size_t split = 0; split < tree.GetSplitCount(); ++split)
+            tree.SetRatio(split, 0.13 + 0.17 * split);
+        tree.Layout(WORK, rects);
+        CheckPartition(rects);
+    }
+}
+
+TEST_CASE("Splits alternate and describe their windows", "[functional][fusion]") {
+    SplitTree tree;
+    std::vector<ScreenRect> rects;
+    size_t begin, firstCount, count;
+
+    tree.Build(4);
+    tree.Layout(WORK, rects);
+
+    // 2 x 2: the first split is side by side, the next ones stacked
+    CHECK(tree.GetOrientation(0) == SPLIT_SIDE_BY_SIDE);
+    CHECK(tree.GetOrientation(1) == SPLIT_STACKED);
+    CHECK(rects[3].x == 960);
+    CHECK(rects[3].y == 520);
+
+    tree.GetWindows(0, begin, firstCount, count);
+    CHECK(begin == 0);
+    CHECK(firstCount == 2);
+    CHECK(count == 4);
+    tree.GetWindows(2, begin, firstCount, count);
+    CHECK(begin == 2);
+    CHECK(firstCount == 1);
+
+    SECTION("Moving a split only changes the windows below it") {
+        std::vector<ScreenRect> before = rects;
+        tree.SetRatio(2, 0.25);
+        tree.Layout(WORK, rects);
+        CHECK(Area(rects[0]) == Area(before[0]));
+        CHECK(Area(rects[1]) == Area(before[1]));
+        CHECK(rects[2].height == 260);
+    }
+
+    SECTION("Reset gives equal areas back") {
+        tree.SetRatio(0, 0.9);
+        tree.ResetRatio(0);
+        CHECK(tree.GetRatio(0) == 0.5);
+    }
+}
@@ -0,0 +1,221 @@
+/**
+ * Mosaic Tiling Engine Tests
+ * Using Catch2 framework
+ *
+ * Runs upstream/src/tiling.cpp on simulated work areas, no display needed.
+ * The benchmarks are hidden by default: functional_tests "[!benchmark]"
+ */
+
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "tiling.h"
+
+namespace {
+
+const ScreenRect LANDSCAPE = {0, 0, 1920, 1040};
+const ScreenRect PORTRAIT = {1920, -200, 1080, 1880};
+const TILING_ALGORITHM ALGORITHMS[] = {TILING_GRID, TILING_MASTER_STACK, TILING_SQUARIFIED};
+
+TilingOptions MakeOptions(TILING_ALGORITHM algorithm, int gap = 0) {
+    TilingOptions options = {algorithm, 60, gap};
+    return options;
+}
+
+// Window areas as found on a desktop: a few large windows, many small ones
+std::vector<double> MakeWeights(size_t count) {
+    std::vector<double> weights;
+    for (size_t i = 0; i < count; ++i)
+        weights.push_back(double((i * 7919) % 1500 + 200) * double((i * 104729) % 900 + 150));
+    return weights;
+}
+
+bool Inside(const ScreenRect& area, const ScreenRect& tile) {
+    return tile.x >= area.x && tile.y >= area.y && tile.x + tile.width <= area.x + area.width &&
+           tile.y + tile.height <= area.y + area.height;
+}
+
+bool Overlap(const ScreenRect& a, const ScreenRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height &&
+           b.y < a.y + a.height;
+}
+
+long long Area(const ScreenRect& rect) {
+    return (long long)rect.width * rect.height;
+}
+
+// Without gap the tiles must cover the area exactly: inside, disjoint, same total area
+void CheckPartition(const ScreenRect& area, const std::vector<ScreenRect>& tiles) {
+    long long total = 0;
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        INFO("tile " << i << " of " << tiles.size());
+        REQUIRE(tiles[i].width > 0);
+        REQUIRE(tiles[i].height > 0);
+        REQUIRE(Inside(area, tiles[i]));
+        total += Area(tiles[i]);
+
+        for (size_t j = i + 1; j < tiles.size(); ++j)
+            REQUIRE_FALSE(Overlap(tiles[i], tiles[j]));
+    }
+
+    CHECK(total == Area(area));
+}
+
+}  // namespace
+
+TEST_CASE("Tiles cover the work area exactly", "[functional][tiling]") {
+    std::vector<ScreenRect> tiles;
+
+    for (TILING_ALGORITHM algorithm : ALGORITHMS) {
+        for (size_t count = 1; count <= 200; count += (count < 20 ? 1 : 17)) {
+            INFO("algorithm " << algorithm << ", " << count << " windows");
+            std::vector<double> weights = MakeWeights(count);
+
+            ComputeTiling(LANDSCAPE, weights, MakeOptions(algorithm), tiles);
+            REQUIRE(tiles.size() == count);
+            CheckPartition(LANDSCAPE, tiles);
+
+            ComputeTiling(PORTRAIT, weights, MakeOptions(algorithm), tiles);
+            REQUIRE(tiles.size() == count);
+            CheckPartition(PORTRAIT, tiles);
+        }
+    }
+}
+
+TEST_CASE("Layouts follow their algorithm", "[functional][tiling]") {
+    std::vector<ScreenRect> tiles;
+
+    SECTION("A single window takes the whole area") {
+        for (TILING_ALGORITHM algorithm : ALGORITHMS) {
+            ComputeTiling(LANDSCAPE, std::vector<double>(1, 1.), MakeOptions(algorithm), tiles);
+            REQUIRE(tiles.size() == 1);
+            CHECK(Area(tiles[0]) == Area(LANDSCAPE));
+        }
+    }
+
+    SECTION("Grid of four windows is two by two") {
+        ComputeTiling(LANDSCAPE, MakeWeights(4), MakeOptions(TILING_GRID), tiles);
+        REQUIRE(tiles.size() == 4);
+        for (size_t i = 0; i < 4; ++i) {
+            CHECK(tiles[i].width == 960);
+            CHECK(tiles[i].height == 520);
+        }
+    }
+
+    SECTION("Grid rows share the whole width") {
+        ComputeTiling(LANDSCAPE, MakeWeights(5), MakeOptions(TILING_GRID), tiles);
+        REQUIRE(tiles.size() == 5);
+        CHECK(tiles[4].x + tiles[4].width == LANDSCAPE.width);
+    }
+
+    SECTION("Master column on the long side") {
+        ComputeTiling(LANDSCAPE, MakeWeights(4), MakeOptions(TILING_MASTER_STACK), tiles);
+        CHECK(tiles[0].width == 1152);
+        CHECK(tiles[0].height == LANDSCAPE.height);
+        CHECK(tiles[1].x == 1152);
+
+        ComputeTiling(PORTRAIT, MakeWeights(4), MakeOptions(TILING_MASTER_STACK), tiles);
+        CHECK(tiles[0].width == PORTRAIT.width);
+        CHECK(tiles[0].height == 1128);
+    }
+
+    SECTION("Squarified tiles are proportional to the weights") {
+        std::vector<double> weights;
+        weights.push_back(1.);
+        weights.push_back(3.);
+        ComputeTiling(LANDSCAPE, weights, MakeOptions(TILING_SQUARIFIED), tiles);
+        REQUIRE(tiles.size() == 2);
+        CHECK(Area(tiles[1]) == 3 * Area(tiles[0]));
+    }
+
+    SECTION("Tiny windows keep a usable tile") {
+        std::vector<double> weights(10, 1000000.);
+        weights.push_back(1.);
+        weights.push_back(0.);
+        ComputeTiling(LANDSCAPE, weights, MakeOptions(TILING_SQUARIFIED), tiles);
+        CheckPartition(LANDSCAPE, tiles);
+        double mean = double(Area(LANDSCAPE)) / weights.size();
+        CHECK(Area(tiles[10]) >= 0.2 * mean);
+        CHECK(Area(tiles[11]) >= 0.2 * mean);
+    }
+
+    SECTION("Squarified tiles stay close to squares") {
+        ComputeTiling(LANDSCAPE, std::vector<double>(12, 1.), MakeOptions(TILING_SQUARIFIED),
+                      tiles);
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            double aspect = double(tiles[i].width) / tiles[i].height;
+            CHECK(aspect > 0.33);
+            CHECK(aspect < 3.);
+        }
+    }
+}
+
+TEST_CASE("Gaps separate the tiles and the edges", "[functional][tiling]") {
+    std::vector<ScreenRect> tiles;
+
+    for (TILING_ALGORITHM algorithm : ALGORITHMS) {
+        INFO("algorithm " << algorithm);
+        ComputeTiling(LANDSCAPE, MakeWeights(7), MakeOptions(algorithm, 9), tiles);
+        REQUIRE(tiles.size() == 7);
+
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            CHECK(tiles[i].x >= LANDSCAPE.x + 9);
+            CHECK(tiles[i].y >= LANDSCAPE.y + 9);
+            CHECK(tiles[i].x + tiles[i].width <= LANDSCAPE.x + LANDSCAPE.width - 9);
+            CHECK(tiles[i].y + tiles[i].height <= LANDSCAPE.y + LANDSCAPE.height - 9);
+
+            // Grown by a full gap on one side, two tiles still do not overlap
+            ScreenRect grown = {tiles[i].x, tiles[i].y, tiles[i].width + 8, tiles[i].height + 8};
+            for (size_t j = 0; j < tiles.size(); ++j) {
+                if (j != i)
+                    CHECK_FALSE(Overlap(grown, tiles[j]));
+            }
+        }
+    }
+
+    SECTION("An area smaller than the gaps gives the whole area to every window") {
+        ScreenRect tiny = {0, 0, 10, 10};
+        ComputeTiling(tiny, MakeWeights(3), MakeOptions(TILING_GRID, 20), tiles);
+        REQUIRE(tiles.size() == 3);
+        CHECK(Area(tiles[2]) == 100);
+    }
+
+    SECTION("No window, no tile") {
+        ComputeTiling(LANDSCAPE, std::vector<double>(), MakeOptions(TILING_GRID), tiles);
+        CHECK(tiles.empty());
+    }
+}
+
+TEST_CASE("Tiling up to 200 windows", "[functional][tiling][!benchmark]") {
+    std::vector<ScreenRect> tiles;
+    std::vector<double> weights10 = MakeWeights(10);
+    std::vector<double> weights50 = MakeWeights(50);
+    std::vector<double> weights200 = MakeWeights(200);
+
+    BENCHMARK("grid, 200 windows") {
+        ComputeTiling(LANDSCAPE, weights200, MakeOptions(TILING_GRID), tiles);
+        return tiles.size();
+    };
+
+    BENCHMARK("master-stack, 200 windows") {
+        ComputeTiling(LANDSCAPE, weights200, MakeOptions(TILING_MASTER_STACK), tiles);
+        return tiles.size();
+    };
+
+    BENCHMARK("squarified, 10 windows") {
+        ComputeTiling(LANDSCAPE, weights10, MakeOptions(TILING_SQUARIFIED), tiles);
+        return tiles.size();
+    };
+
+    BENCHMARK("squarified, 50 windows") {
+        ComputeTiling(LANDSCAPE, weights50, MakeOptions(TILING_SQUARIFIED), tiles);
+        return tiles.size();
+    };
+
+    BENCHMARK("squarified, 200 windows") {
+        ComputeTiling(LANDSCAPE, weights200, MakeOptions(TILING_SQUARIFIED), tiles);
+        return tiles.size();
+    };
+}
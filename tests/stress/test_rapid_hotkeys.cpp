@@ -4,6 +4,7 @@
  * Stress tests WinSplit's hotkey handling by:
  * - Firing hotkeys in rapid succession
  * - Testing concurrent operations
+ * - Repeating a hotkey while its snap transition plays
  * - Monitoring for crashes and memory issues
  */
 
@@ -83,6 +84,39 @@ void SimulateHotkey(WORD mod, WORD vk) {
     g_hotkeysSent++;
 }
 
+// Process the messages of the test windows for a while: WinSplit moves them with
+// SetWindowPos, which waits for this thread
+void PumpMessages(DWORD ms) {
+    DWORD start = GetTickCount();
+    while (GetTickCount() - start < ms) {
+        MSG msg;
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        Sleep(5);
+    }
+}
+
+// Final rect of a window after 'presses' of the same hotkey, 'interval' ms apart
+RECT PressRepeatedly(HWND hwnd, const RECT& initial, WORD vk, int presses, DWORD interval) {
+    SetWindowPos(hwnd, NULL, initial.left, initial.top,
+                 initial.right - initial.left, initial.bottom - initial.top,
+                 SWP_NOZORDER);
+    SetForegroundWindow(hwnd);
+    PumpMessages(200);
+
+    for (int i = 0; i < presses; i++) {
+        SimulateHotkey(MOD_CONTROL | MOD_ALT, vk);
+        PumpMessages(interval);
+    }
+    PumpMessages(1000);  // Longer than any snap transition
+
+    RECT rect;
+    GetWindowRect(hwnd, &rect);
+    return rect;
+}
+
 // Get process memory usage
 SIZE_T GetProcessMemory(DWORD pid) {
     HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
@@ -168,6 +202,28 @@ bool Test_RapidFireDifferentHotkeys() {
     return true;
 }
 
+// Test: Repeated hotkey during the snap transition
+// A press arriving while the previous one is still animating must cycle from the
+// position that press gave, exactly as presses made after the animation did.
+bool Test_RepeatedHotkeyDuringTransition() {
+    printf("  Pressing Ctrl+Alt+6 three times, slowly then within the animation...\n");
+
+    HWND hwnd = CreateTestWindow(100, 100, 400, 300, 0);
+    if (!hwnd) return false;
+
+    RECT initial = {100, 100, 500, 400};
+    RECT slow = PressRepeatedly(hwnd, initial, VK_NUMPAD6, 3, 1000);
+    RECT fast = PressRepeatedly(hwnd, initial, VK_NUMPAD6, 3, 30);
+
+    printf("  Slow: (%ld,%ld)-(%ld,%ld)  Fast: (%ld,%ld)-(%ld,%ld)\n",
+           slow.left, slow.top, slow.right, slow.bottom,
+           fast.left, fast.top, fast.right, fast.bottom);
+
+    DestroyWindow(hwnd);
+
+    return TestHarness::RectsEqual(slow, fast, 2);
+}
+
 // Test: Multiple windows concurrent
 bool Test_MultipleWindowsConcurrent() {
     printf("  Creating %d windows and moving them simultaneously...\n", CONCURRENT_WINDOWS);
@@ -324,6 +380,7 @@ int main() {
     // Run tests
     TestHarness::RunTest("Rapid fire same hotkey", Test_RapidFireSameHotkey);
     TestHarness::RunTest("Rapid fire different hotkeys", Test_RapidFireDifferentHotkeys);
+    TestHarness::RunTest("Repeated hotkey during transition", Test_RepeatedHotkeyDuringTransition);
     TestHarness::RunTest("Multiple windows concurrent", Test_MultipleWindowsConcurrent);
     TestHarness::RunTest("Memory stability (30 sec)", Test_MemoryStability);
     TestHarness::RunTest("Window create/destroy stress", Test_WindowCreateDestroyStress);
@@ -0,0 +1,371 @@
+#include "animator.h"
+
+#include "dwm_utils.h"
+#include "settingsmanager.h"
+
+#pragma comment(lib, "dwmapi.lib")
+
+Animator* Animator::p_instance = NULL;
+
+namespace {
+  const wchar_t* PROXY_CLASS = L"WinSplitAnimationProxy";
+
+  // Opacity of the feedback rectangle (0-255)
+  const BYTE PROXY_ALPHA = 50;
+
+  // Length of a snap transition (ms)
+  const int SNAP_DURATION = 150;
+
+  // Frame period when DwmFlush is not available (100 ns units, negative = relative)
+  const LONGLONG FALLBACK_PERIOD = -166667;
+
+  // Proxy placed on every frame: never activated, never waits for the UI thread.
+  // No SWP_SHOWWINDOW: a late frame must not show a proxy hidden meanwhile.
+  const UINT FRAME_FLAGS = SWP_ASYNCWINDOWPOS | SWP_NOACTIVATE | SWP_NOZORDER;
+}
+
+static double Ease(EASING easing, double t)
+{
+  switch (easing) {
+  case EASE_OUT_CUBIC:
+    return 1. - (1. - t) * (1. - t) * (1. - t);
+  case EASE_IN_OUT_CUBIC:
+    return t < 0.5 ? 4. * t * t * t : 1. - 4. * (1. - t) * (1. - t) * (1. - t);
+  default:
+    return t;
+  }
+}
+
+static int Interpolate(int from, int to, double progress)
+{
+  return from + int((to - from) * progress + (to >= from ? 0.5 : -0.5));
+}
+
+Animator::FrameThread::FrameThread(Animator& animator)
+    : wxThread(wxTHREAD_JOINABLE)
+    , m_animator(animator)
+{
+}
+
+void* Animator::FrameThread::Entry()
+{
+  for (;;) {
+    {
+      wxCriticalSectionLocker locker(m_animator.m_lock);
+      if (m_animator.m_exit)
+        break;
+    }
+
+    if (!m_animator.RenderFrame()) {
+      // Idle: no timer, no polling until the next Start()
+      WaitForSingleObject(m_animator.m_wake, INFINITE);
+      continue;
+    }
+
+    m_animator.WaitForFrame();
+  }
+
+  return NULL;
+}
+
+Animator::Animator()
+    : m_proxy(NULL)
+    , m_thumbProxy(NULL)
+    , m_brush(NULL)
+    , m_wake(CreateEvent(NULL, FALSE, FALSE, NULL))
+    , m_timer(CreateWaitableTimer(NULL, TRUE, NULL))
+    , p_thread(NULL)
+    , m_lock()
+    , m_animation()
+    , m_running(false)
+    , m_exit(false)
+    , m_thumbnail(NULL)
+    , m_target(NULL)
+    , m_apply()
+    , m_frequency(1)
+{
+  LARGE_INTEGER frequency;
+  if (QueryPerformanceFrequency(&frequency))
+    m_frequency = frequency.QuadPart;
+
+  m_brush = CreateSolidBrush(RGB(0, 255, 255));
+
+  WNDCLASSW wc = {0};
+  wc.lpfnWndProc = DefWindowProcW;
+  wc.hInstance = GetModuleHandle(NULL);
+  wc.hbrBackground = m_brush;
+  wc.lpszClassName = PROXY_CLASS;
+  RegisterClassW(&wc);
+
+  m_proxy = CreateProxy(PROXY_ALPHA);
+  m_thumbProxy = CreateProxy(255);
+
+  p_thread = new FrameThread(*this);
+  if (p_thread->Create() != wxTHREAD_NO_ERROR || p_thread->Run() != wxTHREAD_NO_ERROR) {
+    delete p_thread;
+    p_thread = NULL;
+  }
+}
+
+Animator::~Animator()
+{
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_exit = true;
+    m_running = false;
+  }
+
+  if (p_thread) {
+    SetEvent(m_wake);
+    p_thread->Wait();
+    delete p_thread;
+  }
+
+  // A window still in flight goes to its destination
+  FinishTransition();
+
+  if (m_proxy)
+    DestroyWindow(m_proxy);
+  if (m_thumbProxy)
+    DestroyWindow(m_thumbProxy);
+  if (m_brush)
+    DeleteObject(m_brush);
+  if (m_timer)
+    CloseHandle(m_timer);
+  if (m_wake)
+    CloseHandle(m_wake);
+}
+
+Animator* Animator::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new Animator();
+
+  return p_instance;
+}
+
+void Animator::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+HWND Animator::CreateProxy(BYTE alpha)
+{
+  // Click-through, no taskbar button, never takes the focus
+  HWND proxy = CreateWindowExW(WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOOLWINDOW |
+                                   WS_EX_TOPMOST | WS_EX_NOACTIVATE,
+                               PROXY_CLASS,
+                               L"",
+                               WS_POPUP,
+                               0,
+                               0,
+                               0,
+                               0,
+                               NULL,
+                               NULL,
+                               GetModuleHandle(NULL),
+                               NULL);
+
+  if (proxy)
+    SetLayeredWindowAttributes(proxy, 0, alpha, LWA_ALPHA);
+
+  return proxy;
+}
+
+void Animator::WaitForFrame()
+{
+  // Blocks until the next composition pass: one frame per vertical refresh
+  BOOL composition = FALSE;
+  if (SUCCEEDED(DwmIsCompositionEnabled(&composition)) && composition &&
+      SUCCEEDED(DwmFlush()))
+    return;
+
+  LARGE_INTEGER due;
+  due.QuadPart = FALLBACK_PERIOD;
+  if (m_timer && SetWaitableTimer(m_timer, &due, 0, NULL, NULL, FALSE))
+    WaitForSingleObject(m_timer, INFINITE);
+  else
+    Sleep(16);
+}
+
+bool Animator::RenderFrame()
+{
+  // Held while placing the proxy: the call is asynchronous, and Cancel() cannot slip
+  // between the state check and the placement
+  wxCriticalSectionLocker locker(m_lock);
+
+  if (!m_running)
+    return false;
+
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+
+  const Animation& animation = m_animation;
+  double t = animation.duration > 0 ? double(now.QuadPart - animation.start) / animation.duration
+                                    : 1.;
+
+  if (t >= 1.) {
+    m_running = false;
+    CallAfter(&Animator::OnAnimationEnd);
+    return false;
+  }
+
+  double progress = Ease(animation.easing, t);
+  int width = Interpolate(animation.from.width, animation.to.width, progress);
+  int height = Interpolate(animation.from.height, animation.to.height, progress);
+
+  // Nothing allocated per frame: two asynchronous calls on stack data
+  if (animation.thumbnail) {
+    DWM_THUMBNAIL_PROPERTIES properties;
+    properties.dwFlags = DWM_TNP_RECTDESTINATION;
+    SetRect(&properties.rcDestination, 0, 0, width, height);
+    DwmUpdateThumbnailProperties(animation.thumbnail, &properties);
+  }
+
+  SetWindowPos(animation.proxy,
+               NULL,
+               Interpolate(animation.from.x, animation.to.x, progress),
+               Interpolate(animation.from.y, animation.to.y, progress),
+               width,
+               height,
+               FRAME_FLAGS);
+  return true;
+}
+
+void Animator::Play(HWND proxy, HTHUMBNAIL thumbnail, const wxRect& from, const wxRect& to,
+                    int duration_ms, EASING easing)
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+
+  // Shown here, on the UI thread: the worker only moves it
+  SetWindowPos(proxy,
+               HWND_TOPMOST,
+               from.x,
+               from.y,
+               from.width,
+               from.height,
+               SWP_NOACTIVATE | SWP_SHOWWINDOW);
+
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_animation.proxy = proxy;
+    m_animation.thumbnail = thumbnail;
+    m_animation.from = from;
+    m_animation.to = to;
+    m_animation.start = now.QuadPart;
+    m_animation.duration = m_frequency * duration_ms / 1000;
+    m_animation.easing = easing;
+    m_running = true;
+  }
+
+  SetEvent(m_wake);
+}
+
+void Animator::Start(const wxRect& from, const wxRect& to, int duration_ms, EASING easing)
+{
+  if (!m_proxy || !p_thread)
+    return;
+
+  FinishTransition();
+  Play(m_proxy, NULL, from, to, duration_ms, easing);
+}
+
+void Animator::AnimateSnap(HWND hwnd, const wxRect& from, const wxRect& to,
+                           const std::function<void()>& apply)
+{
+  // The previous window lands first
+  FinishTransition();
+
+  if (!SettingsManager::Get().getAnimateSnap() || !m_thumbProxy || !p_thread || from == to ||
+      IsIconic(hwnd)) {
+    apply();
+    return;
+  }
+
+  HTHUMBNAIL thumbnail = NULL;
+  SIZE source;
+  if (FAILED(DwmRegisterThumbnail(m_thumbProxy, hwnd, &thumbnail)) ||
+      FAILED(DwmQueryThumbnailSourceSize(thumbnail, &source))) {
+    if (thumbnail)
+      DwmUnregisterThumbnail(thumbnail);
+    apply();
+    return;
+  }
+
+  // Only the visible part of the window, without the invisible resize borders
+  LONG left, top, right, bottom;
+  DwmUtils::GetInvisibleFrameBorders(hwnd, left, top, right, bottom);
+
+  DWM_THUMBNAIL_PROPERTIES properties;
+  properties.dwFlags = DWM_TNP_RECTSOURCE | DWM_TNP_RECTDESTINATION | DWM_TNP_VISIBLE |
+                       DWM_TNP_OPACITY | DWM_TNP_SOURCECLIENTAREAONLY;
+  SetRect(&properties.rcSource, left, top, source.cx - right, source.cy - bottom);
+  SetRect(&properties.rcDestination, 0, 0, from.width, from.height);
+  properties.fVisible = TRUE;
+  properties.opacity = 255;
+  properties.fSourceClientAreaOnly = FALSE;
+  DwmUpdateThumbnailProperties(thumbnail, &properties);
+
+  m_thumbnail = thumbnail;
+  m_target = hwnd;
+  m_apply = apply;
+
+  Play(m_thumbProxy, thumbnail, from, to, SNAP_DURATION, EASE_OUT_CUBIC);
+}
+
+void Animator::OnAnimationEnd()
+{
+  {
+    wxCriticalSectionLocker locker(m_lock);
+
+    // Another animation started meanwhile, it owns the proxies now
+    if (m_running)
+      return;
+  }
+
+  FinishTransition();
+  ShowWindow(m_proxy, SW_HIDE);
+}
+
+void Animator::FinishTransition()
+{
+  if (!m_thumbnail)
+    return;
+
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    if (m_animation.thumbnail == m_thumbnail)
+      m_running = false;
+  }
+
+  HTHUMBNAIL thumbnail = m_thumbnail;
+  std::function<void()> apply;
+  apply.swap(m_apply);
+  m_thumbnail = NULL;
+  m_target = NULL;
+
+  // The real window moves once, then the proxy covering its destination goes away
+  apply();
+
+  DwmUnregisterThumbnail(thumbnail);
+  ShowWindow(m_thumbProxy, SW_HIDE);
+}
+
+void Animator::FinishTransition(HWND hwnd)
+{
+  if (m_thumbnail && m_target == hwnd)
+    FinishTransition();
+}
+
+void Animator::Cancel()
+{
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_running = false;
+  }
+
+  FinishTransition();
+  ShowWindow(m_proxy, SW_HIDE);
+}
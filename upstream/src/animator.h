@@ -0,0 +1,107 @@
+#ifndef __ANIMATOR_H__
+#define __ANIMATOR_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <dwmapi.h>
+
+#include <wx/event.h>
+#include <wx/gdicmn.h>
+#include <wx/thread.h>
+
+#include <functional>
+
+enum EASING {
+  EASE_LINEAR,
+  EASE_OUT_CUBIC,   // fast start, soft landing
+  EASE_IN_OUT_CUBIC
+};
+
+// Visual feedback animations (always-on-top toggle, snap transitions), played on
+// click-through proxy windows. Frames are paced by the compositor (DwmFlush, or a
+// waitable timer when composition is off) on a worker thread that sleeps on an event
+// when idle: starting an animation returns immediately and an idle animator costs no
+// CPU. The worker only moves the proxies; showing, hiding and the final move of the
+// real window happen on the UI thread.
+class Animator : public wxEvtHandler // Singleton class
+{
+private:
+  class FrameThread : public wxThread {
+  private:
+    Animator& m_animator;
+
+  public:
+    FrameThread(Animator& animator);
+    void* Entry();
+  };
+
+  struct Animation {
+    HWND proxy;
+    HTHUMBNAIL thumbnail; // snap transition: live image of the window, NULL otherwise
+    wxRect from;
+    wxRect to;
+    LONGLONG start;    // QueryPerformanceCounter ticks
+    LONGLONG duration; // ticks
+    EASING easing;
+  };
+
+  static Animator* p_instance;
+
+  HWND m_proxy;      // translucent rectangle (feedback)
+  HWND m_thumbProxy; // opaque, hosts the DWM thumbnail (snap transitions)
+  HBRUSH m_brush;
+  HANDLE m_wake;  // set when an animation starts or on exit
+  HANDLE m_timer; // frame pacing without DWM composition
+  FrameThread* p_thread;
+
+  wxCriticalSection m_lock; // guards the members below
+  Animation m_animation;
+  bool m_running;
+  bool m_exit;
+
+  // Pending snap transition, UI thread only
+  HTHUMBNAIL m_thumbnail;
+  HWND m_target; // window the transition moves
+  std::function<void()> m_apply;
+
+  LONGLONG m_frequency;
+
+  Animator();
+  ~Animator();
+
+  HWND CreateProxy(BYTE alpha);
+  void WaitForFrame();
+  // Apply the frame due now, false once the animation is over
+  bool RenderFrame();
+  void Play(HWND proxy, HTHUMBNAIL thumbnail, const wxRect& from, const wxRect& to,
+            int duration_ms, EASING easing);
+  void OnAnimationEnd();
+  // Move the real window of the pending transition and remove its proxy
+  void FinishTransition();
+
+public:
+  static Animator* GetInstance();
+  static void DeleteInstance();
+
+  // Animate the feedback rectangle from one rect to another; replaces a running animation
+  void Start(const wxRect& from, const wxRect& to, int duration_ms, EASING easing);
+
+  // Snap transition of a window between two visible rects: a thumbnail of the window
+  // travels to the destination, then 'apply' moves the real window once. 'apply' is
+  // called right away when transitions are disabled or not possible.
+  void AnimateSnap(HWND hwnd, const wxRect& from, const wxRect& to,
+                   const std::function<void()>& apply);
+
+  // Land the pending transition of 'hwnd' at once, if any. Called before reading the
+  // geometry of a window a hotkey acts on: a repeated hotkey then starts from the position
+  // the previous one gave, not from the one the window had before the animation.
+  void FinishTransition(HWND hwnd);
+
+  // Stop the running animation; a pending transition lands at once
+  void Cancel();
+};
+
+#endif // __ANIMATOR_H__
@@ -1,32 +1,68 @@
 #include "auto_placement.h"
 
+#include "config_store.h"
 #include "settingsmanager.h"
 
 #include <wx/file.h>
+#include <wx/filefn.h>
 #include <wx/xml/xml.h>
 
 using namespace std;
 
+AutoPlacementManager* AutoPlacementManager::p_instance = NULL;
+
 bool WindowInfos::operator==(const WindowInfos& rhs)
 {
   return m_strName.CmpNoCase(rhs.m_strName) == 0;
 }
 
-bool AutoPlacementManager::Exist(const wxString& name)
+AutoPlacementManager::AutoPlacementManager()
+    : m_vecWnd()
+    , m_index()
+    , m_generation(0)
+    , m_loaded(false)
+{
+}
+
+AutoPlacementManager* AutoPlacementManager::GetInstance()
 {
-  WindowInfos tmp;
-  tmp.m_strName = name;
+  if (!p_instance)
+    p_instance = new AutoPlacementManager();
 
-  return find(m_vecWnd.begin(), m_vecWnd.end(), tmp) != m_vecWnd.end();
+  return p_instance;
 }
 
-WindowInfos AutoPlacementManager::GetWindowInfos(const wxString& name)
+void AutoPlacementManager::DeleteInstance()
 {
-  vector<WindowInfos>::iterator iter;
-  WindowInfos tmp;
+  delete p_instance;
+  p_instance = NULL;
+}
+
+wstring AutoPlacementManager::MakeKey(const wxString& name)
+{
+  // Same semantic as the former CmpNoCase() comparison
+  return name.Lower().ToStdWstring();
+}
+
+void AutoPlacementManager::RebuildIndex()
+{
+  m_index.clear();
+  m_index.reserve(m_vecWnd.size());
 
-  tmp.m_strName = name;
-  return *(find(m_vecWnd.begin(), m_vecWnd.end(), tmp));
+  // On duplicated names, the first entry wins (as find() did before)
+  for (size_t i = 0; i < m_vecWnd.size(); ++i)
+    m_index.insert(make_pair(MakeKey(m_vecWnd[i].m_strName), i));
+}
+
+const WindowInfos* AutoPlacementManager::Find(const wxString& name)
+{
+  ReloadIfChanged();
+
+  unordered_map<wstring, size_t>::const_iterator it = m_index.find(MakeKey(name));
+  if (it == m_index.end())
+    return NULL;
+
+  return &m_vecWnd[it->second];
 }
 
 void AutoPlacementManager::AddWindow(const HWND& hwnd, const wxString& name)
@@ -45,84 +81,85 @@ void AutoPlacementManager::AddWindow(const HWND& hwnd, const wxString& name)
   structinfo.m_rectxy.width = rect.right - rect.left;
   structinfo.m_rectxy.height = rect.bottom - rect.top;
 
+  wstring key = MakeKey(name);
+  unordered_map<wstring, size_t>::const_iterator it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_vecWnd[it->second] = structinfo;
+    return;
+  }
+
+  m_index.insert(make_pair(key, m_vecWnd.size()));
   m_vecWnd.push_back(structinfo);
 }
 
+bool AutoPlacementManager::ReloadIfChanged()
+{
+  // Only a counter on the hot path: the section is read again only when it was replaced
+  // behind our back (settings import...)
+  if (m_loaded &&
+      ConfigStore::GetInstance()->GetGeneration(CONFIG_AUTO_PLACEMENT) == m_generation)
+    return false;
+
+  return LoadData();
+}
+
 bool AutoPlacementManager::LoadData()
 {
-  wxString path;
-  wxXmlDocument doc;
+  const wxXmlNode* section;
   wxXmlNode* child;
-  wxXmlAttribute* properties;
-  wxString value;
   WindowInfos window_info;
 
-  path = SettingsManager::Get().GetDataDirectory() + _T ("auto_placement.xml");
-
-  if (!wxFileExists(path.c_str())) {
-    SaveData();
-  }
-
-  doc.Load(path);
-  child = doc.GetRoot()->GetChildren();
+  section = ConfigStore::GetInstance()->GetSection(CONFIG_AUTO_PLACEMENT);
 
   m_vecWnd.clear();
+  m_index.clear();
+  m_loaded = true;
 
-  while (child) {
-    properties = child->GetAttributes();
-    window_info.m_strName = properties->GetValue();
-    properties = properties->GetNext();
-
-    value = properties->GetValue();
-    value.ToLong((long*)&window_info.m_wndStyle);
-    properties = properties->GetNext();
-
-    value = properties->GetValue();
-    value.ToLong((long*)&window_info.m_rectxy.x);
-    properties = properties->GetNext();
-
-    value = properties->GetValue();
-    value.ToLong((long*)&window_info.m_rectxy.y);
-    properties = properties->GetNext();
+  if (!section)
+    return SaveData();
 
-    value = properties->GetValue();
-    value.ToLong((long*)&window_info.m_rectxy.width);
-    properties = properties->GetNext();
+  m_generation = ConfigStore::GetInstance()->GetGeneration(CONFIG_AUTO_PLACEMENT);
 
-    value = properties->GetValue();
-    value.ToLong((long*)&window_info.m_rectxy.height);
-    properties = properties->GetNext();
+  // Attributes by name; an entry without a name is skipped
+  for (child = section->GetChildren(); child; child = child->GetNext()) {
+    if (child->GetType() != wxXML_ELEMENT_NODE ||
+        !child->GetAttribute(_T ("Name"), &window_info.m_strName))
+      continue;
 
-    value = properties->GetValue();
-    window_info.m_flagResize = value.Cmp(_T ("True")) == 0;
+    window_info.m_wndStyle = ConfigStore::ReadLong(child, _T ("WindowStyle"), 0);
+    window_info.m_rectxy.x = int(ConfigStore::ReadLong(child, _T ("x"), 0));
+    window_info.m_rectxy.y = int(ConfigStore::ReadLong(child, _T ("y"), 0));
+    window_info.m_rectxy.width = int(ConfigStore::ReadLong(child, _T ("width"), 0));
+    window_info.m_rectxy.height = int(ConfigStore::ReadLong(child, _T ("height"), 0));
+    window_info.m_flagResize = ConfigStore::ReadBool(child, _T ("Resize"), false);
 
     m_vecWnd.push_back(window_info);
-
-    child = child->GetNext();
   }
-  child = doc.DetachRoot();
-  delete child;
+
+  RebuildIndex();
   return true;
 }
 
 bool AutoPlacementManager::SaveData()
 {
-  wxString path;
   vector<WindowInfos>::iterator iter;
 
-  wxXmlDocument doc;
-  wxXmlNode* node;
+  wxXmlNode* node = NULL;
   wxXmlNode* root;
   wxXmlAttribute* properties;
 
-  path = SettingsManager::Get().GetDataDirectory() + _T ("auto_placement.xml");
-
   root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WinSplit_AutoPlacement"));
 
-  doc.SetRoot(root);
-
   for (iter = m_vecWnd.begin(); iter != m_vecWnd.end(); ++iter) {
-    node = new wxXmlNode(root, wxXML_ELEMENT_NODE, _T ("Application"));
+    // Appended after the previous entry: AddChild() would walk the whole list each time
+    wxXmlNode* next = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Application"));
+    if (node)
+      node->SetNext(next);
+    else
+      root->SetChildren(next);
+    next->SetParent(root);
+    node = next;
+
     properties = new wxXmlAttribute(_T ("Name"), (*iter).m_strName);
     node->SetAttributes(properties);
     properties->SetNext(
@@ -144,9 +181,11 @@ bool AutoPlacementManager::SaveData()
         new wxXmlAttribute(_T ("Resize"), (*iter).m_flagResize ? _T ("True") : _T ("False")));
   }
 
-  doc.Save(path.c_str());
+  ConfigStore* store = ConfigStore::GetInstance();
+  store->SetSection(CONFIG_AUTO_PLACEMENT, root);
 
-  delete doc.DetachRoot();
+  // Our own save must not trigger a reload on the next lookup
+  m_generation = store->GetGeneration(CONFIG_AUTO_PLACEMENT);
 
   return true;
 }
@@ -171,5 +210,9 @@ wxArrayString AutoPlacementManager::GetArrayName()
 
 void AutoPlacementManager::DeleteApplication(const int& position)
 {
+  if (position < 0 || position >= int(m_vecWnd.size()))
+    return;
+
   m_vecWnd.erase(m_vecWnd.begin() + position);
+  RebuildIndex();
 }
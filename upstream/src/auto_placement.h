@@ -11,6 +11,8 @@
 #include <wx/gdicmn.h>
 #include <wx/string.h>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 struct WindowInfos {
@@ -25,20 +27,38 @@ struct WindowInfos {
   bool operator==(const WindowInfos& rhs);
 };
 
-class AutoPlacementManager {
+class AutoPlacementManager // Singleton class
+{
 private:
+  static AutoPlacementManager* p_instance;
+
+  // Entries in file order (used by the options dialog), plus an index keyed by
+  // the case-folded "process::class" name so that hotkey lookups are O(1).
   std::vector<WindowInfos> m_vecWnd;
+  std::unordered_map<std::wstring, size_t> m_index;
 
-public:
-  AutoPlacementManager() {}
+  // Generation of the store section when it was last loaded or saved
+  unsigned int m_generation;
+  bool m_loaded;
+
+  AutoPlacementManager();
   ~AutoPlacementManager() {}
 
-  WindowInfos GetWindowInfos(const wxString& name);
+  static std::wstring MakeKey(const wxString& name);
+  void RebuildIndex();
+
+public:
+  static AutoPlacementManager* GetInstance();
+  static void DeleteInstance();
+
+  // Return the saved placement for this "process::class" name, or NULL if unknown.
+  // The entries are reloaded first if the store section was replaced since the last load.
+  const WindowInfos* Find(const wxString& name);
   void AddWindow(const HWND& hwnd, const wxString& name);
   wxArrayString GetArrayName();
   void DeleteApplication(const int& pos);
   bool IsEmpty();
-  bool Exist(const wxString& name);
+  bool ReloadIfChanged();
   bool LoadData();
   bool SaveData();
 };
@@ -0,0 +1,295 @@
+#include "config_store.h"
+
+#include "config_writer.h"
+#include "debug_log.h"
+
+#include <wx/filefn.h>
+#include <wx/stream.h>
+
+ConfigStore* ConfigStore::p_instance = NULL;
+
+namespace {
+  const long CONFIG_VERSION = 1;
+
+  const wxChar* STORE_FILE = _T ("WinSplit.xml");
+
+  // Element of each section, in CONFIG_SECTION order
+  const wxChar* SECTION_NAMES[NB_CONFIG_SECTIONS] = {
+      _T ("WinSplit_Settings"), _T ("WinSplit_HotKeys"), _T ("LayoutManager"),
+      _T ("WinSplit_AutoPlacement")};
+
+  const wxChar* LEGACY_FILES[NB_CONFIG_SECTIONS] = {
+      _T ("Settings.xml"), _T ("hotkeys.xml"), _T ("layout.xml"), _T ("auto_placement.xml")};
+}
+
+ConfigStore::ConfigStore()
+    : m_directory()
+    , m_doc()
+{
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+    m_sections[i] = NULL;
+    m_generations[i] = 0;
+  }
+}
+
+ConfigStore* ConfigStore::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new ConfigStore();
+
+  return p_instance;
+}
+
+void ConfigStore::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+wxString ConfigStore::GetLegacyFileName(CONFIG_SECTION section)
+{
+  return LEGACY_FILES[section];
+}
+
+void ConfigStore::CreateRoot(long version)
+{
+  wxXmlNode* root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WinSplit"));
+  root->AddAttribute(_T ("Version"), wxString::Format(_T ("%ld"), version));
+  m_doc.SetRoot(root);
+
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i)
+    m_sections[i] = NULL;
+}
+
+void ConfigStore::Load(const wxString& directory)
+{
+  m_directory = directory;
+
+  // The only file opened at startup
+  wxString path = m_directory + STORE_FILE;
+  long version = 0;
+
+  if (!wxFileExists(path)) {
+    // First run of this version: start from the former files
+    CreateRoot(0);
+  }
+  else if (m_doc.Load(path) && m_doc.GetRoot() && m_doc.GetRoot()->GetName() == _T ("WinSplit")) {
+    version = ReadLong(m_doc.GetRoot(), _T ("Version"), 0);
+    IndexSections();
+  }
+  else {
+    // Damaged store: kept aside for the user, the settings start from their defaults.
+    // The former files are older than it and are never imported over it.
+    wxString bad = path + _T (".bad");
+    DEBUG_LOG_FMT("WinSplit.xml: cannot be read, renamed to %ls", bad.wc_str());
+    if (!wxRenameFile(path, bad, true))
+      DEBUG_LOG_FMT("WinSplit.xml: cannot rename to %ls", bad.wc_str());
+
+    CreateRoot(CONFIG_VERSION);
+    version = CONFIG_VERSION;
+
+    // A store exists again: the next start does not migrate either
+    Save();
+  }
+
+  if (version > CONFIG_VERSION)
+    DEBUG_LOG_FMT("WinSplit.xml: version %ld is newer than %ld, read as is", version,
+                  CONFIG_VERSION);
+
+  bool migrated = version < CONFIG_VERSION;
+  for (; version < CONFIG_VERSION; ++version)
+    Migrate(version);
+
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i)
+    ++m_generations[i];
+
+  if (migrated) {
+    for (wxXmlAttribute* attr = m_doc.GetRoot()->GetAttributes(); attr; attr = attr->GetNext()) {
+      if (attr->GetName() == _T ("Version"))
+        attr->SetValue(wxString::Format(_T ("%ld"), CONFIG_VERSION));
+    }
+    Save();
+  }
+}
+
+void ConfigStore::IndexSections()
+{
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i)
+    m_sections[i] = NULL;
+
+  for (wxXmlNode* node = m_doc.GetRoot()->GetChildren(); node; node = node->GetNext()) {
+    for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+      if (node->GetName() == SECTION_NAMES[i])
+        m_sections[i] = node;
+    }
+  }
+}
+
+bool ConfigStore::Replace(wxXmlDocument& doc)
+{
+  // Not a store, or a version 0 one (former files are imported one by one instead)
+  if (!doc.GetRoot() || doc.GetRoot()->GetName() != _T ("WinSplit") ||
+      ReadLong(doc.GetRoot(), _T ("Version"), 0) < 1)
+    return false;
+
+  // The whole tree at once: the previous one is deleted with its sections
+  m_doc.SetRoot(doc.DetachRoot());
+  IndexSections();
+
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i)
+    ++m_generations[i];
+
+  return true;
+}
+
+void ConfigStore::Migrate(long version)
+{
+  switch (version) {
+  case 0:
+    MigrateLegacyFiles();
+    break;
+  }
+}
+
+void ConfigStore::MigrateLegacyFiles()
+{
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+    wxString path = m_directory + LEGACY_FILES[i];
+    wxXmlDocument doc;
+
+    if (!wxFileExists(path) || !doc.Load(path) || !doc.GetRoot())
+      continue;
+
+    if (doc.GetRoot()->GetName() != SECTION_NAMES[i]) {
+      DEBUG_LOG_FMT("Migration: unexpected root in %ls, ignored", LEGACY_FILES[i]);
+      continue;
+    }
+
+    SetSection(CONFIG_SECTION(i), doc.DetachRoot());
+  }
+}
+
+void ConfigStore::Save()
+{
+  if (!m_directory.IsEmpty())
+    ConfigWriter::GetInstance()->Save(m_directory + STORE_FILE, m_doc);
+}
+
+const wxXmlNode* ConfigStore::GetSection(CONFIG_SECTION section) const
+{
+  return m_sections[section];
+}
+
+void ConfigStore::SetSection(CONFIG_SECTION section, wxXmlNode* node)
+{
+  wxXmlNode* root = m_doc.GetRoot();
+  wxXmlNode* previous = m_sections[section];
+
+  // Sections stay in CONFIG_SECTION order, the previous one in place if any
+  if (previous) {
+    root->InsertChild(node, previous);
+    root->RemoveChild(previous);
+    delete previous;
+  }
+  else {
+    wxXmlNode* next = NULL;
+    for (int i = section + 1; i < NB_CONFIG_SECTIONS && !next; ++i)
+      next = m_sections[i];
+
+    if (next)
+      root->InsertChild(node, next);
+    else
+      root->AddChild(node);
+  }
+
+  m_sections[section] = node;
+  ++m_generations[section];
+
+  Save();
+}
+
+unsigned int ConfigStore::GetGeneration(CONFIG_SECTION section) const
+{
+  return m_generations[section];
+}
+
+bool ConfigStore::ExportSection(CONFIG_SECTION section, wxOutputStream& stream) const
+{
+  if (!m_sections[section])
+    return false;
+
+  wxXmlDocument doc;
+  doc.SetRoot(new wxXmlNode(*m_sections[section]));
+
+  return doc.Save(stream, 2);
+}
+
+bool ConfigStore::ImportLegacyFile(const wxString& fileName, wxInputStream& stream)
+{
+  wxXmlDocument doc;
+
+  return IsLegacyFile(fileName) && doc.Load(stream) && ImportLegacyFile(fileName, doc);
+}
+
+bool ConfigStore::ImportLegacyFile(const wxString& fileName, wxXmlDocument& doc)
+{
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+    if (fileName.CmpNoCase(LEGACY_FILES[i]) != 0)
+      continue;
+
+    if (!doc.GetRoot() || doc.GetRoot()->GetName() != SECTION_NAMES[i])
+      return false;
+
+    SetSection(CONFIG_SECTION(i), doc.DetachRoot());
+    return true;
+  }
+
+  return false;
+}
+
+bool ConfigStore::IsLegacyFile(const wxString& fileName)
+{
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+    if (fileName.CmpNoCase(LEGACY_FILES[i]) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+wxString ConfigStore::GetFileName()
+{
+  return STORE_FILE;
+}
+
+long ConfigStore::ReadLong(const wxXmlNode* node, const wxString& name, long value)
+{
+  wxString text;
+  long result;
+
+  if (node && node->GetAttribute(name, &text) && text.ToLong(&result))
+    return result;
+
+  return value;
+}
+
+double ConfigStore::ReadDouble(const wxXmlNode* node, const wxString& name, double value)
+{
+  wxString text;
+  double result;
+
+  if (node && node->GetAttribute(name, &text) && text.ToDouble(&result))
+    return result;
+
+  return value;
+}
+
+bool ConfigStore::ReadBool(const wxXmlNode* node, const wxString& name, bool value)
+{
+  wxString text;
+
+  if (node && node->GetAttribute(name, &text))
+    return text == _T ("True") || text == _T ("1");
+
+  return value;
+}
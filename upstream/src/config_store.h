@@ -0,0 +1,89 @@
+#ifndef __CONFIG_STORE_H__
+#define __CONFIG_STORE_H__
+
+#include <wx/string.h>
+#include <wx/xml/xml.h>
+
+class wxInputStream;
+class wxOutputStream;
+
+// Sections of the configuration, one per former file
+enum CONFIG_SECTION {
+  CONFIG_SETTINGS,       // Settings.xml
+  CONFIG_HOTKEYS,        // hotkeys.xml
+  CONFIG_LAYOUTS,        // layout.xml
+  CONFIG_AUTO_PLACEMENT  // auto_placement.xml
+};
+#define NB_CONFIG_SECTIONS 4
+
+// All the configuration in a single file, WinSplit.xml in the data directory:
+//
+//   <WinSplit Version="1">
+//     <WinSplit_Settings>...</WinSplit_Settings>
+//     <WinSplit_HotKeys>...</WinSplit_HotKeys>
+//     <LayoutManager>...</LayoutManager>
+//     <WinSplit_AutoPlacement>...</WinSplit_AutoPlacement>
+//   </WinSplit>
+//
+// A section has the element and content of the former file's root. The file is parsed
+// once at startup; the managers then read their section from memory and replace it when
+// they save, the whole store being written by ConfigWriter.
+// Without WinSplit.xml, the former files are migrated (and left in place). The export
+// format stays one former file per section.
+class ConfigStore // Singleton class
+{
+private:
+  static ConfigStore* p_instance;
+
+  wxString m_directory;
+  wxXmlDocument m_doc;
+  wxXmlNode* m_sections[NB_CONFIG_SECTIONS]; // children of the root, NULL if missing
+  unsigned int m_generations[NB_CONFIG_SECTIONS];
+
+  ConfigStore();
+  ~ConfigStore() {}
+
+  void CreateRoot(long version);
+  void IndexSections();
+  // Each step brings the store from 'version' to 'version + 1'
+  void Migrate(long version);
+  void MigrateLegacyFiles();
+  void Save();
+
+public:
+  static ConfigStore* GetInstance();
+  static void DeleteInstance();
+
+  // WinSplit.xml
+  static wxString GetFileName();
+  // Former file of a section, also its name in exports
+  static wxString GetLegacyFileName(CONFIG_SECTION section);
+  static bool IsLegacyFile(const wxString& fileName);
+
+  // Parse the store of 'directory', or migrate the former files into it when there is none.
+  // A store that cannot be parsed is renamed WinSplit.xml.bad and replaced by an empty one.
+  void Load(const wxString& directory);
+  // Take the tree of a store parsed elsewhere (hot reload), in one step; false if 'doc'
+  // is not a store. Nothing is saved.
+  bool Replace(wxXmlDocument& doc);
+
+  // NULL if the section was never saved
+  const wxXmlNode* GetSection(CONFIG_SECTION section) const;
+  // Replace a section (the store takes 'node') and save the store
+  void SetSection(CONFIG_SECTION section, wxXmlNode* node);
+  // Changes every time a section is replaced or loaded
+  unsigned int GetGeneration(CONFIG_SECTION section) const;
+
+  // Write a section as its former file
+  bool ExportSection(CONFIG_SECTION section, wxOutputStream& stream) const;
+  // Read a former file into its section; false if the name or the content is unknown
+  bool ImportLegacyFile(const wxString& fileName, wxInputStream& stream);
+  bool ImportLegacyFile(const wxString& fileName, wxXmlDocument& doc);
+
+  // Typed reads of the attributes of a section node, 'value' when missing or invalid
+  static long ReadLong(const wxXmlNode* node, const wxString& name, long value);
+  static double ReadDouble(const wxXmlNode* node, const wxString& name, double value);
+  static bool ReadBool(const wxXmlNode* node, const wxString& name, bool value);
+};
+
+#endif // __CONFIG_STORE_H__
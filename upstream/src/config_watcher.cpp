@@ -0,0 +1,283 @@
+#include "config_watcher.h"
+
+#include "config_store.h"
+#include "config_writer.h"
+#include "debug_log.h"
+#include "placement_rules.h"
+
+#include <wx/filefn.h>
+#include <wx/log.h>
+#include <wx/xml/xml.h>
+
+using namespace std;
+
+ConfigWatcher* ConfigWatcher::p_instance = NULL;
+
+namespace {
+  // Editors and deployment tools write a file in several steps: wait for the last one (ms)
+  const ULONGLONG SETTLE_DELAY = 300;
+
+  const wxChar* RULES_FILE = _T ("placement_rules.xml");
+
+  const DWORD NOTIFY_FILTER =
+      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+}
+
+ConfigWatcher::WatchThread::WatchThread(ConfigWatcher& watcher)
+    : wxThread(wxTHREAD_JOINABLE)
+    , m_watcher(watcher)
+{
+}
+
+void* ConfigWatcher::WatchThread::Entry()
+{
+  m_watcher.Watch();
+
+  return NULL;
+}
+
+ConfigWatcher::ConfigWatcher()
+    : m_directory()
+    , m_stop(CreateEvent(NULL, TRUE, FALSE, NULL))
+    , p_thread(NULL)
+    , m_lock()
+    , m_parsed()
+    , m_reloaded()
+{
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+  Stop();
+
+  if (m_stop)
+    CloseHandle(m_stop);
+}
+
+ConfigWatcher* ConfigWatcher::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new ConfigWatcher();
+
+  return p_instance;
+}
+
+void ConfigWatcher::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+void ConfigWatcher::Start(const wxString& directory, const function<void()>& reloaded)
+{
+  if (p_thread)
+    return;
+
+  m_directory = directory;
+  m_reloaded = reloaded;
+  ResetEvent(m_stop);
+
+  p_thread = new WatchThread(*this);
+  if (p_thread->Create() != wxTHREAD_NO_ERROR || p_thread->Run() != wxTHREAD_NO_ERROR) {
+    delete p_thread;
+    p_thread = NULL;
+  }
+}
+
+void ConfigWatcher::Stop()
+{
+  if (!p_thread)
+    return;
+
+  SetEvent(m_stop);
+  p_thread->Wait();
+  delete p_thread;
+  p_thread = NULL;
+
+  // Snapshots parsed but not applied yet are dropped
+  wxCriticalSectionLocker locker(m_lock);
+  m_parsed.clear();
+}
+
+bool ConfigWatcher::IsWatched(const wxString& name)
+{
+  return name.CmpNoCase(ConfigStore::GetFileName()) == 0 || ConfigStore::IsLegacyFile(name) ||
+         name.CmpNoCase(RULES_FILE) == 0;
+}
+
+void ConfigWatcher::Watch()
+{
+  HANDLE dir = CreateFileW(m_directory.wc_str(),
+                           FILE_LIST_DIRECTORY,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           NULL,
+                           OPEN_EXISTING,
+                           FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                           NULL);
+  if (dir == INVALID_HANDLE_VALUE) {
+    DEBUG_LOG_FMT("ConfigWatcher: cannot watch %ls (%lu)", m_directory.wc_str(), GetLastError());
+    return;
+  }
+
+  OVERLAPPED overlapped = {0};
+  overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+  DWORD buffer[4096]; // FILE_NOTIFY_INFORMATION must be DWORD aligned
+  vector<wxString> changed;
+  ULONGLONG due = 0;
+  bool reading = false;
+
+  for (;;) {
+    if (!reading) {
+      ResetEvent(overlapped.hEvent);
+      reading = ReadDirectoryChangesW(dir, buffer, sizeof(buffer), FALSE, NOTIFY_FILTER, NULL,
+                                      &overlapped, NULL) != 0;
+      if (!reading) {
+        DEBUG_LOG_FMT("ConfigWatcher: ReadDirectoryChangesW failed (%lu)", GetLastError());
+        break;
+      }
+    }
+
+    // Idle: no timeout until something changes
+    DWORD timeout = INFINITE;
+    if (!changed.empty()) {
+      ULONGLONG now = GetTickCount64();
+      timeout = due > now ? DWORD(due - now) : 0;
+    }
+
+    HANDLE handles[2] = {m_stop, overlapped.hEvent};
+    DWORD result = WaitForMultipleObjects(2, handles, FALSE, timeout);
+
+    if (result == WAIT_OBJECT_0 + 1) {
+      DWORD size = 0;
+      reading = false;
+      if (!GetOverlappedResult(dir, &overlapped, &size, FALSE))
+        break;
+
+      vector<wxString> names;
+      if (size == 0) {
+        // Buffer overflow: the changes are lost, look at every file
+        names.push_back(ConfigStore::GetFileName());
+        for (int i = 0; i < NB_CONFIG_SECTIONS; ++i)
+          names.push_back(ConfigStore::GetLegacyFileName(CONFIG_SECTION(i)));
+        names.push_back(RULES_FILE);
+      }
+      else {
+        const BYTE* entry = reinterpret_cast<const BYTE*>(buffer);
+        for (;;) {
+          const FILE_NOTIFY_INFORMATION* info =
+              reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(entry);
+          names.push_back(wxString(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+          if (info->NextEntryOffset == 0)
+            break;
+          entry += info->NextEntryOffset;
+        }
+      }
+
+      bool watched = false;
+      for (size_t i = 0; i < names.size(); ++i) {
+        if (!IsWatched(names[i]))
+          continue;
+
+        watched = true;
+        size_t j = 0;
+        while (j < changed.size() && changed[j].CmpNoCase(names[i]) != 0)
+          ++j;
+        if (j == changed.size())
+          changed.push_back(names[i]);
+      }
+
+      if (watched)
+        due = GetTickCount64() + SETTLE_DELAY;
+    }
+    else if (result == WAIT_TIMEOUT) {
+      Parse(changed);
+      changed.clear();
+    }
+    else {
+      // Stop, or the wait failed
+      break;
+    }
+  }
+
+  if (reading) {
+    DWORD size;
+    CancelIo(dir);
+    GetOverlappedResult(dir, &overlapped, &size, TRUE);
+  }
+
+  CloseHandle(overlapped.hEvent);
+  CloseHandle(dir);
+}
+
+void ConfigWatcher::Parse(const vector<wxString>& names)
+{
+  ConfigWriter* writer = ConfigWriter::GetInstance();
+  vector<ParsedFile> parsed;
+
+  // Parse errors stay in the debug log: no message box from this thread
+  wxLogNull noLog;
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    wxString path = m_directory + names[i];
+
+    // Deleted: the configuration in memory stays. Ours: nothing new.
+    if (!wxFileExists(path) || writer->IsPending(path) || writer->IsOwnWrite(path))
+      continue;
+
+    ParsedFile file;
+    file.name = names[i];
+    file.doc = make_shared<wxXmlDocument>();
+    if (!file.doc->Load(path) || !file.doc->GetRoot()) {
+      DEBUG_LOG_FMT("ConfigWatcher: %ls does not parse, ignored", names[i].wc_str());
+      continue;
+    }
+
+    parsed.push_back(file);
+  }
+
+  if (parsed.empty())
+    return;
+
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_parsed.insert(m_parsed.end(), parsed.begin(), parsed.end());
+  }
+
+  CallAfter(&ConfigWatcher::OnParsed);
+}
+
+void ConfigWatcher::OnParsed()
+{
+  vector<ParsedFile> parsed;
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    parsed.swap(m_parsed);
+  }
+
+  ConfigStore* store = ConfigStore::GetInstance();
+  bool reloaded = false;
+
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    const wxString& name = parsed[i].name;
+
+    if (name.CmpNoCase(RULES_FILE) == 0) {
+      PlacementRules* rules = PlacementRules::GetInstance();
+      if (rules->LoadData(*parsed[i].doc))
+        rules->Start();
+      else
+        rules->Stop();
+    }
+    else if (name.CmpNoCase(ConfigStore::GetFileName()) == 0) {
+      reloaded |= store->Replace(*parsed[i].doc);
+    }
+    else {
+      // A former file pushed alone replaces its section, and the store is saved
+      reloaded |= store->ImportLegacyFile(name, *parsed[i].doc);
+    }
+
+    DEBUG_LOG_FMT("ConfigWatcher: %ls reloaded", name.wc_str());
+  }
+
+  if (reloaded && m_reloaded)
+    m_reloaded();
+}
@@ -0,0 +1,73 @@
+#ifndef __CONFIG_WATCHER_H__
+#define __CONFIG_WATCHER_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/event.h>
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class wxXmlDocument;
+
+// Hot reload of the configuration pushed into the data directory: WinSplit.xml, the former
+// files (layout.xml, hotkeys.xml...) and placement_rules.xml.
+// A worker thread waits on ReadDirectoryChangesW, lets a burst of changes settle, then parses
+// the changed files itself. Each parsed file is an immutable snapshot handed to the UI thread,
+// which swaps it in at once: the hotkey handlers also run on the UI thread, so they see the
+// whole previous configuration or the whole new one, never a half-loaded table. A file that
+// does not parse is ignored until its next change. Our own writes are not reloaded.
+class ConfigWatcher : public wxEvtHandler // Singleton class
+{
+private:
+  class WatchThread : public wxThread {
+  private:
+    ConfigWatcher& m_watcher;
+
+  public:
+    WatchThread(ConfigWatcher& watcher);
+    void* Entry();
+  };
+
+  struct ParsedFile {
+    wxString name;
+    std::shared_ptr<wxXmlDocument> doc;
+  };
+
+  static ConfigWatcher* p_instance;
+
+  wxString m_directory;
+  HANDLE m_stop;
+  WatchThread* p_thread;
+
+  wxCriticalSection m_lock; // guards m_parsed
+  std::vector<ParsedFile> m_parsed;
+
+  // UI thread only
+  std::function<void()> m_reloaded;
+
+  ConfigWatcher();
+  ~ConfigWatcher();
+
+  static bool IsWatched(const wxString& name);
+  void Watch();
+  // Worker thread: parse the files and post them to the UI thread
+  void Parse(const std::vector<wxString>& names);
+  void OnParsed();
+
+public:
+  static ConfigWatcher* GetInstance();
+  static void DeleteInstance();
+
+  // Watch 'directory'; 'reloaded' is called on the UI thread once the store was replaced
+  void Start(const wxString& directory, const std::function<void()>& reloaded);
+  void Stop();
+};
+
+#endif // __CONFIG_WATCHER_H__
@@ -0,0 +1,259 @@
+#include "config_writer.h"
+
+#include "debug_log.h"
+
+#include <wx/mstream.h>
+#include <wx/xml/xml.h>
+
+#include <algorithm>
+
+using namespace std;
+
+ConfigWriter* ConfigWriter::p_instance = NULL;
+
+namespace {
+  // Saves closer than this are written once (ms)
+  const ULONGLONG WRITE_DELAY = 500;
+  // A failed write is tried again after WRITE_DELAY, doubled on each failure up to this (ms)
+  const ULONGLONG MAX_RETRY_DELAY = 60000;
+}
+
+ConfigWriter::WriterThread::WriterThread(ConfigWriter& writer)
+    : wxThread(wxTHREAD_JOINABLE)
+    , m_writer(writer)
+{
+}
+
+void* ConfigWriter::WriterThread::Entry()
+{
+  for (;;) {
+    {
+      wxCriticalSectionLocker locker(m_writer.m_lock);
+      if (m_writer.m_exit)
+        break;
+    }
+
+    // Idle: no timer, no polling until the next Save()
+    DWORD delay = m_writer.WritePending(GetTickCount64());
+    WaitForSingleObject(m_writer.m_wake, delay);
+  }
+
+  return NULL;
+}
+
+ConfigWriter::ConfigWriter()
+    : m_wake(CreateEvent(NULL, FALSE, FALSE, NULL))
+    , p_thread(NULL)
+    , m_lock()
+    , m_pending()
+    , m_written()
+    , m_exit(false)
+    , m_diskLock()
+{
+  p_thread = new WriterThread(*this);
+  if (p_thread->Create() != wxTHREAD_NO_ERROR || p_thread->Run() != wxTHREAD_NO_ERROR) {
+    delete p_thread;
+    p_thread = NULL;
+  }
+}
+
+ConfigWriter::~ConfigWriter()
+{
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_exit = true;
+  }
+
+  if (p_thread) {
+    SetEvent(m_wake);
+    p_thread->Wait();
+    delete p_thread;
+  }
+
+  Flush();
+
+  if (m_wake)
+    CloseHandle(m_wake);
+}
+
+ConfigWriter* ConfigWriter::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new ConfigWriter();
+
+  return p_instance;
+}
+
+void ConfigWriter::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+void ConfigWriter::Save(const wxString& path, const wxXmlDocument& doc, int indent)
+{
+  // The DOM belongs to the caller: it is serialized here, the worker only gets bytes
+  wxMemoryOutputStream stream;
+  if (!doc.Save(stream, indent))
+    return;
+
+  PendingFile file;
+  file.path = path;
+  file.content.resize(stream.GetSize());
+  if (!file.content.empty())
+    stream.CopyTo(&file.content[0], file.content.size());
+  file.due = GetTickCount64() + WRITE_DELAY;
+  file.failures = 0;
+
+  {
+    wxCriticalSectionLocker locker(m_lock);
+
+    vector<PendingFile>::iterator it = m_pending.begin();
+    while (it != m_pending.end() && it->path.CmpNoCase(path) != 0)
+      ++it;
+
+    if (it != m_pending.end())
+      *it = file;
+    else
+      m_pending.push_back(file);
+  }
+
+  if (p_thread)
+    SetEvent(m_wake);
+  else
+    Flush();
+}
+
+void ConfigWriter::Flush()
+{
+  WritePending(0);
+}
+
+DWORD ConfigWriter::WritePending(ULONGLONG now)
+{
+  wxCriticalSectionLocker diskLocker(m_diskLock);
+
+  vector<PendingFile> due;
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    for (size_t i = 0; i < m_pending.size(); ++i) {
+      if (now == 0 || m_pending[i].due <= now)
+        due.push_back(m_pending[i]);
+    }
+  }
+
+  for (size_t i = 0; i < due.size(); ++i) {
+    bool written = WriteAtomically(due[i]);
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    bool known = written &&
+                 GetFileAttributesExW(due[i].path.wc_str(), GetFileExInfoStandard, &data);
+
+    wxCriticalSectionLocker locker(m_lock);
+
+    // Still pending until written: a reader must not see the old file as current.
+    // A save received during the write stays pending, a failed write is tried again.
+    for (size_t j = 0; j < m_pending.size(); ++j) {
+      if (m_pending[j].path.CmpNoCase(due[i].path) != 0)
+        continue;
+
+      if (m_pending[j].content == due[i].content) {
+        if (written) {
+          m_pending.erase(m_pending.begin() + j);
+        }
+        else {
+          int failures = ++m_pending[j].failures;
+          ULONGLONG retry = min(WRITE_DELAY << min(failures - 1, 16), MAX_RETRY_DELAY);
+          m_pending[j].due = GetTickCount64() + retry;
+          DEBUG_LOG_FMT("ConfigWriter: %ls not written (%d failures), retry in %llu ms",
+                        due[i].path.wc_str(), failures, retry);
+        }
+      }
+      break;
+    }
+
+    if (!known)
+      continue;
+
+    size_t j = 0;
+    while (j < m_written.size() && m_written[j].path.CmpNoCase(due[i].path) != 0)
+      ++j;
+    if (j == m_written.size()) {
+      m_written.push_back(WrittenFile());
+      m_written[j].path = due[i].path;
+    }
+    m_written[j].data = data;
+  }
+
+  // Next save or retry due
+  DWORD delay = INFINITE;
+  ULONGLONG current = GetTickCount64();
+  wxCriticalSectionLocker locker(m_lock);
+  for (size_t i = 0; i < m_pending.size(); ++i) {
+    ULONGLONG wait = m_pending[i].due > current ? m_pending[i].due - current : 0;
+    if (wait < delay)
+      delay = DWORD(wait);
+  }
+
+  return delay;
+}
+
+bool ConfigWriter::WriteAtomically(const PendingFile& file)
+{
+  // Same directory as the target: the rename never crosses volumes
+  wxString temp = file.path + _T (".tmp");
+
+  HANDLE handle = CreateFileW(temp.wc_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE) {
+    DEBUG_LOG_FMT("ConfigWriter: cannot create %ls (%lu)", temp.wc_str(), GetLastError());
+    return false;
+  }
+
+  DWORD size = 0;
+  bool ok =
+      ::WriteFile(handle, file.content.data(), DWORD(file.content.size()), &size, NULL) &&
+      size == file.content.size() && FlushFileBuffers(handle);
+  CloseHandle(handle);
+
+  if (ok)
+    ok = MoveFileExW(temp.wc_str(), file.path.wc_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+
+  if (!ok) {
+    DEBUG_LOG_FMT("ConfigWriter: cannot write %ls (%lu)", file.path.wc_str(), GetLastError());
+    DeleteFileW(temp.wc_str());
+  }
+
+  return ok;
+}
+
+bool ConfigWriter::IsPending(const wxString& path)
+{
+  wxCriticalSectionLocker locker(m_lock);
+
+  for (size_t i = 0; i < m_pending.size(); ++i) {
+    if (m_pending[i].path.CmpNoCase(path) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+bool ConfigWriter::IsOwnWrite(const wxString& path)
+{
+  // Last write time to the 100 ns, and the size: an edition in the same second differs
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesExW(path.wc_str(), GetFileExInfoStandard, &data))
+    return false;
+
+  wxCriticalSectionLocker locker(m_lock);
+
+  for (size_t i = 0; i < m_written.size(); ++i) {
+    if (m_written[i].path.CmpNoCase(path) == 0)
+      return CompareFileTime(&m_written[i].data.ftLastWriteTime, &data.ftLastWriteTime) == 0 &&
+             m_written[i].data.nFileSizeLow == data.nFileSizeLow &&
+             m_written[i].data.nFileSizeHigh == data.nFileSizeHigh;
+  }
+
+  return false;
+}
@@ -0,0 +1,86 @@
+#ifndef __CONFIG_WRITER_H__
+#define __CONFIG_WRITER_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include <string>
+#include <vector>
+
+class wxXmlDocument;
+
+// Writes the configuration files (WinSplit.xml, see ConfigStore) off the UI thread.
+// Saving a file only hands its new content over: the write is done later by a worker
+// thread, and a file saved again meanwhile is written once, with its last content.
+// Each file is written to a temporary file next to it, flushed to the disk, then renamed
+// over the original: a crash leaves either the old or the new file, never a truncated one.
+// A file that cannot be written (locked by an editor or an antivirus, disk full) stays
+// pending and is tried again later, with a growing delay.
+class ConfigWriter // Singleton class
+{
+private:
+  class WriterThread : public wxThread {
+  private:
+    ConfigWriter& m_writer;
+
+  public:
+    WriterThread(ConfigWriter& writer);
+    void* Entry();
+  };
+
+  struct PendingFile {
+    wxString path;
+    std::string content;
+    ULONGLONG due; // GetTickCount64
+    int failures;  // failed writes of this content in a row
+  };
+
+  struct WrittenFile {
+    wxString path;
+    WIN32_FILE_ATTRIBUTE_DATA data; // size and times after our write
+  };
+
+  static ConfigWriter* p_instance;
+
+  HANDLE m_wake; // set when a file is saved or on exit
+  WriterThread* p_thread;
+
+  wxCriticalSection m_lock; // guards the members below
+  std::vector<PendingFile> m_pending;
+  std::vector<WrittenFile> m_written;
+  bool m_exit;
+
+  wxCriticalSection m_diskLock; // one writer at a time: worker thread or Flush()
+
+  ConfigWriter();
+  ~ConfigWriter();
+
+  // Write the files due at 'now' (all of them if 'now' is 0), returns the delay until
+  // the next one (INFINITE if none)
+  DWORD WritePending(ULONGLONG now);
+  bool WriteAtomically(const PendingFile& file);
+
+public:
+  static ConfigWriter* GetInstance();
+  // Writes what is still pending
+  static void DeleteInstance();
+
+  // New content of a file, written after a short delay
+  void Save(const wxString& path, const wxXmlDocument& doc, int indent = 2);
+
+  // Write everything pending now, on the calling thread. Before reading a file back,
+  // before copying it, and on exit.
+  void Flush();
+
+  // True while a save of 'path' has not reached the disk
+  bool IsPending(const wxString& path);
+  // True if 'path' is still as our last write left it (the directory watcher ignores it)
+  bool IsOwnWrite(const wxString& path);
+};
+
+#endif // __CONFIG_WRITER_H__
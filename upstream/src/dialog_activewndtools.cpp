@@ -12,6 +12,7 @@
 
 #include "dialog_activewndtools.h"
 #include "hook.h"
+#include "main.h"
 
 void ActiveWndToolsDialog::ShowDialog()
 {
@@ -33,6 +34,8 @@ ActiveWndToolsDialog::ActiveWndToolsDialog(wxWindow* parent, HWND activeWindow)
   m_bIsAlwaysOnTop = ((lStyle & WS_EX_TOPMOST) == WS_EX_TOPMOST);
   // Recover transparency, if possible
   GetTransparencyValues(m_hActiveWindow, m_bIsTransparent, m_iTranparency);
+  // The screenshot is saved as PNG, JPEG or BMP
+  wxGetApp().InitImageHandlers();
 
   GetScreenShots();
   CreateControls();
@@ -1,22 +1,76 @@
 #include <wx/accel.h>
 #include <wx/button.h>
 #include <wx/checkbox.h>
+#include <wx/combobox.h>
 #include <wx/dialog.h>
 #include <wx/icon.h>
 #include <wx/sizer.h>
 #include <wx/slider.h>
+#include <wx/spinctrl.h>
+#include <wx/stattext.h>
 
 #include <algorithm>
 
 #include "dialog_fusion.h"
 
+#include "debug_log.h"
+
 #include "../images/icone.xpm"
 
+using namespace std;
+
+namespace {
+  // Frame period when the refresh rate of the monitor is unknown (ms)
+  const int DEFAULT_FRAME_PERIOD = 16;
+
+  // Window titles are shortened to this length in the list of splits
+  const size_t TITLE_LENGTH = 20;
+}
+
+// Period of a refresh of the monitor (ms): the windows are placed at most once per frame
+static int GetFramePeriod(HMONITOR hmonitor)
+{
+  MONITORINFOEX monitor_info;
+  monitor_info.cbSize = sizeof(MONITORINFOEX);
+
+  DEVMODE mode;
+  ZeroMemory(&mode, sizeof(mode));
+  mode.dmSize = sizeof(DEVMODE);
+
+  // 0 and 1 stand for the default rate of the hardware
+  if (GetMonitorInfo(hmonitor, &monitor_info) &&
+      EnumDisplaySettings(monitor_info.szDevice, ENUM_CURRENT_SETTINGS, &mode) &&
+      mode.dmDisplayFrequency > 1)
+    return max(1, int(1000 / mode.dmDisplayFrequency));
+
+  return DEFAULT_FRAME_PERIOD;
+}
+
+static bool SameRect(const ScreenRect& a, const ScreenRect& b)
+{
+  return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
 FusionDialog::FusionDialog(wxWindow* parent, wxWindowID id, const wxString& title,
                            const wxPoint& position, const wxSize& size, long style)
     : wxDialog(parent, id, _("Windows fusion"), position, size, style)
+    , m_candidates()
+    , m_placements()
+    , m_merged(0)
+    , m_windows()
+    , m_geometry()
+    , m_tree()
+    , m_split(0)
+    , m_batcher(0, false)
+    , m_frameTimer()
+    , m_framePeriod(DEFAULT_FRAME_PERIOD)
+    , m_applied()
+    , m_received(0)
+    , m_layouts(0)
     , p_checkSwitch(NULL)
     , p_checkHV(NULL)
+    , p_spinWindows(NULL)
+    , p_cmbSplit(NULL)
     , p_sliderRatio(NULL)
     , p_btnCenter(NULL)
 {
@@ -25,7 +79,12 @@ FusionDialog::FusionDialog(wxWindow* parent, wxWindowID id, const wxString& titl
   Center();
 }
 
-FusionDialog::~FusionDialog() {}
+FusionDialog::~FusionDialog()
+{
+  DEBUG_LOG_FMT("FusionDialog: %d slider events received, %d layouts applied",
+                int(m_received),
+                int(m_layouts));
+}
 
 void FusionDialog::CreateControls()
 {
@@ -58,6 +117,21 @@ void FusionDialog::CreateControls()
   mainSizer_haut->Add(p_btnCenter, 0, wxALIGN_CENTER | wxALL, 5);
 
   pmainSizer->Add(mainSizer_haut, 0, wxALIGN_CENTER | wxALL, 5);
+
+  // Number of windows merged, and the split moved by the slider
+  wxBoxSizer* splitSizer = new wxBoxSizer(wxHORIZONTAL);
+  splitSizer->Add(
+      new wxStaticText(this, wxID_ANY, _("Windows")), 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+  p_spinWindows = new wxSpinCtrl(
+      this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(50, -1), wxSP_ARROW_KEYS, 2, 2, 2);
+  splitSizer->Add(p_spinWindows, 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+  splitSizer->Add(
+      new wxStaticText(this, wxID_ANY, _("Split")), 0, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+  p_cmbSplit = new wxComboBox(
+      this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(220, -1), 0, NULL, wxCB_READONLY);
+  splitSizer->Add(p_cmbSplit, 1, wxALIGN_CENTER_VERTICAL | wxALL, 5);
+  pmainSizer->Add(splitSizer, 0, wxALIGN_CENTER | wxLEFT | wxRIGHT, 10);
+
   pmainSizer->Add(p_sliderRatio, 0, wxALIGN_CENTER | wxALL, 10);
 
   wxBoxSizer* btnSizer = new wxBoxSizer(wxHORIZONTAL);
@@ -89,135 +163,225 @@ void FusionDialog::CreateConnexions()
                        wxCommandEventHandler(FusionDialog::OnButtonCentre),
                        NULL,
                        this);
+  p_spinWindows->Connect(wxEVT_COMMAND_SPINCTRL_UPDATED,
+                         wxSpinEventHandler(FusionDialog::OnWindowCount),
+                         NULL,
+                         this);
+  p_cmbSplit->Connect(wxEVT_COMMAND_COMBOBOX_SELECTED,
+                      wxCommandEventHandler(FusionDialog::OnSplitSelected),
+                      NULL,
+                      this);
+
+  // Sent once per change of value, whatever the input (thumb, keyboard, page, wheel)
+  p_sliderRatio->Connect(wxEVT_COMMAND_SLIDER_UPDATED,
+                         wxCommandEventHandler(FusionDialog::OnSlider),
+                         NULL,
+                         this);
+
+  m_frameTimer.SetOwner(this, wxID_ANY);
+  Connect(wxEVT_TIMER, wxTimerEventHandler(FusionDialog::OnFrame), NULL, this);
+}
 
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_CHANGED, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_THUMBRELEASE, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_THUMBTRACK, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_PAGEDOWN, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_PAGEUP, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_LINEDOWN, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_LINEUP, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_BOTTOM, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-  p_sliderRatio->Connect(
-      wxEVT_SCROLL_TOP, wxScrollEventHandler(FusionDialog::OnScrollSlide), NULL, this);
-}
-
-void FusionDialog::InitialisationFrame()
+void FusionDialog::SetWindows(const vector<HWND>& windows)
 {
   HMONITOR hmonitor;
   MONITORINFO monitor_info;
 
+  m_candidates = windows;
+  m_placements.resize(windows.size());
+  for (size_t i = 0; i < windows.size(); ++i) {
+    m_placements[i].length = sizeof(WINDOWPLACEMENT);
+    GetWindowPlacement(windows[i], &m_placements[i]);
+  }
+
   // Get information related to the current monitor => Management of multi-monitor
-  hmonitor = MonitorFromWindow(AppToMerge[0], MONITOR_DEFAULTTONEAREST);
+  hmonitor = MonitorFromWindow(m_candidates[0], MONITOR_DEFAULTTONEAREST);
   monitor_info.cbSize = sizeof(MONITORINFO);
   GetMonitorInfo(hmonitor, &monitor_info);
 
   cadre = monitor_info.rcWork;
+  m_framePeriod = GetFramePeriod(hmonitor);
 
-  ShowWindow(AppToMerge[0], SW_SHOWNORMAL);
-  ShowWindow(AppToMerge[1], SW_SHOWNORMAL);
+  p_spinWindows->SetRange(2, int(windows.size()));
+  p_spinWindows->SetValue(2);
+  p_spinWindows->Enable(windows.size() > 2);
 
-  ResizeAt((cadre.right - cadre.left) / 2);
-  p_sliderRatio->SetValue(25);
+  SetWindowCount(2);
 
   p_sliderRatio->SetFocus();
 }
 
-void FusionDialog::SetTabHwnd(HWND tab[2])
+void FusionDialog::SetWindowCount(size_t count)
 {
-  AppToMerge[0] = tab[0];
-  AppToMerge[1] = tab[1];
-  InitialisationFrame();
+  // A layout still waiting could move a window put back below
+  m_frameTimer.Stop();
+
+  // Windows left out go back where they were, new ones leave their maximized state
+  for (size_t i = count; i < m_merged; ++i)
+    SetWindowPlacement(m_candidates[i], &m_placements[i]);
+  for (size_t i = m_merged; i < count; ++i)
+    ShowWindow(m_candidates[i], SW_SHOWNORMAL);
+
+  m_merged = count;
+  m_tree.Build(count);
+  m_tree.SetOrientation(p_checkHV->IsChecked() ? SPLIT_STACKED : SPLIT_SIDE_BY_SIDE);
+  m_split = 0;
+
+  LoadWindows();
+  FillSplits();
+  UpdateSlider();
+  ApplyLayout();
 }
 
-void FusionDialog::OnScrollSlide(wxScrollEvent& event)
+void FusionDialog::LoadWindows()
 {
-  double size;
+  WindowGeometryCache* p_geometry = WindowGeometryCache::GetInstance();
 
-  if (!p_checkHV->IsChecked())
-    size = (cadre.right - cadre.left) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
-  else
-    size = (cadre.bottom - cadre.top) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
+  m_windows.assign(m_candidates.begin(), m_candidates.begin() + m_merged);
+  if (p_checkSwitch->IsChecked())
+    reverse(m_windows.begin(), m_windows.end());
 
-  ResizeAt((int)size);
+  // Their state may have changed since the last read (restored from maximized)
+  for (size_t i = 0; i < m_windows.size(); ++i)
+    p_geometry->Invalidate(m_windows[i]);
+  p_geometry->Query(m_windows, m_geometry);
+
+  // Other windows in the same places: everything is placed again
+  m_applied.clear();
 }
 
-void FusionDialog::ResizeAt(const int& pos)
+wxString FusionDialog::GetWindowTitles(size_t begin, size_t count)
 {
-  if (!p_checkHV->IsChecked()) {
-    SetWindowPos(AppToMerge[0],
-                 HWND_TOP,
-                 cadre.left,
-                 cadre.top,
-                 pos,
-                 cadre.bottom - cadre.top,
-                 SWP_NOACTIVATE | SWP_SHOWWINDOW | SWP_NOZORDER);
-    SetWindowPos(AppToMerge[1],
-                 HWND_TOP,
-                 cadre.left + pos,
-                 cadre.top,
-                 cadre.right - cadre.left - pos,
-                 cadre.bottom - cadre.top,
-                 SWP_NOACTIVATE | SWP_SHOWWINDOW | SWP_NOZORDER);
+  wxString titles;
+  wxChar text[256];
+
+  for (size_t i = begin; i < begin + count; ++i) {
+    GetWindowText(m_windows[i], text, 255);
+    wxString title(text);
+    if (title.Length() > TITLE_LENGTH)
+      title = title.Left(TITLE_LENGTH) + _T ("...");
+
+    if (i != begin)
+      titles += _T (" + ");
+    titles += title;
   }
-  else {
-    SetWindowPos(AppToMerge[0],
-                 HWND_TOP,
-                 cadre.left,
-                 cadre.top,
-                 cadre.right - cadre.left,
-                 pos,
-                 SWP_NOACTIVATE | SWP_SHOWWINDOW | SWP_NOZORDER);
-    SetWindowPos(AppToMerge[1],
-                 HWND_TOP,
-                 cadre.left,
-                 cadre.top + pos,
-                 cadre.right - cadre.left,
-                 cadre.bottom - cadre.top - pos,
-                 SWP_NOACTIVATE | SWP_SHOWWINDOW | SWP_NOZORDER);
+
+  return titles;
+}
+
+void FusionDialog::FillSplits()
+{
+  size_t begin, first_count, count;
+
+  p_cmbSplit->Clear();
+  for (size_t i = 0; i < m_tree.GetSplitCount(); ++i) {
+    m_tree.GetWindows(i, begin, first_count, count);
+    p_cmbSplit->Append(GetWindowTitles(begin, first_count) + _T (" | ") +
+                       GetWindowTitles(begin + first_count, count - first_count));
   }
+
+  p_cmbSplit->Select(int(m_split));
+  p_cmbSplit->Enable(m_tree.GetSplitCount() > 1);
 }
 
-void FusionDialog::SwitchWindows(wxCommandEvent& event)
+void FusionDialog::UpdateSlider()
 {
-  double size;
+  p_sliderRatio->SetValue(int(m_tree.GetRatio(m_split) * 50. + 0.5));
+}
 
-  std::swap(AppToMerge[0], AppToMerge[1]);
+void FusionDialog::ApplyLayout()
+{
+  ScreenRect area = {cadre.left, cadre.top, cadre.right - cadre.left, cadre.bottom - cadre.top};
+  vector<ScreenRect> rects;
+
+  m_frameTimer.Stop();
+  m_tree.Layout(area, rects);
+
+  // A slider step smaller than a pixel, or a split not moving these windows: nothing sent
+  bool placed = false;
+  for (size_t i = 0; i < m_windows.size(); ++i) {
+    if (!m_geometry[i].valid || (i < m_applied.size() && SameRect(rects[i], m_applied[i])))
+      continue;
+
+    wxRect visible(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+    m_batcher.Add(m_windows[i],
+                  m_geometry[i].WindowRectFor(visible),
+                  SWP_NOACTIVATE | SWP_SHOWWINDOW | SWP_NOZORDER);
+    placed = true;
+  }
 
-  if (!p_checkHV->IsChecked())
-    size = (cadre.right - cadre.left) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
-  else
-    size = (cadre.bottom - cadre.top) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
+  if (!placed)
+    return;
 
-  ResizeAt(int(size));
+  m_batcher.Flush();
+  m_applied.swap(rects);
+  ++m_layouts;
 }
 
-void FusionDialog::OnButtonCentre(wxCommandEvent& event)
+void FusionDialog::FlushLayout()
+{
+  if (m_frameTimer.IsRunning())
+    ApplyLayout();
+}
+
+void FusionDialog::RestoreWindows()
+{
+  m_frameTimer.Stop();
+
+  for (size_t i = 0; i < m_merged; ++i)
+    SetWindowPlacement(m_candidates[i], &m_placements[i]);
+}
+
+void FusionDialog::OnSlider(wxCommandEvent& event)
 {
-  if (!p_checkHV->IsChecked())
-    ResizeAt((cadre.right - cadre.left) / 2);
-  else
-    ResizeAt((cadre.bottom - cadre.top) / 2);
+  ++m_received;
+
+  // Superseded positions are dropped: the frame uses the ratio current at that time
+  m_tree.SetRatio(m_split, p_sliderRatio->GetValue() / 50.);
+  if (!m_frameTimer.IsRunning())
+    m_frameTimer.StartOnce(m_framePeriod);
+}
 
-  p_sliderRatio->SetValue(25);
+void FusionDialog::OnFrame(wxTimerEvent& event)
+{
+  ApplyLayout();
+}
+
+void FusionDialog::SwitchWindows(wxCommandEvent& event)
+{
+  // Ratios are kept, the windows take each other's place
+  LoadWindows();
+  FillSplits();
+  ApplyLayout();
+}
+
+void FusionDialog::OnButtonCentre(wxCommandEvent& event)
+{
+  m_tree.ResetRatio(m_split);
+  UpdateSlider();
+  ApplyLayout();
 }
 
 void FusionDialog::HorizontalVertical(wxCommandEvent& event)
 {
-  double size;
+  m_tree.SetOrientation(p_checkHV->IsChecked() ? SPLIT_STACKED : SPLIT_SIDE_BY_SIDE);
+  ApplyLayout();
+}
+
+void FusionDialog::OnWindowCount(wxSpinEvent& event)
+{
+  size_t count = size_t(max(2, min(event.GetPosition(), int(m_candidates.size()))));
 
-  if (!p_checkHV->IsChecked())
-    size = (cadre.right - cadre.left) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
-  else
-    size = (cadre.bottom - cadre.top) * (1. + (p_sliderRatio->GetValue() - 25.) / 25.) / 2.;
+  if (count != m_merged)
+    SetWindowCount(count);
+}
 
-  ResizeAt(int(size));
+void FusionDialog::OnSplitSelected(wxCommandEvent& event)
+{
+  int selection = p_cmbSplit->GetSelection();
+
+  if (selection >= 0) {
+    m_split = size_t(selection);
+    UpdateSlider();
+  }
 }
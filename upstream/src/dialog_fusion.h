@@ -4,30 +4,72 @@
 #include <Windows.h>
 
 #include <wx/dialog.h>
+#include <wx/timer.h>
+
+#include <vector>
+
+#include "functions_resize.h"
+#include "split_tree.h"
+#include "window_geometry.h"
 
 class wxCheckBox;
+class wxComboBox;
 class wxSlider;
+class wxSpinCtrl;
+class wxSpinEvent;
 class wxButton;
 
+// Fusion: the last active windows share the work area of the first one through a
+// SplitTree. The slider drives one split at a time. Slider input only updates the tree:
+// the layout is computed once per display frame from the last position received, and the
+// windows whose rect changed are placed in a single deferred transaction.
 class FusionDialog : public wxDialog {
 private:
-  HWND AppToMerge[2];
+  std::vector<HWND> m_candidates;            // last active windows, in Z order
+  std::vector<WINDOWPLACEMENT> m_placements; // of the candidates, restored on cancel
+  size_t m_merged;                           // candidates currently merged
+
+  std::vector<HWND> m_windows;            // merged windows, in layout order
+  std::vector<WindowGeometry> m_geometry; // their invisible borders
   RECT cadre;
+  SplitTree m_tree;
+  size_t m_split; // split driven by the slider
+  PlacementBatcher m_batcher;
+
+  wxTimer m_frameTimer;              // one slider layout pending at most, run on the next frame
+  int m_framePeriod;                 // ms
+  std::vector<ScreenRect> m_applied; // last rects sent, per merged window
+
+  // Debug instrumentation
+  size_t m_received; // slider events
+  size_t m_layouts;  // layouts placing at least one window
 
   wxCheckBox* p_checkSwitch;
   wxCheckBox* p_checkHV;
+  wxSpinCtrl* p_spinWindows;
+  wxComboBox* p_cmbSplit;
   wxSlider* p_sliderRatio;
   wxButton *p_btnCenter, *p_btnClose, *p_btnCancel;
 
   void CreateControls();
   void CreateConnexions();
-  void InitialisationFrame();
   void OnClose(wxCloseEvent& event);
   void OnButtonClick(wxCommandEvent& WXUNUSED(event));
-  void OnScrollSlide(wxScrollEvent& event);
+  void OnSlider(wxCommandEvent& event);
+  void OnFrame(wxTimerEvent& event);
   void SwitchWindows(wxCommandEvent& event);
   void OnButtonCentre(wxCommandEvent& ev);
   void HorizontalVertical(wxCommandEvent& event);
+  void OnWindowCount(wxSpinEvent& event);
+  void OnSplitSelected(wxCommandEvent& event);
+
+  void SetWindowCount(size_t count);
+  void LoadWindows();
+  void FillSplits();
+  void UpdateSlider();
+  wxString GetWindowTitles(size_t begin, size_t count);
+  // Place the merged windows whose rect changed since the last layout
+  void ApplyLayout();
 
 public:
   FusionDialog(wxWindow* parent = NULL, wxWindowID id = wxID_ANY,
@@ -38,8 +80,12 @@ public:
 
   ~FusionDialog();
 
-  void SetTabHwnd(HWND tab[2]);
-  void ResizeAt(const int& pos);
+  // At least two windows; the first two are merged at first
+  void SetWindows(const std::vector<HWND>& windows);
+  // Apply the slider layout still waiting for its frame
+  void FlushLayout();
+  // Put the merged windows back where they were
+  void RestoreWindows();
 };
 
 #endif //__MERGEWINDOWS_h__
@@ -344,6 +344,12 @@ void HotkeyConfigureDialog::InitList()
   p_listbox->InsertItem(21, _("Toggle virtual numpad"));
   p_listbox->SetItem(21, 1, GetIndexStr(21));
 
+  p_listbox->InsertItem(22, _("Move to upper screen"));
+  p_listbox->SetItem(22, 1, GetIndexStr(22));
+
+  p_listbox->InsertItem(23, _("Move to lower screen"));
+  p_listbox->SetItem(23, 1, GetIndexStr(23));
+
   p_listbox->SetItemState(0, wxLIST_STATE_SELECTED, wxLIST_STATE_SELECTED);
   m_item_selected = 0;
 
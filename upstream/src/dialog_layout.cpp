@@ -3,6 +3,7 @@
 
 #include "../images/icone.xpm"
 #include "dialog_layout.h"
+#include "main.h"
 
 using namespace std;
 
@@ -240,6 +241,9 @@ LayoutDialog::LayoutDialog(wxWindow* parent, wxWindowID id, const wxString& titl
   tab_seq_tmp.resize(9);
   LayoutManager::GetInstance()->CopyTable(tab_seq_tmp);
 
+  // The screen schema, the preview frame and the wallpaper are image files
+  wxGetApp().InitImageHandlers();
+
   CreateControls();
   CreateConnections();
 
@@ -2,6 +2,7 @@
 
 #include "main.h"
 
+#include "config_store.h"
 #include "dialog_update.h"
 #include "dialog_selectsettings.h"
 #include "frame_virtualnumpad.h"
@@ -18,8 +19,9 @@
 OptionsDialog::OptionsDialog(wxWindow* parent)
     : wxDialog(parent, -1, _("Options"), wxDefaultPosition)
     , m_options(SettingsManager::Get())
+    , p_autoPlacement(AutoPlacementManager::GetInstance())
 {
-  m_autoPlacement.LoadData();
+  p_autoPlacement->ReloadIfChanged();
   p_virtNumpad = NULL;
   p_updateThread = NULL;
   m_timerCount = 0;
@@ -143,10 +145,10 @@ void OptionsDialog::CreateAndFillPage_General(wxNotebook* book)
   book->AddPage(pnlGeneral, _("General"));
 
   // Fill the combobox for self-placement
-  wxArrayString array_name(m_autoPlacement.GetArrayName());
+  wxArrayString array_name(p_autoPlacement->GetArrayName());
   p_cmbAutoPlacement->Clear();
 
-  if (!m_autoPlacement.IsEmpty()) {
+  if (!p_autoPlacement->IsEmpty()) {
     for (int i = 0; i < int(array_name.Count()); ++i)
       p_cmbAutoPlacement->Append(array_name[i]);
   }
@@ -436,6 +438,30 @@ void OptionsDialog::CreateAndFillPage_Misc(wxNotebook* book)
       _("Minimize and Maximize hotkeys gives a 'Minimize / Maximize / Restored' state cycle."));
   p_checkMinMaxCycle->SetValue(m_options.getMinMaxCycle());
   stbszr->Add(p_checkMinMaxCycle, 0, wxALL, 5);
+  p_checkAnimateSnap = new wxCheckBox(
+      pnlMisc, wxID_ANY, _("Animate windows when they are snapped to a zone or another screen."));
+  p_checkAnimateSnap->SetValue(m_options.getAnimateSnap());
+  stbszr->Add(p_checkAnimateSnap, 0, wxALL, 5);
+  lnszr = new wxBoxSizer(wxHORIZONTAL);
+  lnszr->Add(new wxStaticText(pnlMisc, -1, _("Mosaic layout:")),
+             0,
+             wxRIGHT | wxALIGN_CENTER_VERTICAL,
+             5);
+  p_cmbTiling = new wxComboBox(
+      pnlMisc, -1, wxEmptyString, wxDefaultPosition, wxDefaultSize, 0, NULL, wxCB_READONLY);
+  p_cmbTiling->Append(_("Grid"));
+  p_cmbTiling->Append(_("Main window and stack"));
+  p_cmbTiling->Append(_("Proportional to the window sizes"));
+  p_cmbTiling->Select(m_options.getTilingAlgorithm());
+  lnszr->Add(p_cmbTiling, 0, wxALL, 0);
+  lnszr->Add(new wxStaticText(pnlMisc, -1, _("Gap between the windows (pixels):")),
+             0,
+             wxLEFT | wxRIGHT | wxALIGN_CENTER_VERTICAL,
+             5);
+  p_txtTilingGap = new wxTextCtrl(pnlMisc, wxID_ANY, _T (""), wxDefaultPosition, wxSize(50, -1));
+  p_txtTilingGap->SetValue(wxString::Format(_T ("%0d"), m_options.getTilingGap()));
+  lnszr->Add(p_txtTilingGap, 0, wxALL, 0);
+  stbszr->Add(lnszr, 0, wxALL | wxEXPAND, 5);
   pageszr->Add(stbszr, 0, wxALL | wxEXPAND, 5);
   pnlMisc->SetSizer(pageszr);
   p_nBook->AddPage(pnlMisc, _("Misc"));
@@ -563,6 +589,18 @@ void OptionsDialog::CreateEventConnections()
                               wxCommandEventHandler(OptionsDialog::OnSomethingHasChanged),
                               NULL,
                               this);
+  p_checkAnimateSnap->Connect(wxEVT_COMMAND_CHECKBOX_CLICKED,
+                              wxCommandEventHandler(OptionsDialog::OnSomethingHasChanged),
+                              NULL,
+                              this);
+  p_cmbTiling->Connect(wxEVT_COMMAND_COMBOBOX_SELECTED,
+                       wxCommandEventHandler(OptionsDialog::OnSomethingHasChanged),
+                       NULL,
+                       this);
+  p_txtTilingGap->Connect(wxEVT_COMMAND_TEXT_UPDATED,
+                          wxCommandEventHandler(OptionsDialog::OnSomethingHasChanged),
+                          NULL,
+                          this);
 
   // OK and Apply buttons
   p_btnApply->Connect(wxEVT_COMMAND_BUTTON_CLICKED,
@@ -584,10 +622,9 @@ void OptionsDialog::SetVirtualNumPad(VirtualNumpad* numpad)
 
 void OptionsDialog::OnDeleteAutoPlacementClicked(wxCommandEvent& event)
 {
-  if (!m_autoPlacement.IsEmpty()) {
-    m_autoPlacement.DeleteApplication(p_cmbAutoPlacement->GetSelection());
-    m_autoPlacement.SaveData();
-    m_autoPlacement.LoadData();
+  if (!p_autoPlacement->IsEmpty()) {
+    p_autoPlacement->DeleteApplication(p_cmbAutoPlacement->GetSelection());
+    p_autoPlacement->SaveData();
     p_cmbAutoPlacement->Delete(p_cmbAutoPlacement->GetCurrentSelection());
     if (p_cmbAutoPlacement->GetCount() == 0) {
       p_cmbAutoPlacement->Append(_("No registered process"));
@@ -721,10 +758,9 @@ bool OptionsDialog::ApplyChanges()
   // "Virtual Numpad" tab
   m_options.setSaveNumpadPosOnExit(p_checkSaveVirtNumpad->GetValue());
   m_options.setShowNumpadAtBoot(p_checkShowVirtStart->GetValue());
+  // The numpad follows these two by itself (TrayIcon::OnSettingChanged)
   m_options.setNumpadAutoHide(p_checkAutoHide->GetValue());
-  p_virtNumpad->SetCheckValue(!p_checkAutoHide->GetValue());
   m_options.setNumpadTransparency(p_sliderNumpadTransparency->GetValue());
-  p_virtNumpad->SetTransparency(p_sliderNumpadTransparency->GetValue());
   // "Web update" tab
   m_options.setCheckForUpdates(p_checkUpdate->GetValue());
   m_options.setUpdateCheckFrequency(p_cmbUpdate->GetSelection() + 1);
@@ -744,6 +780,11 @@ bool OptionsDialog::ApplyChanges()
   m_options.setMouseFollowWindow(p_checkFollowWnd->GetValue());
   m_options.setMouseFollowOnlyWhenIn(p_checkFollowOnlyIn->GetValue());
   m_options.setMinMaxCycle(p_checkMinMaxCycle->GetValue());
+  m_options.setAnimateSnap(p_checkAnimateSnap->GetValue());
+  m_options.setTilingAlgorithm(p_cmbTiling->GetSelection());
+  sValue = p_txtTilingGap->GetValue();
+  if (sValue.ToLong(&l))
+    m_options.setTilingGap((int)l);
 
   return true;
 }
@@ -863,28 +904,17 @@ void OptionsDialog::OnExportSettings(wxCommandEvent& event)
     return;
   }
   wxZipOutputStream z_out(f_out, 9);
-  if (iSel && SST_GENERAL) {
-    wxFileInputStream f_in(m_options.GetDataDirectory() + _T ("Settings.xml"));
-    z_out.PutNextEntry(_T ("Settings.xml"));
-    z_out << f_in;
-  }
+  // Same entries as before the configuration store: one former file per section, so
+  // older versions can import the export
+  const int flags[NB_CONFIG_SECTIONS] = {SST_GENERAL, SST_HOTKEYS, SST_LAYOUT, SST_PLACES};
+  ConfigStore* store = ConfigStore::GetInstance();
 
-  if (iSel && SST_HOTKEYS) {
-    wxFileInputStream f_in(m_options.GetDataDirectory() + _T ("hotkeys.xml"));
-    z_out.PutNextEntry(_T ("hotkeys.xml"));
-    z_out << f_in;
-  }
-  if (iSel && SST_LAYOUT) {
-    wxFileInputStream f_in(m_options.GetDataDirectory() + _T ("layout.xml"));
-    z_out.PutNextEntry(_T ("layout.xml"));
-    z_out << f_in;
-  }
-  if (iSel && SST_PLACES) {
-    wxFileInputStream f_in(m_options.GetDataDirectory() + _T ("auto_placement.xml"));
-    if (f_in.IsOk()) {
-      z_out.PutNextEntry(_T ("auto_placement.xml"));
-      z_out << f_in;
-    }
+  for (int i = 0; i < NB_CONFIG_SECTIONS; ++i) {
+    if (!(iSel & flags[i]) || !store->GetSection(CONFIG_SECTION(i)))
+      continue;
+
+    z_out.PutNextEntry(ConfigStore::GetLegacyFileName(CONFIG_SECTION(i)));
+    store->ExportSection(CONFIG_SECTION(i), z_out);
   }
 }
 
@@ -907,12 +937,9 @@ void OptionsDialog::OnImportSettings(wxCommandEvent& event)
   }
   wxZipInputStream z_in(f_in);
   std::unique_ptr<wxZipEntry> entry;
-  wxString sDir = m_options.GetDataDirectory();
-  while (entry.reset(z_in.GetNextEntry()), entry.get() != NULL) {
-    wxString name = sDir + entry->GetName();
-    wxFileOutputStream f_out(name);
-    f_out << z_in;
-  }
+  ConfigStore* store = ConfigStore::GetInstance();
+  while (entry.reset(z_in.GetNextEntry()), entry.get() != NULL)
+    store->ImportLegacyFile(entry->GetName(), z_in);
   m_options.LoadSettings();
   EndModal(wxID_CANCEL);
 }
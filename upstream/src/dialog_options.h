@@ -26,7 +26,7 @@ private:
   unsigned int m_timerCount;
   SettingsManager& m_options;
   VirtualNumpad* p_virtNumpad;
-  AutoPlacementManager m_autoPlacement;
+  AutoPlacementManager* p_autoPlacement;
   wxNotebook* p_nBook;
 
   // Controls for the General tab
@@ -68,6 +68,9 @@ private:
   wxCheckBox* p_checkFollowWnd;
   wxCheckBox* p_checkFollowOnlyIn;
   wxCheckBox* p_checkMinMaxCycle;
+  wxCheckBox* p_checkAnimateSnap;
+  wxComboBox* p_cmbTiling;
+  wxTextCtrl* p_txtTilingGap;
 
   // Action buttons for the dialog
   wxButton *p_btnOk, *p_btnCancel, *p_btnApply;
@@ -0,0 +1,168 @@
+#include "dpi_cache.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <stddef.h>
+
+using namespace std;
+
+// Used when neither the monitor nor the system DPI can be read
+#define DEFAULT_DPI 96
+
+DpiCache::DpiCache(DpiPlatform& platform)
+    : m_platform(platform)
+    , m_monitors()
+    , m_systemDpi(0)
+    , m_valid(false)
+    , m_rebuiltForUnknown(false)
+{
+}
+
+void DpiCache::Rebuild()
+{
+  vector<MonitorArea> monitors;
+  m_platform.EnumMonitors(monitors);
+
+  m_monitors.clear();
+  m_monitors.reserve(monitors.size());
+
+  for (size_t i = 0; i < monitors.size(); ++i) {
+    Entry entry;
+    entry.handle = monitors[i].handle;
+    entry.area = monitors[i].area;
+    entry.dpi = m_platform.QueryMonitorDpi(entry.handle);
+
+    if (entry.dpi == 0)
+      entry.dpi = GetSystemDpi();
+
+    m_monitors.push_back(entry);
+  }
+
+  m_valid = true;
+}
+
+unsigned int DpiCache::GetSystemDpi()
+{
+  // Queried at most once, and only if a monitor DPI could not be read
+  if (m_systemDpi == 0) {
+    m_systemDpi = m_platform.QuerySystemDpi();
+    if (m_systemDpi == 0)
+      m_systemDpi = DEFAULT_DPI;
+  }
+
+  return m_systemDpi;
+}
+
+// Distance from a point to a rect, 0 inside
+static long long DistanceToRect(int x, int y, const ScreenRect& rect)
+{
+  long long dx = 0;
+  long long dy = 0;
+
+  if (x < rect.x)
+    dx = rect.x - x;
+  else if (x >= rect.x + rect.width)
+    dx = x - (rect.x + rect.width - 1);
+
+  if (y < rect.y)
+    dy = rect.y - y;
+  else if (y >= rect.y + rect.height)
+    dy = y - (rect.y + rect.height - 1);
+
+  return dx * dx + dy * dy;
+}
+
+int DpiCache::IndexFromPoint(int x, int y)
+{
+  if (!m_valid)
+    Rebuild();
+
+  int nearest = -1;
+  long long distance_min = LLONG_MAX;
+
+  for (size_t i = 0; i < m_monitors.size(); ++i) {
+    long long distance = DistanceToRect(x, y, m_monitors[i].area);
+
+    if (distance < distance_min) {
+      distance_min = distance;
+      nearest = int(i);
+    }
+  }
+
+  return nearest;
+}
+
+int DpiCache::IndexFromRect(const ScreenRect& rect)
+{
+  if (!m_valid)
+    Rebuild();
+
+  int best = -1;
+  long long area_max = 0;
+
+  // Largest intersection first, like MonitorFromRect
+  for (size_t i = 0; i < m_monitors.size(); ++i) {
+    const ScreenRect& monitor = m_monitors[i].area;
+    long long w = min(rect.x + rect.width, monitor.x + monitor.width) - max(rect.x, monitor.x);
+    long long h = min(rect.y + rect.height, monitor.y + monitor.height) - max(rect.y, monitor.y);
+
+    if (w > 0 && h > 0 && w * h > area_max) {
+      area_max = w * h;
+      best = int(i);
+    }
+  }
+
+  // No intersection: the monitor nearest to the centre
+  if (best == -1)
+    best = IndexFromPoint(rect.x + rect.width / 2, rect.y + rect.height / 2);
+
+  return best;
+}
+
+MonitorHandle DpiCache::GetMonitorFromPoint(int x, int y)
+{
+  int index = IndexFromPoint(x, y);
+  return index == -1 ? NULL : m_monitors[index].handle;
+}
+
+MonitorHandle DpiCache::GetMonitorFromRect(const ScreenRect& rect)
+{
+  int index = IndexFromRect(rect);
+  return index == -1 ? NULL : m_monitors[index].handle;
+}
+
+unsigned int DpiCache::GetDpiForPoint(int x, int y)
+{
+  int index = IndexFromPoint(x, y);
+  return index == -1 ? GetSystemDpi() : m_monitors[index].dpi;
+}
+
+unsigned int DpiCache::GetDpiForRect(const ScreenRect& rect)
+{
+  int index = IndexFromRect(rect);
+  return index == -1 ? GetSystemDpi() : m_monitors[index].dpi;
+}
+
+unsigned int DpiCache::GetDpiForMonitor(MonitorHandle monitor)
+{
+  // Just enumerated: a handle missing from it is stale, not new
+  if (!m_valid) {
+    Rebuild();
+    m_rebuiltForUnknown = true;
+  }
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < m_monitors.size(); ++i) {
+      if (m_monitors[i].handle == monitor)
+        return m_monitors[i].dpi;
+    }
+
+    if (!monitor || pass > 0 || m_rebuiltForUnknown)
+      break;
+
+    m_rebuiltForUnknown = true;
+    Rebuild();
+  }
+
+  return GetSystemDpi();
+}
@@ -0,0 +1,76 @@
+#ifndef __DPI_CACHE_H__
+#define __DPI_CACHE_H__
+
+// Effective DPI of the monitors, queried once per display configuration.
+//
+// Monitor areas and their DPI are read when the cache is first used and kept until
+// Invalidate() (WM_DISPLAYCHANGE / WM_SETTINGCHANGE). A point or a rect is then resolved
+// to its monitor by arithmetic on the cached areas, with the same rules as
+// MonitorFromPoint / MonitorFromRect (MONITOR_DEFAULTTONEAREST).
+//
+// This file only depends on the standard library, the system is reached through
+// DpiPlatform so the number of calls can be checked against a simulated one.
+
+#include "screen_rect.h"
+
+#include <vector>
+
+typedef void* MonitorHandle;
+
+struct MonitorArea {
+  MonitorHandle handle;
+  ScreenRect area; // full monitor area, in physical pixels
+};
+
+class DpiPlatform {
+public:
+  virtual ~DpiPlatform() {}
+
+  // EnumDisplayMonitors
+  virtual void EnumMonitors(std::vector<MonitorArea>& monitors) = 0;
+  // GetDpiForMonitor (effective DPI), 0 on failure
+  virtual unsigned int QueryMonitorDpi(MonitorHandle monitor) = 0;
+  // GetDC(NULL) / GetDeviceCaps(LOGPIXELSX)
+  virtual unsigned int QuerySystemDpi() = 0;
+};
+
+class DpiCache {
+private:
+  struct Entry {
+    MonitorHandle handle;
+    ScreenRect area;
+    unsigned int dpi;
+  };
+
+  DpiPlatform& m_platform;
+  std::vector<Entry> m_monitors;
+  unsigned int m_systemDpi; // 0 until needed
+  bool m_valid;
+  bool m_rebuiltForUnknown; // an unknown handle already rebuilt the cache since Invalidate()
+
+  void Rebuild();
+  unsigned int GetSystemDpi();
+  int IndexFromPoint(int x, int y);
+  int IndexFromRect(const ScreenRect& rect);
+
+public:
+  explicit DpiCache(DpiPlatform& platform);
+
+  // Only marks the cache as stale, it is rebuilt on the next lookup
+  void Invalidate()
+  {
+    m_valid = false;
+    m_rebuiltForUnknown = false;
+  }
+
+  MonitorHandle GetMonitorFromPoint(int x, int y);
+  MonitorHandle GetMonitorFromRect(const ScreenRect& rect);
+
+  unsigned int GetDpiForPoint(int x, int y);
+  unsigned int GetDpiForRect(const ScreenRect& rect);
+  // An unknown handle rebuilds the cache (configuration change not notified yet), once per
+  // Invalidate(): a stale handle then gets the system DPI without enumerating again
+  unsigned int GetDpiForMonitor(MonitorHandle monitor);
+};
+
+#endif // __DPI_CACHE_H__
@@ -0,0 +1,110 @@
+#include "dpi_move.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Differences up to this many pixels come from rounding and are not corrected
+#define DPI_MOVE_TOLERANCE 1
+
+int ScaleDimension(int value, unsigned int numerator, unsigned int denominator)
+{
+  if (denominator == 0)
+    return value;
+
+  long long scaled = (long long)value * numerator;
+  long long half = denominator / 2;
+  long long divisor = denominator;
+
+  return int(scaled >= 0 ? (scaled + half) / divisor : (scaled - half) / divisor);
+}
+
+static bool Contains(const ScreenRect& screen, const ScreenRect& rect)
+{
+  return rect.x >= screen.x && rect.y >= screen.y &&
+         rect.x + rect.width <= screen.x + screen.width &&
+         rect.y + rect.height <= screen.y + screen.height;
+}
+
+ScreenRect MapRectToScreen(const ScreenRect& wnd, const ScreenInfo& from, const ScreenInfo& to)
+{
+  ScreenRect result = wnd;
+
+  if (from.work.width <= 0 || from.work.height <= 0)
+    return result;
+
+  double proportion_x = double(to.work.width) / from.work.width;
+  double proportion_y = double(to.work.height) / from.work.height;
+
+  result.x = to.work.x + (int)floor((wnd.x - from.work.x) * proportion_x + 0.5);
+  result.y = to.work.y + (int)floor((wnd.y - from.work.y) * proportion_y + 0.5);
+  result.width = (int)floor(wnd.width * proportion_x + 0.5);
+  result.height = (int)floor(wnd.height * proportion_y + 0.5);
+
+  if (!Contains(to.work, result)) {
+    result.x = to.work.x;
+    result.y = to.work.y;
+  }
+
+  return result;
+}
+
+ScreenRect PreScaleForDpi(const ScreenRect& target, unsigned int fromDpi, unsigned int toDpi)
+{
+  ScreenRect result = target;
+
+  if (fromDpi == toDpi || fromDpi == 0 || toDpi == 0)
+    return result;
+
+  result.width = ScaleDimension(target.width, fromDpi, toDpi);
+  result.height = ScaleDimension(target.height, fromDpi, toDpi);
+
+  // The application rounds too: pick the neighbour value that scales back exactly, if any
+  for (int delta = -1; delta <= 1; delta += 2) {
+    if (ScaleDimension(result.width, toDpi, fromDpi) != target.width &&
+        ScaleDimension(result.width + delta, toDpi, fromDpi) == target.width)
+      result.width += delta;
+
+    if (ScaleDimension(result.height, toDpi, fromDpi) != target.height &&
+        ScaleDimension(result.height + delta, toDpi, fromDpi) == target.height)
+      result.height += delta;
+  }
+
+  return result;
+}
+
+static bool IsNear(const ScreenRect& a, const ScreenRect& b, bool check_size)
+{
+  if (abs(a.x - b.x) > DPI_MOVE_TOLERANCE || abs(a.y - b.y) > DPI_MOVE_TOLERANCE)
+    return false;
+
+  if (!check_size)
+    return true;
+
+  return abs(a.width - b.width) <= DPI_MOVE_TOLERANCE &&
+         abs(a.height - b.height) <= DPI_MOVE_TOLERANCE;
+}
+
+int MoveWindowToScreen(WindowMoveBackend& wnd, const ScreenInfo& from, const ScreenInfo& to,
+                       bool resize)
+{
+  ScreenRect target = MapRectToScreen(wnd.GetRect(), from, to);
+  ScreenRect sent = target;
+  int nb_moves = 0;
+
+  // Only per-monitor aware windows rescale themselves; the others are scaled by DWM
+  // and keep the physical size we give them
+  if (resize && from.dpi != to.dpi && wnd.IsPerMonitorDpiAware())
+    sent = PreScaleForDpi(target, from.dpi, to.dpi);
+
+  wnd.SetRect(sent, resize);
+  ++nb_moves;
+
+  // Verify: the window is now on the destination monitor, a second move does not
+  // trigger another DPI change
+  if (!IsNear(wnd.GetRect(), target, resize)) {
+    wnd.SetRect(target, resize);
+    ++nb_moves;
+  }
+
+  return nb_moves;
+}
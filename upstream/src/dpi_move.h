@@ -0,0 +1,46 @@
+#ifndef __DPI_MOVE_H__
+#define __DPI_MOVE_H__
+
+// Cross-monitor move of a window, taking per-monitor DPI into account.
+//
+// A per-monitor DPI aware application receives WM_DPICHANGED when it lands on a monitor
+// with another scale factor and resizes itself by newDpi / oldDpi. Sending the final
+// size directly makes it relayout twice (our move, then its own rescale) and end up at
+// the wrong size. Instead the size is divided by the DPI ratio beforehand, so that the
+// application's own rescale produces the target rect; the result is then checked and
+// corrected only if the application did not behave as expected.
+//
+// This file only depends on the standard library, the window is reached through
+// WindowMoveBackend so the logic can be tested against simulated monitors.
+
+#include "screen_rect.h"
+
+struct ScreenInfo {
+  ScreenRect work; // work area in physical pixels
+  unsigned int dpi;
+};
+
+class WindowMoveBackend {
+public:
+  virtual ~WindowMoveBackend() {}
+
+  // Visible bounds of the window, in physical pixels
+  virtual ScreenRect GetRect() = 0;
+  virtual void SetRect(const ScreenRect& rect, bool resize) = 0;
+  virtual bool IsPerMonitorDpiAware() = 0;
+};
+
+// Scale a dimension like MulDiv() does (rounded to nearest)
+int ScaleDimension(int value, unsigned int numerator, unsigned int denominator);
+
+// Target rect of a window moved from one screen to another, proportional to the work areas
+ScreenRect MapRectToScreen(const ScreenRect& wnd, const ScreenInfo& from, const ScreenInfo& to);
+
+// Size to send so that a rescale by toDpi / fromDpi gives 'target' (position is unchanged)
+ScreenRect PreScaleForDpi(const ScreenRect& target, unsigned int fromDpi, unsigned int toDpi);
+
+// Move the window and return the number of SetRect() calls (1 unless a correction was needed)
+int MoveWindowToScreen(WindowMoveBackend& wnd, const ScreenInfo& from, const ScreenInfo& to,
+                       bool resize);
+
+#endif // __DPI_MOVE_H__
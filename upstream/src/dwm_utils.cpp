@@ -1,9 +1,13 @@
 #include "dwm_utils.h"
 
+#include "dpi_cache.h"
+
 #include <dwmapi.h>
 #include <shellscalingapi.h>
 #include <VersionHelpers.h>
 
+#include <unordered_map>
+
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "shcore.lib")
 
@@ -72,16 +76,72 @@ bool IsWindows11OrLater()
   return s_cachedMajorVersion >= 10 && s_cachedBuildNumber >= 22000;
 }
 
-bool GetInvisibleFrameBorders(HWND hwnd, LONG& left, LONG& top, LONG& right, LONG& bottom)
-{
-  left = top = right = bottom = 0;
+// Invisible frame borders are kept per window, with the frame related styles and the DPI:
+// windows of one class may draw different frames (Chrome_WidgetWin_1 hosts many apps).
+// Only the first use of a key costs a DWM query.
+namespace {
+  // Styles changing the non-client area; a style change gives another key
+  const DWORD FRAME_STYLES = WS_CAPTION | WS_THICKFRAME | WS_SYSMENU | WS_POPUP | WS_CHILD |
+                             WS_MAXIMIZE | WS_MINIMIZE;
+  const DWORD FRAME_EX_STYLES = WS_EX_DLGMODALFRAME | WS_EX_WINDOWEDGE | WS_EX_CLIENTEDGE |
+                                WS_EX_STATICEDGE | WS_EX_TOOLWINDOW | WS_EX_LAYOUTRTL;
+
+  // Upper bound, the entries of closed windows are dropped when it is reached
+  const size_t MAX_FRAME_ENTRIES = 256;
+
+  struct FrameKey {
+    HWND hwnd;
+    DWORD style;
+    DWORD exStyle;
+    UINT dpi;
+
+    bool operator==(const FrameKey& other) const
+    {
+      return hwnd == other.hwnd && style == other.style && exStyle == other.exStyle &&
+             dpi == other.dpi;
+    }
+  };
+
+  struct FrameKeyHash {
+    size_t operator()(const FrameKey& key) const
+    {
+      unsigned long long hash = 14695981039346656037ULL;
+      unsigned long long values[] = {(unsigned long long)(ULONG_PTR)key.hwnd, key.style,
+                                     key.exStyle, key.dpi};
+
+      for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        hash ^= values[i];
+        hash *= 1099511628211ULL;
+      }
+      return size_t(hash);
+    }
+  };
 
-  if (!IsVistaOrLater())
-    return false;
+  struct FrameBorders {
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+  };
 
-  if (!hwnd || !IsWindow(hwnd))
-    return false;
+  typedef std::unordered_map<FrameKey, FrameBorders, FrameKeyHash> FrameCache;
+  FrameCache s_frameCache;
+}
+
+// Only user32 reads, no DWM round-trip
+static FrameKey GetFrameKey(HWND hwnd)
+{
+  FrameKey key;
+  key.hwnd = hwnd;
+  key.style = DWORD(GetWindowLong(hwnd, GWL_STYLE)) & FRAME_STYLES;
+  key.exStyle = DWORD(GetWindowLong(hwnd, GWL_EXSTYLE)) & FRAME_EX_STYLES;
+  key.dpi = GetDpiForHwnd(hwnd);
+  return key;
+}
 
+// Measured borders, one DWM query
+static bool MeasureFrameBorders(HWND hwnd, FrameBorders& borders)
+{
   RECT windowRect;
   if (!GetWindowRect(hwnd, &windowRect))
     return false;
@@ -91,11 +151,76 @@ bool GetInvisibleFrameBorders(HWND hwnd, LONG& left, LONG& top, LONG& right, LON
   if (FAILED(hr))
     return false;
 
-  // Calculate the invisible borders
-  left = extFrame.left - windowRect.left;
-  top = extFrame.top - windowRect.top;
-  right = windowRect.right - extFrame.right;
-  bottom = windowRect.bottom - extFrame.bottom;
+  borders.left = extFrame.left - windowRect.left;
+  borders.top = extFrame.top - windowRect.top;
+  borders.right = windowRect.right - extFrame.right;
+  borders.bottom = windowRect.bottom - extFrame.bottom;
+  return true;
+}
+
+// Cached borders of the window, measured (one DWM query) when its key is first seen: a
+// window changing its frame styles or its DPI gets a new key and is measured again
+static bool GetFrameBorders(HWND hwnd, FrameBorders& borders)
+{
+  FrameKey key = GetFrameKey(hwnd);
+  FrameCache::const_iterator it = s_frameCache.find(key);
+
+  if (it != s_frameCache.end()) {
+    borders = it->second;
+    return true;
+  }
+
+  if (!MeasureFrameBorders(hwnd, borders))
+    return false; // composition off: not cached, the next call tries again
+
+  if (s_frameCache.size() >= MAX_FRAME_ENTRIES) {
+    for (FrameCache::iterator entry = s_frameCache.begin(); entry != s_frameCache.end();) {
+      if (IsWindow(entry->first.hwnd))
+        ++entry;
+      else
+        entry = s_frameCache.erase(entry);
+    }
+    if (s_frameCache.size() >= MAX_FRAME_ENTRIES)
+      s_frameCache.clear();
+  }
+
+  s_frameCache[key] = borders;
+  return true;
+}
+
+void InvalidateFrameCache()
+{
+  s_frameCache.clear();
+}
+
+void InvalidateFrameBorders(HWND hwnd)
+{
+  for (FrameCache::iterator it = s_frameCache.begin(); it != s_frameCache.end();) {
+    if (it->first.hwnd == hwnd)
+      it = s_frameCache.erase(it);
+    else
+      ++it;
+  }
+}
+
+bool GetInvisibleFrameBorders(HWND hwnd, LONG& left, LONG& top, LONG& right, LONG& bottom)
+{
+  left = top = right = bottom = 0;
+
+  if (!IsVistaOrLater())
+    return false;
+
+  if (!hwnd || !IsWindow(hwnd))
+    return false;
+
+  FrameBorders borders;
+  if (!GetFrameBorders(hwnd, borders))
+    return false;
+
+  left = borders.left;
+  top = borders.top;
+  right = borders.right;
+  bottom = borders.bottom;
 
   // Check if there actually are invisible borders
   return (left != 0 || top != 0 || right != 0 || bottom != 0);
@@ -108,27 +233,20 @@ wxRect GetWindowRectCompensated(HWND hwnd)
   if (!hwnd || !IsWindow(hwnd))
     return result;
 
-  if (IsVistaOrLater()) {
-    // Try to get DWM extended frame bounds (visible area)
-    RECT extFrame;
-    HRESULT hr = DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &extFrame, sizeof(RECT));
-    if (SUCCEEDED(hr)) {
-      result.x = extFrame.left;
-      result.y = extFrame.top;
-      result.width = extFrame.right - extFrame.left;
-      result.height = extFrame.bottom - extFrame.top;
-      return result;
-    }
-  }
-
-  // Fallback to standard GetWindowRect
   RECT windowRect;
-  if (GetWindowRect(hwnd, &windowRect)) {
-    result.x = windowRect.left;
-    result.y = windowRect.top;
-    result.width = windowRect.right - windowRect.left;
-    result.height = windowRect.bottom - windowRect.top;
-  }
+  if (!GetWindowRect(hwnd, &windowRect))
+    return result;
+
+  // Visible area: the window rect minus the cached invisible borders, DWM is only queried
+  // the first time a window is seen (or without composition, where there are no borders)
+  FrameBorders borders = {0, 0, 0, 0};
+  if (IsVistaOrLater())
+    GetFrameBorders(hwnd, borders);
+
+  result.x = windowRect.left + borders.left;
+  result.y = windowRect.top + borders.top;
+  result.width = (windowRect.right - borders.right) - result.x;
+  result.height = (windowRect.bottom - borders.bottom) - result.y;
 
   return result;
 }
@@ -150,6 +268,59 @@ wxRect AdjustForInvisibleFrame(HWND hwnd, const wxRect& targetRect)
   return adjusted;
 }
 
+namespace {
+  // The system side of the DPI cache
+  class Win32DpiPlatform : public DpiPlatform {
+  private:
+    static BOOL CALLBACK EnumProc(HMONITOR hMonitor, HDC hdc, LPRECT lprcMonitor, LPARAM data)
+    {
+      MonitorArea monitor;
+      monitor.handle = hMonitor;
+      monitor.area.x = lprcMonitor->left;
+      monitor.area.y = lprcMonitor->top;
+      monitor.area.width = lprcMonitor->right - lprcMonitor->left;
+      monitor.area.height = lprcMonitor->bottom - lprcMonitor->top;
+
+      ((std::vector<MonitorArea>*)data)->push_back(monitor);
+      return TRUE;
+    }
+
+  public:
+    void EnumMonitors(std::vector<MonitorArea>& monitors)
+    {
+      EnumDisplayMonitors(NULL, NULL, EnumProc, (LPARAM)&monitors);
+    }
+
+    unsigned int QueryMonitorDpi(MonitorHandle monitor)
+    {
+      UINT dpiX = 0, dpiY = 0;
+      if (FAILED(GetDpiForMonitor((HMONITOR)monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)))
+        return 0;
+
+      return dpiX;
+    }
+
+    unsigned int QuerySystemDpi()
+    {
+      HDC hdc = GetDC(NULL);
+      if (!hdc)
+        return 0;
+
+      int dpi = GetDeviceCaps(hdc, LOGPIXELSX);
+      ReleaseDC(NULL, hdc);
+      return dpi;
+    }
+  };
+
+  Win32DpiPlatform s_dpiPlatform;
+  DpiCache s_dpiCache(s_dpiPlatform);
+}
+
+void InvalidateDpiCache()
+{
+  s_dpiCache.Invalidate();
+}
+
 UINT GetDpiForHwnd(HWND hwnd)
 {
   // Try GetDpiForWindow (Windows 10 1607+)
@@ -171,37 +342,52 @@ UINT GetDpiForHwnd(HWND hwnd)
       return dpi;
   }
 
-  // Fallback: get DPI from monitor
-  if (hwnd) {
-    HMONITOR hMonitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
-    UINT dpiX = 96, dpiY = 96;
-    if (SUCCEEDED(GetDpiForMonitor(hMonitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY))) {
-      return dpiX;
-    }
-  }
-
-  // Ultimate fallback: system DPI
-  HDC hdc = GetDC(NULL);
-  if (hdc) {
-    int dpi = GetDeviceCaps(hdc, LOGPIXELSX);
-    ReleaseDC(NULL, hdc);
-    return dpi;
+  // Fallback: DPI of the monitor holding most of the window, from the cache
+  RECT windowRect;
+  if (hwnd && GetWindowRect(hwnd, &windowRect)) {
+    ScreenRect rect = {windowRect.left,
+                       windowRect.top,
+                       windowRect.right - windowRect.left,
+                       windowRect.bottom - windowRect.top};
+    return s_dpiCache.GetDpiForRect(rect);
   }
 
-  return 96; // Default DPI
+  return s_dpiCache.GetDpiForPoint(0, 0);
 }
 
 UINT GetDpiForPoint(int x, int y)
 {
-  POINT pt = {x, y};
-  HMONITOR hMonitor = MonitorFromPoint(pt, MONITOR_DEFAULTTONEAREST);
+  return s_dpiCache.GetDpiForPoint(x, y);
+}
+
+bool IsPerMonitorDpiAware(HWND hwnd)
+{
+  // Windows 10 1607+
+  typedef DPI_AWARENESS_CONTEXT(WINAPI * GetWindowDpiAwarenessContextPtr)(HWND);
+  typedef DPI_AWARENESS(WINAPI * GetAwarenessFromDpiAwarenessContextPtr)(DPI_AWARENESS_CONTEXT);
+  static GetWindowDpiAwarenessContextPtr pGetWindowContext = nullptr;
+  static GetAwarenessFromDpiAwarenessContextPtr pGetAwareness = nullptr;
+  static bool initialized = false;
 
-  UINT dpiX = 96, dpiY = 96;
-  if (SUCCEEDED(GetDpiForMonitor(hMonitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY))) {
-    return dpiX;
+  if (!initialized) {
+    HMODULE hUser32 = GetModuleHandleW(L"user32.dll");
+    if (hUser32) {
+      pGetWindowContext = (GetWindowDpiAwarenessContextPtr)GetProcAddress(
+          hUser32, "GetWindowDpiAwarenessContext");
+      pGetAwareness = (GetAwarenessFromDpiAwarenessContextPtr)GetProcAddress(
+          hUser32, "GetAwarenessFromDpiAwarenessContext");
+    }
+    initialized = true;
   }
 
-  return 96;
+  if (!pGetWindowContext || !pGetAwareness || !hwnd)
+    return false;
+
+  DPI_AWARENESS_CONTEXT context = pGetWindowContext(hwnd);
+  if (!context)
+    return false;
+
+  return pGetAwareness(context) == DPI_AWARENESS_PER_MONITOR_AWARE;
 }
 
 wxRect ScaleRectForDpi(const wxRect& rect, UINT fromDpi, UINT toDpi)
@@ -7,7 +7,8 @@
 namespace DwmUtils {
 
 // Get window rectangle with DWM invisible frame compensation.
-// On Windows 10/11, returns the visible bounds (excluding invisible frame).
+// On Windows 10/11, returns the visible bounds (excluding invisible frame), from the
+// window rect and the cached borders.
 // On older Windows or if DWM fails, returns standard GetWindowRect result.
 wxRect GetWindowRectCompensated(HWND hwnd);
 
@@ -19,15 +20,31 @@ wxRect AdjustForInvisibleFrame(HWND hwnd, const wxRect& targetRect);
 // Get the invisible frame borders for a window.
 // Returns true if the window has invisible borders, false otherwise.
 // left, top, right, bottom contain the border sizes in pixels.
+// Borders are cached per (window, frame styles, DPI): only the first use of a key costs
+// a DWM query.
 bool GetInvisibleFrameBorders(HWND hwnd, LONG& left, LONG& top, LONG& right, LONG& bottom);
 
+// Forget the cached frame borders (theme, border width, composition or scale factor changed).
+void InvalidateFrameCache();
+// Forget the borders of one window (it did not land where its borders said it would).
+void InvalidateFrameBorders(HWND hwnd);
+
 // Get DPI for a specific window.
 // Returns the DPI value (96 = 100%, 144 = 150%, 192 = 200%, etc.)
 UINT GetDpiForHwnd(HWND hwnd);
 
 // Get DPI for the monitor containing a point.
+// Monitor DPIs are cached (dpi_cache.h): this is a lookup, not a system query.
 UINT GetDpiForPoint(int x, int y);
 
+// Forget the cached monitor DPIs (display configuration or scale factor changed).
+// Called by MonitorTopology::Invalidate(), so both caches describe the same monitors.
+void InvalidateDpiCache();
+
+// True if the window rescales itself on WM_DPICHANGED (per-monitor aware v1 or v2).
+// DPI unaware and system aware windows are stretched by DWM instead.
+bool IsPerMonitorDpiAware(HWND hwnd);
+
 // Scale a rectangle from one DPI to another.
 wxRect ScaleRectForDpi(const wxRect& rect, UINT fromDpi, UINT toDpi);
 
@@ -8,6 +8,7 @@
 
 #pragma comment(lib, "shlwapi.lib")
 
+#include "animator.h"
 #include "dwm_utils.h"
 #include "frame_hook.h"
 #include "hook.h"
@@ -32,6 +33,7 @@ FrameHook::FrameHook(wxWindow* parent, wxWindowID id, const wxString& title, con
     , m_rectPrevious(-1, 0, 0, 0)
     , m_wheelpos(0)
     , m_wheelposPrevious(-1)
+    , m_settingsListener(0)
 {
   // To be sure that nothing appears
   SetTransparent(0);
@@ -39,11 +41,17 @@ FrameHook::FrameHook(wxWindow* parent, wxWindowID id, const wxString& title, con
   CreateControls();
   CreateConnection();
 
+  // The zone follows the options as they change, nothing is read again when a drag starts
+  m_settingsListener =
+      m_options.Subscribe([this](SETTING_ID setting) { OnSettingChanged(setting); });
+
   SetHook();
 }
 
 FrameHook::~FrameHook()
 {
+  m_options.Unsubscribe(m_settingsListener);
+
   // 1. Stop the drag timer first to prevent callbacks during cleanup
   if (m_timer.IsRunning())
     m_timer.Stop();
@@ -135,6 +143,24 @@ void FrameHook::CreateControls()
   p_panel->Disable();
 }
 
+void FrameHook::OnSettingChanged(SETTING_ID setting)
+{
+  switch (setting) {
+  case SETTING_DNG_ZONE_BG:
+    p_panel->SetBackgroundColour(m_options.getDnGZoneBgColor());
+    break;
+  case SETTING_DNG_ZONE_FG:
+    p_stcTxtInfo->SetForegroundColour(m_options.getDnGZoneFgColor());
+    break;
+  case SETTING_DNG_TRANSPARENCY:
+    m_iTransparency = m_options.getDngZoneTransparency();
+    p_panel->SetTransparent((255 * m_iTransparency) / 100);
+    break;
+  default:
+    break;
+  }
+}
+
 void FrameHook::CreateConnection()
 {
   WSM_STARTMOVING = RegisterWindowMessage(_T ("WinSplitMessage_StartMoving"));
@@ -220,15 +246,6 @@ WXLRESULT FrameHook::MSWWindowProc(WXUINT nMsg, WXWPARAM wparam, WXLPARAM lparam
   }
 
   if (nMsg == WSM_STARTMOVING) {
-    if (m_options.getDnGZoneBgColor() != p_panel->GetBackgroundColour())
-      p_panel->SetBackgroundColour(m_options.getDnGZoneBgColor());
-    if (m_options.getDnGZoneFgColor() != p_panel->GetForegroundColour())
-      p_stcTxtInfo->SetForegroundColour(m_options.getDnGZoneFgColor());
-    if (m_iTransparency != m_options.getDngZoneTransparency()) {
-      m_iTransparency = m_options.getDngZoneTransparency();
-      p_panel->SetTransparent((255 * m_iTransparency) / 100);
-    }
-
     if (!m_timer.IsRunning()) {
       m_wheelpos = 0;
       m_wheelposPrevious = 0;
@@ -285,13 +302,16 @@ void FrameHook::MoveWindowToDestination()
       // Adjust for invisible frame borders (Windows 10/11)
       wxRect adjusted = DwmUtils::AdjustForInvisibleFrame(hwnd, rect_dest);
 
-      SetWindowPos(hwnd,
-                   HWND_TOP,
-                   adjusted.x,
-                   adjusted.y,
-                   adjusted.width,
-                   adjusted.height,
-                   SWP_SHOWWINDOW);
+      Animator::GetInstance()->AnimateSnap(
+          hwnd, DwmUtils::GetWindowRectCompensated(hwnd), rect_dest, [=]() {
+            SetWindowPos(hwnd,
+                         HWND_TOP,
+                         adjusted.x,
+                         adjusted.y,
+                         adjusted.width,
+                         adjusted.height,
+                         SWP_SHOWWINDOW);
+          });
       m_rectPrevious.x = -1;
     }
   }
@@ -32,6 +32,7 @@ private:
   wxRect m_rectPrevious;
   int m_wheelpos;
   int m_wheelposPrevious;
+  unsigned int m_settingsListener;
 
   inline unsigned int ModifierToVK(const unsigned int& mod);
   bool IsDown();
@@ -44,6 +45,7 @@ private:
   void OnTimer(wxTimerEvent& event);
   WXLRESULT MSWWindowProc(WXUINT nMsg, WXWPARAM wParam, WXLPARAM lParam);
   void MoveWindowToDestination();
+  void OnSettingChanged(SETTING_ID setting);
 
 public:
   FrameHook(wxWindow* parent = NULL, wxWindowID id = 0,
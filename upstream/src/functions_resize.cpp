@@ -2,13 +2,21 @@
 
 #include <psapi.h>
 
+#include "animator.h"
 #include "auto_placement.h"
+#include "debug_log.h"
 #include "dialog_fusion.h"
 #include "dwm_utils.h"
+#include "functions_resize.h"
 #include "functions_special.h"
 #include "layout_manager.h"
 #include "list_windows.h"
 #include "multimonitor_move.h"
+#include "window_geometry.h"
+
+#include <algorithm>
+
+using namespace std;
 
 //=============================
 // Resize window
@@ -19,6 +27,9 @@ bool ResizeWindow(const int hotkey, bool fromKbd)
   bool flag_resizable = true;
   //((GetWindowLong(hwnd,GWL_STYLE)&WS_SIZEBOX)!=0);
 
+  // The next layout depends on where the window is: the previous press lands first
+  Animator::GetInstance()->FinishTransition(hwnd);
+
   wxRect res = LayoutManager::GetInstance()->GetNext(hwnd, hotkey - 1);
 
   WINDOWPLACEMENT placement;
@@ -29,23 +40,29 @@ bool ResizeWindow(const int hotkey, bool fromKbd)
     SetWindowPlacement(hwnd, &placement);
   }
 
+  // Kept by the transition: another window's move landing meanwhile has its own
   bool bMoveMouse = fromKbd & SettingsManager::Get().getMouseFollowWindow();
+  MouseAnchor anchor = {0, 0, 0, 0};
   if (bMoveMouse)
-    StoreOrSetMousePosition(true, hwnd);
+    anchor = StoreMousePosition(hwnd);
 
   // Adjust target rect for invisible frame borders (Windows 10/11)
   wxRect adjusted = DwmUtils::AdjustForInvisibleFrame(hwnd, res);
 
-  SetWindowPos(hwnd,
-               HWND_TOP,
-               adjusted.x,
-               adjusted.y,
-               adjusted.width,
-               adjusted.height,
-               flag_resizable ? SWP_SHOWWINDOW : SWP_NOSIZE);
+  // Played on a thumbnail when enabled, the window itself moves once at the end
+  Animator::GetInstance()->AnimateSnap(
+      hwnd, DwmUtils::GetWindowRectCompensated(hwnd), res, [=]() {
+        SetWindowPos(hwnd,
+                     HWND_TOP,
+                     adjusted.x,
+                     adjusted.y,
+                     adjusted.width,
+                     adjusted.height,
+                     flag_resizable ? SWP_SHOWWINDOW : SWP_NOSIZE);
 
-  if (bMoveMouse)
-    StoreOrSetMousePosition(false, hwnd);
+        if (bMoveMouse)
+          RestoreMousePosition(hwnd, anchor);
+      });
 
   return true;
 }
@@ -58,3 +75,185 @@ void MoveToScreen(DIRECTION sens)
 
   MoveWindowToDirection(hwnd, sens);
 }
+
+namespace {
+  // Offset of the workspace coordinates of WINDOWPLACEMENT on 'hmonitor'
+  wxPoint WorkspaceOffset(HMONITOR hmonitor)
+  {
+    MONITORINFO info;
+    info.cbSize = sizeof(MONITORINFO);
+    if (!hmonitor || !GetMonitorInfo(hmonitor, &info))
+      return wxPoint(0, 0);
+
+    return wxPoint(info.rcWork.left - info.rcMonitor.left, info.rcWork.top - info.rcMonitor.top);
+  }
+}
+
+wxRect GetNormalPosition(HWND hwnd)
+{
+  WINDOWPLACEMENT placement;
+  placement.length = sizeof(WINDOWPLACEMENT);
+  if (!GetWindowPlacement(hwnd, &placement))
+    return wxRect();
+
+  wxPoint offset = WorkspaceOffset(MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST));
+  const RECT& normal = placement.rcNormalPosition;
+  return wxRect(normal.left + offset.x,
+                normal.top + offset.y,
+                normal.right - normal.left,
+                normal.bottom - normal.top);
+}
+
+void RestoreAt(HWND hwnd, const wxRect& rect, bool maximize)
+{
+  WINDOWPLACEMENT placement;
+  placement.length = sizeof(WINDOWPLACEMENT);
+  if (!GetWindowPlacement(hwnd, &placement))
+    return;
+
+  RECT area = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+  wxPoint offset = WorkspaceOffset(MonitorFromRect(&area, MONITOR_DEFAULTTONEAREST));
+
+  placement.flags = 0;
+  placement.showCmd = SW_SHOWNOACTIVATE;
+  placement.rcNormalPosition.left = rect.x - offset.x;
+  placement.rcNormalPosition.top = rect.y - offset.y;
+  placement.rcNormalPosition.right = rect.x + rect.width - offset.x;
+  placement.rcNormalPosition.bottom = rect.y + rect.height - offset.y;
+  SetWindowPlacement(hwnd, &placement);
+
+  if (maximize)
+    ShowWindow(hwnd, SW_MAXIMIZE);
+}
+
+//=============================
+// Batched placement
+//=============================
+PlacementBatcher::PlacementBatcher(int delay, bool per_monitor)
+    : m_pending()
+    , m_timer()
+    , m_delay(delay)
+    , m_perMonitor(per_monitor)
+    , m_requested(0)
+    , m_transactions(0)
+{
+  m_timer.SetOwner(this, wxID_ANY);
+  Connect(wxEVT_TIMER, wxTimerEventHandler(PlacementBatcher::OnTimer), NULL, this);
+}
+
+PlacementBatcher::~PlacementBatcher()
+{
+  if (m_timer.IsRunning())
+    m_timer.Stop();
+}
+
+void PlacementBatcher::Add(HWND hwnd, const wxRect& rect, UINT flags)
+{
+  RECT target = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+  HMONITOR monitor = m_perMonitor ? MonitorFromRect(&target, MONITOR_DEFAULTTONEAREST) : NULL;
+
+  ++m_requested;
+
+  // Same window placed again before the flush: only the last position matters
+  for (size_t i = 0; i < m_pending.size(); ++i) {
+    if (m_pending[i].hwnd == hwnd) {
+      m_pending[i].rect = rect;
+      m_pending[i].flags = flags;
+      m_pending[i].monitor = monitor;
+      return;
+    }
+  }
+
+  PendingMove move;
+  move.hwnd = hwnd;
+  move.rect = rect;
+  move.flags = flags;
+  move.monitor = monitor;
+  m_pending.push_back(move);
+
+  // Not restarted by later placements, so that a steady stream still gets applied
+  if (!m_timer.IsRunning())
+    m_timer.StartOnce(m_delay);
+}
+
+void PlacementBatcher::Cancel()
+{
+  if (m_timer.IsRunning())
+    m_timer.Stop();
+
+  m_requested -= m_pending.size();
+  m_pending.clear();
+}
+
+void PlacementBatcher::OnTimer(wxTimerEvent& event)
+{
+  Flush();
+  event.Skip(false);
+}
+
+size_t PlacementBatcher::Flush()
+{
+  if (m_timer.IsRunning())
+    m_timer.Stop();
+
+  vector<PendingMove> pending;
+  pending.swap(m_pending);
+
+  // Windows closed while waiting are not counted
+  size_t received = pending.size();
+  pending.erase(remove_if(pending.begin(),
+                          pending.end(),
+                          [](const PendingMove& move) { return !IsWindow(move.hwnd); }),
+                pending.end());
+  m_requested -= received - pending.size();
+
+  stable_sort(pending.begin(), pending.end(), [](const PendingMove& a, const PendingMove& b) {
+    return a.monitor < b.monitor;
+  });
+
+  size_t moved = 0;
+  size_t transactions = 0;
+  vector<PendingMove>::iterator first = pending.begin();
+
+  while (first != pending.end()) {
+    vector<PendingMove>::iterator last = first;
+    while (last != pending.end() && last->monitor == first->monitor)
+      ++last;
+
+    HDWP hdwp = BeginDeferWindowPos(int(last - first));
+    vector<PendingMove>::iterator it = first;
+
+    for (; hdwp && it != last; ++it)
+      hdwp = DeferWindowPos(
+          hdwp, it->hwnd, NULL, it->rect.x, it->rect.y, it->rect.width, it->rect.height, it->flags);
+
+    if (hdwp && EndDeferWindowPos(hdwp)) {
+      ++transactions;
+    }
+    else {
+      // A failed DeferWindowPos discards the whole transaction (e.g. a window of an
+      // elevated process): fall back to individual moves for this monitor
+      for (it = first; it != last; ++it) {
+        SetWindowPos(
+            it->hwnd, NULL, it->rect.x, it->rect.y, it->rect.width, it->rect.height, it->flags);
+        ++transactions;
+      }
+    }
+
+    // Their geometry read earlier in this epoch is stale now
+    for (it = first; it != last; ++it)
+      WindowGeometryCache::GetInstance()->Invalidate(it->hwnd);
+
+    moved += last - first;
+    first = last;
+  }
+
+  m_transactions += transactions;
+
+  DEBUG_LOG_FMT("PlacementBatcher: %d windows moved in %d transactions, %d coalesced so far",
+                int(moved),
+                int(transactions),
+                int(GetCoalescedCount()));
+
+  return moved;
+}
@@ -1,9 +1,66 @@
 #ifndef __FONCTIONSRESIZE__
 #define __FONCTIONSRESIZE__
 
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/event.h>
+#include <wx/gdicmn.h>
+#include <wx/timer.h>
+
+#include <vector>
+
 #include "multimonitor_move.h"
 
 extern bool ResizeWindow(const int hotkey, bool fromKbd = true);
 extern void MoveToScreen(DIRECTION);
 
+// Normal (restored) window rect of a maximized or minimized window, in screen coordinates
+// (GetWindowPlacement gives it relative to the work area of its monitor)
+extern wxRect GetNormalPosition(HWND hwnd);
+// Restore a maximized window directly at 'rect' (window rect, screen coordinates), without
+// showing it first at its former normal position; maximize it again on the monitor of
+// 'rect' if 'maximize'. Not deferrable: call it once the batch transaction is over.
+extern void RestoreAt(HWND hwnd, const wxRect& rect, bool maximize);
+
+// Collects window placements for a short delay, then applies them with one
+// BeginDeferWindowPos / EndDeferWindowPos transaction per monitor instead of one
+// SetWindowPos per window. Placing the same window twice keeps only the last position.
+class PlacementBatcher : public wxEvtHandler {
+private:
+  struct PendingMove {
+    HWND hwnd;
+    wxRect rect;
+    UINT flags;
+    HMONITOR monitor;
+  };
+
+  std::vector<PendingMove> m_pending;
+  wxTimer m_timer;
+  int m_delay;
+  bool m_perMonitor; // one transaction per monitor, or a single one for the whole batch
+
+  size_t m_requested;    // placements received since creation
+  size_t m_transactions; // DeferWindowPos transactions (or single SetWindowPos) issued
+
+  void OnTimer(wxTimerEvent& event);
+
+public:
+  PlacementBatcher(int delay = 100, bool per_monitor = true);
+  ~PlacementBatcher();
+
+  // Queue a move; rect is the final window rect (already frame-compensated).
+  // The batch is flushed 'delay' ms after its first placement.
+  void Add(HWND hwnd, const wxRect& rect, UINT flags = SWP_NOZORDER | SWP_NOACTIVATE);
+
+  // Apply the pending placements now, return the number of windows moved
+  size_t Flush();
+  void Cancel();
+
+  // Number of placements that did not need a SetWindowPos call of their own
+  size_t GetCoalescedCount() const { return m_requested - m_transactions; }
+};
+
 #endif //__FONCTIONSRESIZE__
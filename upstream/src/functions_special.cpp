@@ -5,45 +5,157 @@
 
 #include <psapi.h>
 
+#include "animator.h"
 #include "auto_placement.h"
 #include "dialog_fusion.h"
+#include "functions_resize.h"
 #include "list_windows.h"
 #include "minimize_restore.h"
+#include "multimonitor_move.h"
 #include "settingsmanager.h"
+#include "tiling.h"
+#include "window_geometry.h"
 
 #include <wx/app.h>
-#include <wx/frame.h>
-#include <wx/stopwatch.h>
 
 using namespace std;
 
-void StoreOrSetMousePosition(bool storeOnly, HWND wnd)
+namespace {
+  // Length of the always-on-top feedback (ms)
+  const int ANIMATION_DURATION = 120;
+
+  // Share of the work area given to the active window in the master-stack layout (%)
+  const int MASTER_PERCENT = 60;
+
+  // Fusion merges up to this many of the last active windows
+  const size_t FUSION_MAX_WINDOWS = 6;
+}
+
+MouseAnchor StoreMousePosition(HWND wnd)
 {
-  static int mouseX, mouseY, wndW, wndH;
+  MouseAnchor anchor;
   POINT pt;
   GetCursorPos(&pt);
   RECT rc;
   GetWindowRect(wnd, &rc);
-  if (storeOnly) {
-    mouseX = pt.x - rc.left;
-    mouseY = pt.y - rc.top;
-    wndW = rc.right - rc.left;
-    wndH = rc.bottom - rc.top;
+  anchor.x = pt.x - rc.left;
+  anchor.y = pt.y - rc.top;
+  anchor.width = rc.right - rc.left;
+  anchor.height = rc.bottom - rc.top;
+  return anchor;
+}
+
+void RestoreMousePosition(HWND wnd, const MouseAnchor& anchor)
+{
+  if (anchor.width <= 0 || anchor.height <= 0)
     return;
-  }
-  bool bOut = (mouseX < 0) | (mouseY < 0) | (mouseX > wndW) | (mouseY > wndH);
+
+  RECT rc;
+  GetWindowRect(wnd, &rc);
+  bool bOut = (anchor.x < 0) | (anchor.y < 0) | (anchor.x > anchor.width) |
+              (anchor.y > anchor.height);
   if ((bOut) && (SettingsManager::Get().getMouseFollowOnlyWhenIn()))
     return;
-  float rx = float(mouseX) / wndW;
-  float ry = float(mouseY) / wndH;
+  float rx = float(anchor.x) / anchor.width;
+  float ry = float(anchor.y) / anchor.height;
   int newX = rc.left + (int)((rc.right - rc.left) * rx);
   int newY = rc.top + (int)((rc.bottom - rc.top) * ry);
   SetCursorPos(newX, newY);
 }
 
+void StoreOrSetMousePosition(bool storeOnly, HWND wnd)
+{
+  static MouseAnchor anchor = {0, 0, 0, 0};
+
+  if (storeOnly)
+    anchor = StoreMousePosition(wnd);
+  else
+    RestoreMousePosition(wnd, anchor);
+}
+
+// Tile the windows of the current monitor (the one of the active window, or of the mouse
+// pointer) over its work area, all of them moved in a single DeferWindowPos transaction
 void Mosaique()
 {
-  PostMessage(FindWindow(_T ("Shell_TrayWnd"), NULL), WM_COMMAND, 405, 0);
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+  WindowGeometryCache* p_geometry = WindowGeometryCache::GetInstance();
+  HWND foreground = GetForegroundWindow();
+  int monitor = -1;
+
+  if (ListWindows::IsAppWindow(foreground))
+    monitor = p_topology->GetIndexFromWindow(foreground);
+
+  if (monitor == -1) {
+    POINT pt;
+    GetCursorPos(&pt);
+    monitor = p_topology->GetIndexFromRect(wxRect(pt.x, pt.y, 1, 1));
+  }
+
+  if (monitor == -1)
+    return;
+
+  p_geometry->NextEpoch();
+
+  // Z order: the active window comes first and is the master of the master-stack layout
+  vector<HWND> all_windows;
+  vector<HWND> windows;
+  ListWindows::ListAppWindows(all_windows);
+
+  for (size_t i = 0; i < all_windows.size(); ++i) {
+    if (p_topology->GetIndexFromWindow(all_windows[i]) == monitor)
+      windows.push_back(all_windows[i]);
+  }
+
+  vector<WindowGeometry> geometry;
+  p_geometry->Query(windows, geometry);
+
+  // Fixed size windows keep their place. Maximized ones are tiled from their normal state,
+  // left as they are until the transaction, then restored straight into their tile.
+  vector<double> weights;
+  vector<bool> maximized;
+  size_t count = 0;
+  for (size_t i = 0; i < windows.size(); ++i) {
+    if (!geometry[i].valid || !geometry[i].IsResizable())
+      continue;
+
+    wxRect size = geometry[i].IsMaximized() ? GetNormalPosition(windows[i]) : geometry[i].visible;
+    weights.push_back(double(size.width) * size.height);
+    maximized.push_back(geometry[i].IsMaximized());
+
+    geometry[count] = geometry[i];
+    windows[count++] = windows[i];
+  }
+  windows.resize(count);
+  geometry.resize(count);
+
+  if (windows.empty())
+    return;
+
+  const wxRect& work = p_topology->GetMonitor(monitor).work;
+  ScreenRect area = {work.x, work.y, work.width, work.height};
+  TilingOptions options = {TILING_ALGORITHM(SettingsManager::Get().getTilingAlgorithm()),
+                           MASTER_PERCENT,
+                           SettingsManager::Get().getTilingGap()};
+  vector<ScreenRect> tiles;
+  ComputeTiling(area, weights, options, tiles);
+
+  PlacementBatcher batcher(100, false);
+  for (size_t i = 0; i < windows.size(); ++i) {
+    wxRect tile(tiles[i].x, tiles[i].y, tiles[i].width, tiles[i].height);
+    if (!maximized[i])
+      batcher.Add(windows[i], geometry[i].WindowRectFor(tile));
+  }
+  batcher.Flush();
+
+  // Un-maximizing is not deferrable: one placement each, after the others are in place
+  for (size_t i = 0; i < windows.size(); ++i) {
+    if (!maximized[i] || !IsWindow(windows[i]))
+      continue;
+
+    wxRect tile(tiles[i].x, tiles[i].y, tiles[i].width, tiles[i].height);
+    RestoreAt(windows[i], geometry[i].WindowRectFor(tile), false);
+    p_geometry->Invalidate(windows[i]);
+  }
 }
 
 // Close all windows
@@ -72,8 +184,8 @@ void AutoPlace()
   DWORD process_id;
   HANDLE process_handle = NULL;
 
-  AutoPlacementManager m_auto_placement;
-  WindowInfos m_structinfo;
+  AutoPlacementManager* p_auto_placement = AutoPlacementManager::GetInstance();
+  const WindowInfos* p_structinfo;
 
   wxChar name[50] = {0};
 
@@ -111,22 +223,21 @@ void AutoPlace()
 
   str_tmp = process_name + wxString(_T ("::")) + name;
 
-  m_auto_placement.LoadData();
+  // Single hashed lookup; the file is only re-parsed if it changed on disk
+  p_structinfo = p_auto_placement->Find(str_tmp);
 
-  if (m_auto_placement.Exist(wxString(str_tmp.c_str()))) {
-    m_structinfo = m_auto_placement.GetWindowInfos(str_tmp);
-
-    SetWindowLong(m_hwnd, GWL_STYLE, m_structinfo.m_wndStyle);
+  if (p_structinfo) {
+    SetWindowLong(m_hwnd, GWL_STYLE, p_structinfo->m_wndStyle);
     bool bMoveMouse = SettingsManager::Get().getMouseFollowWindow();
     if (bMoveMouse)
       StoreOrSetMousePosition(true, m_hwnd);
     SetWindowPos(m_hwnd,
                  HWND_TOP,
-                 m_structinfo.m_rectxy.x,
-                 m_structinfo.m_rectxy.y,
-                 m_structinfo.m_rectxy.width,
-                 m_structinfo.m_rectxy.height,
-                 m_structinfo.m_flagResize ? SWP_SHOWWINDOW : SWP_NOSIZE);
+                 p_structinfo->m_rectxy.x,
+                 p_structinfo->m_rectxy.y,
+                 p_structinfo->m_rectxy.width,
+                 p_structinfo->m_rectxy.height,
+                 p_structinfo->m_flagResize ? SWP_SHOWWINDOW : SWP_NOSIZE);
     if (bMoveMouse)
       StoreOrSetMousePosition(false, m_hwnd);
   }
@@ -138,8 +249,8 @@ void AutoPlace()
                    message,
                    _("WinSplit message"),
                    MB_SETFOREGROUND | MB_ICONEXCLAMATION | MB_YESNO) == IDYES) {
-      m_auto_placement.AddWindow(m_hwnd, str_tmp);
-      m_auto_placement.SaveData();
+      p_auto_placement->AddWindow(m_hwnd, str_tmp);
+      p_auto_placement->SaveData();
     }
   }
 }
@@ -147,50 +258,31 @@ void AutoPlace()
 // Merge windows
 bool CALLBACK EnumWindowsMerge(HWND hwnd, LPARAM lParam)
 {
-  HWND* p_app_fusion = (HWND*)lParam;
+  vector<HWND>* p_app_fusion = (vector<HWND>*)lParam;
 
-  if (ListWindows::ValidateWindow(hwnd, false)) {
-    if (p_app_fusion[0] == 0) {
-      p_app_fusion[0] = hwnd;
-      return true;
-    }
-    else {
-      p_app_fusion[1] = hwnd;
-      return false;
-    }
-  }
+  if (ListWindows::ValidateWindow(hwnd, false))
+    p_app_fusion->push_back(hwnd);
 
-  return true;
+  return p_app_fusion->size() < FUSION_MAX_WINDOWS;
 }
 
 void fusion_fenetres()
 {
-  HWND app_fusion[2];
-  RECT rcWnd[2];
+  vector<HWND> app_fusion;
 
-  app_fusion[0] = app_fusion[1] = 0;
+  EnumWindows((WNDENUMPROC)EnumWindowsMerge, (LPARAM)&app_fusion);
 
-  EnumWindows((WNDENUMPROC)EnumWindowsMerge, (LPARAM)app_fusion);
-
-  if (!(ListWindows::ValidateWindow(app_fusion[0], false) &&
-        ListWindows::ValidateWindow(app_fusion[1], false)))
+  if (app_fusion.size() < 2)
     return;
-  for (int i = 0; i < 2; i++)
-    GetWindowRect(app_fusion[i], &rcWnd[i]);
 
   FusionDialog m_fusion_frame;
-  m_fusion_frame.SetTabHwnd(app_fusion);
+  m_fusion_frame.SetWindows(app_fusion);
   m_fusion_frame.Show();
   m_fusion_frame.Raise();
-  if (m_fusion_frame.ShowModal() == wxID_CANCEL) {
-    for (int i = 0; i < 2; i++)
-      MoveWindow(app_fusion[i],
-                 rcWnd[i].left,
-                 rcWnd[i].top,
-                 rcWnd[i].right - rcWnd[i].left,
-                 rcWnd[i].bottom - rcWnd[i].top,
-                 true);
-  }
+  if (m_fusion_frame.ShowModal() == wxID_CANCEL)
+    m_fusion_frame.RestoreWindows();
+  else
+    m_fusion_frame.FlushLayout();
 }
 
 // Minimize windows
@@ -301,56 +393,6 @@ void MinimizeRestore::MaximizeVertically()
                SWP_NOZORDER);
 }
 
-void ShowAnimation(RECT& rcWnd, bool growing)
-{
-  const int STEPS = 10;
-  const int DELAY = 10;
-  int x0, y0, x1, y1, x, y, w0, h0, w1, h1, w, h;
-  if (growing) {
-    x0 = ((rcWnd.left + rcWnd.right) / 2) - 1;
-    y0 = ((rcWnd.top + rcWnd.bottom) / 2) - 1;
-    w0 = 2;
-    h0 = 2;
-    x1 = rcWnd.left;
-    y1 = rcWnd.top;
-    w1 = rcWnd.right - rcWnd.left;
-    h1 = rcWnd.bottom - rcWnd.top;
-  }
-  else {
-    x0 = rcWnd.left;
-    y0 = rcWnd.top;
-    w0 = rcWnd.right - rcWnd.left;
-    h0 = rcWnd.bottom - rcWnd.top;
-    x1 = ((rcWnd.left + rcWnd.right) / 2) - 1;
-    y1 = ((rcWnd.top + rcWnd.bottom) / 2) - 1;
-    w1 = 2;
-    h1 = 2;
-  }
-  wxFrame frm(
-      NULL, -1, _T (""), wxPoint(x0, y0), wxSize(w0, h0), wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP);
-  frm.SetTransparent(50);
-  frm.SetBackgroundColour(*wxCYAN);
-  frm.Show();
-  HWND hFrm = (HWND)frm.GetHandle();
-  wxStopWatch sw;
-
-  for (int i = 0; i < STEPS; i++) {
-    wxTheApp->Yield();
-    sw.Start();
-    while (sw.Time() < DELAY) {
-    }
-    x = x0 + i * (x1 - x0) / STEPS;
-    y = y0 + i * (y1 - y0) / STEPS;
-    w = w0 + i * (w1 - w0) / STEPS;
-    h = h0 + i * (h1 - h0) / STEPS;
-    MoveWindow(hFrm, x, y, w, h, false);
-  }
-  sw.Start();
-  while (sw.Time() < DELAY) {
-  }
-  frm.Hide();
-}
-
 void ToggleAlwaysOnTop()
 {
   // Get the active window
@@ -366,5 +408,13 @@ void ToggleAlwaysOnTop()
   RECT rcWnd;
   if (!GetWindowRect(hWnd, &rcWnd))
     return;
-  ShowAnimation(rcWnd, !bState);
+
+  // Feedback played by the animator thread: the hotkey returns at once
+  wxRect window(rcWnd.left, rcWnd.top, rcWnd.right - rcWnd.left, rcWnd.bottom - rcWnd.top);
+  wxRect centre(window.x + window.width / 2 - 1, window.y + window.height / 2 - 1, 2, 2);
+
+  if (bState)
+    Animator::GetInstance()->Start(window, centre, ANIMATION_DURATION, EASE_IN_OUT_CUBIC);
+  else
+    Animator::GetInstance()->Start(centre, window, ANIMATION_DURATION, EASE_OUT_CUBIC);
 }
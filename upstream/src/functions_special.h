@@ -6,6 +6,18 @@ extern void AutoPlace();
 extern void fusion_fenetres();
 extern void Mosaique();
 extern void StoreOrSetMousePosition(bool storeOnly, HWND wnd);
+
+// Pointer position relative to a window, for the pointer to follow the window once moved.
+// Kept by the caller: a deferred move (snap transition) restores its own anchor.
+struct MouseAnchor {
+  int x; // from the top left corner of the window rect
+  int y;
+  int width; // of the window rect when stored
+  int height;
+};
+
+extern MouseAnchor StoreMousePosition(HWND wnd);
+extern void RestoreMousePosition(HWND wnd, const MouseAnchor& anchor);
 extern void ToggleAlwaysOnTop();
 
 #endif // __FONCTIONS_SPECIALES_H__
@@ -1,10 +1,14 @@
 #include "hotkeys_manager.h"
+#include "config_store.h"
 #include "dialog_activewndtools.h"
+#include "dwm_utils.h"
 #include "functions_resize.h"
 #include "functions_special.h"
+#include "layout_snapshots.h"
 #include "multimonitor_move.h"
 #include "tray_icon.h"
 #include "virtual_key_manager.h"
+#include "window_geometry.h"
 
 #include <stdexcept>
 #include <wx/xml/xml.h>
@@ -30,9 +34,11 @@ const wxString xml_str[] = {_T ("AutoPlacement"),
                             _T ("AlwaysOnTop"),
                             _T ("MaximizeHorizontally"),
                             _T ("MaximizeVertically"),
-                            _T ("ToggleVirtualNumpad")};
+                            _T ("ToggleVirtualNumpad"),
+                            _T ("WindowToUpperScreen"),
+                            _T ("WindowToLowerScreen")};
 
-#define NUM_HOTKEYS 22
+#define NUM_HOTKEYS 24
 
 HotkeysManager::HotkeysManager(TrayIcon* tray)
     : wxFrame(NULL, -1, wxEmptyString)
@@ -98,6 +104,10 @@ wxString HotkeysManager::Start()
 
   str_in[21] = _("Toggle Virtual Numpad");
 
+  str_in[22] = _("Move to Upper screen");
+
+  str_in[23] = _("Move to Lower screen");
+
   for (unsigned int i = 0; i < vec_hotkey.size(); ++i) {
     vec_hotkey[i].session = vec_hotkey[i].active;
     if (vec_hotkey[i].session) {
@@ -157,6 +167,8 @@ void HotkeysManager::SetDefaultData()
   vec_hotkey[19].virtualKey = 0x48; // Alt + Ctrl + H = Maximize Horizontally.
   vec_hotkey[20].virtualKey = 0x56; // Alt + Ctrl + V = Maximize Vertically.
   vec_hotkey[21].virtualKey = 0x4E; // Alt + Ctrl + N = Toggle Virtual Numpad
+  vec_hotkey[22].virtualKey = 0x26; // Alt + Ctrl + Up = Window to Upper Screen
+  vec_hotkey[23].virtualKey = 0x28; // Alt + Ctrl + Down = Window to Lower Screen
 }
 
 void HotkeysManager::SetVecHotkey(const std::vector<HotkeyStruct>& vec)
@@ -184,30 +196,20 @@ int HotkeysManager::GetTaskIndex(wxString name)
 bool HotkeysManager::LoadData()
 {
   int i;
-  long vk;
-  wxString path;
-
-  wxXmlDocument doc;
+  const wxXmlNode* section;
   wxXmlNode* child;
-  wxXmlAttribute* properties;
-  wxString value;
-
   VirtualModifierManager mod_manager;
 
-  path = m_options.GetDataDirectory() + _T ("hotkeys.xml");
-
-  if (!wxFileExists(path)) {
-    SaveData();
-  }
+  section = ConfigStore::GetInstance()->GetSection(CONFIG_HOTKEYS);
 
-  if (!doc.Load(path))
-    return false;
+  // Never saved: keep the default hotkeys and save them
+  if (!section)
+    return SaveData();
 
-  wxXmlNode* root = doc.GetRoot();
-  if (!root)
-    return false;
+  // Built aside then swapped in: a reload never leaves a half-filled table
+  std::vector<HotkeyStruct> hotkeys(vec_hotkey);
 
-  child = root->GetChildren();
+  child = section->GetChildren();
 
   while (child) {
     try {
@@ -217,51 +219,31 @@ bool HotkeysManager::LoadData()
       continue;
     }
 
-    properties = child->GetAttributes();
-    if (!properties) { child = child->GetNext(); continue; }
-    value = properties->GetValue();
-    vec_hotkey[i].modifier1 = mod_manager.GetValueFromString(value);
-
-    properties = properties->GetNext();
-    if (!properties) { child = child->GetNext(); continue; }
-    value = properties->GetValue();
-    vec_hotkey[i].modifier2 = mod_manager.GetValueFromString(value);
-
-    properties = properties->GetNext();
-    if (!properties) { child = child->GetNext(); continue; }
-    value = properties->GetValue();
-    value.ToLong(&vk);
-    vec_hotkey[i].virtualKey = (unsigned int)vk;
-
-    properties = properties->GetNext();
-    if (!properties) { child = child->GetNext(); continue; }
-    value = properties->GetValue();
-    vec_hotkey[i].active = value.Cmp(_T ("True")) == 0;
+    // Attributes by name, a missing one keeps the current value
+    wxString value;
+    if (child->GetAttribute(_T ("Modifier1"), &value))
+      hotkeys[i].modifier1 = mod_manager.GetValueFromString(value);
+    if (child->GetAttribute(_T ("Modifier2"), &value))
+      hotkeys[i].modifier2 = mod_manager.GetValueFromString(value);
+    hotkeys[i].virtualKey =
+        (unsigned int)ConfigStore::ReadLong(child, _T ("VirtualHotkey"), hotkeys[i].virtualKey);
+    hotkeys[i].active = ConfigStore::ReadBool(child, _T ("Activate"), hotkeys[i].active);
 
     child = child->GetNext();
   }
 
-  child = doc.DetachRoot();
-  delete child;
-
+  vec_hotkey.swap(hotkeys);
   return true;
 }
 
 bool HotkeysManager::SaveData()
 {
-  wxString path;
-
-  wxXmlDocument doc;
   wxXmlNode* node;
   wxXmlNode* root;
   wxXmlAttribute* properties;
-  wxString value;
   VirtualModifierManager mod_manager;
 
-  path = m_options.GetDataDirectory() + _T ("hotkeys.xml");
-
   root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WinSplit_HotKeys"));
-  doc.SetRoot(root);
 
   for (unsigned int i = 0; i < vec_hotkey.size(); ++i) {
     node = new wxXmlNode(root, wxXML_ELEMENT_NODE, xml_str[i]);
@@ -278,17 +260,35 @@ bool HotkeysManager::SaveData()
         new wxXmlAttribute(_T ("Activate"), vec_hotkey[i].active ? _T ("True") : _T ("False")));
   }
 
-  doc.Save(path.c_str());
-
-  root = doc.DetachRoot();
-  delete root;
+  ConfigStore::GetInstance()->SetSection(CONFIG_HOTKEYS, root);
 
   return true;
 }
 
 WXLRESULT HotkeysManager::MSWWindowProc(WXUINT nMsg, WXWPARAM wParam, WXLPARAM lParam)
 {
+  // Monitors added/removed/moved, resolution, scaling or taskbar changed
+  if (nMsg == WM_DISPLAYCHANGE || nMsg == WM_SETTINGCHANGE) {
+    m_options.InvalidateSystemSettings();
+    MonitorTopology::GetInstance()->Invalidate();
+    DwmUtils::InvalidateFrameCache();
+    WindowGeometryCache::GetInstance()->NextEpoch();
+  }
+
+  // Frame borders depend on the theme and on DWM composition
+  if (nMsg == WM_THEMECHANGED || nMsg == WM_DWMCOMPOSITIONCHANGED) {
+    DwmUtils::InvalidateFrameCache();
+    WindowGeometryCache::GetInstance()->NextEpoch();
+  }
+
+  // Dock / undock: put the windows back where they were in this configuration
+  if (nMsg == WM_DISPLAYCHANGE)
+    LayoutSnapshots::GetInstance()->OnDisplayChange();
+
   if (nMsg == WM_HOTKEY) {
+    // Each hotkey press is a new event epoch for the window geometry
+    WindowGeometryCache::GetInstance()->NextEpoch();
+
     switch ((int)wParam) {
       case HK_0:
         AutoPlace();
@@ -335,6 +335,12 @@ WXLRESULT HotkeysManager::MSWWindowProc(WXUINT nMsg, WXWPARAM wParam, WXLPARAM l
       case HK_RIGHT:
         MoveToScreen(RIGHT_SCREEN);
         break;
+      case HK_UP:
+        MoveToScreen(UP_SCREEN);
+        break;
+      case HK_DOWN:
+        MoveToScreen(DOWN_SCREEN);
+        break;
       case HK_MINIMIZE:
         m_minimizeRestore.MiniMizeWindow();
         break;
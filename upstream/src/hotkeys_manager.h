@@ -36,7 +36,9 @@ enum HK_ID {
   HK_ALWAYSONTOP,
   HK_HMAXIMIZE,
   HK_VMAXIMIZE,
-  HK_TOGGLEVNUMPAD
+  HK_TOGGLEVNUMPAD,
+  HK_UP,
+  HK_DOWN
 };
 
 struct HotkeyStruct {
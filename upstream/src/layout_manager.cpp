@@ -1,5 +1,6 @@
 #include <Windows.h>
 
+#include "config_store.h"
 #include "dwm_utils.h"
 #include "layout_manager.h"
 
@@ -33,7 +34,6 @@ void LayoutManager::DeleteInstance()
 
 void LayoutManager::SaveData()
 {
-  wxXmlDocument doc;
   wxXmlNode* elm = NULL;
   wxXmlNode* sub_elm = NULL;
   wxXmlNode* root = NULL;
@@ -44,8 +44,6 @@ void LayoutManager::SaveData()
 
   root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("LayoutManager"));
 
-  doc.SetRoot(root);
-
   for (unsigned int i = 0; i < tab_seq.size(); ++i) {
     if (i == 0) {
       elm = new wxXmlNode(root, wxXML_ELEMENT_NODE, wxString::Format(_T ("Sequence_%d"), i + 1));
@@ -90,70 +88,50 @@ void LayoutManager::SaveData()
     }
   }
 
-  doc.Save(m_options.GetDataDirectory() + _T ("layout.xml"));
-  root = doc.DetachRoot();
-
-  delete root;
+  ConfigStore::GetInstance()->SetSection(CONFIG_LAYOUTS, root);
 }
 
 void LayoutManager::LoadData()
 {
-  wxXmlDocument doc;
+  const wxXmlNode* section = ConfigStore::GetInstance()->GetSection(CONFIG_LAYOUTS);
   wxXmlNode* elm;
   wxXmlNode* sub_elmt;
-  wxXmlAttribute* property;
-  wxString value;
-  double val_tmp;
-  long nb_combo;
+  long sequence;
+  RatioRect ratio;
 
-  if (!wxFileExists(m_options.GetDataDirectory() + _T ("layout.xml"))) {
+  if (!section) {
     SetDefault();
     SaveData();
 
     return;
   }
 
-  doc.Load(m_options.GetDataDirectory() + _T ("layout.xml"));
-
-  elm = doc.GetRoot()->GetChildren();
-
-  for (unsigned int i = 0; i < tab_seq.size(); ++i) {
-    tab_seq[i].clear();
+  // Built aside then swapped in: a reload never leaves a half-filled table
+  vector<vector<RatioRect>> table(tab_seq.size());
 
-    // Sequence
-    property = elm->GetAttributes();
-    value = property->GetValue();
-    value.ToLong(&nb_combo);
-    tab_seq[i].resize(nb_combo);
-
-    // combo
-    sub_elmt = elm->GetChildren();
-
-    for (int j = 0; j < nb_combo; ++j) {
-      property = sub_elmt->GetAttributes();
-      value = property->GetValue();
-      value.ToDouble(&tab_seq[i][j].x);
-
-      property = property->GetNext();
-      value = property->GetValue();
-      value.ToDouble(&tab_seq[i][j].y);
+  // Sequences and combos by name: a missing sequence stays empty, an unknown element is
+  // skipped, and the combos are appended in a single pass
+  for (elm = section->GetChildren(); elm; elm = elm->GetNext()) {
+    if (!elm->GetName().StartsWith(_T ("Sequence_")) ||
+        !elm->GetName().Mid(9).ToLong(&sequence) || sequence < 1 ||
+        sequence > long(table.size()))
+      continue;
 
-      property = property->GetNext();
-      value = property->GetValue();
-      value.ToDouble(&tab_seq[i][j].width);
+    vector<RatioRect>& combos = table[sequence - 1];
 
-      property = property->GetNext();
-      value = property->GetValue();
-      value.ToDouble(&tab_seq[i][j].height);
+    for (sub_elmt = elm->GetChildren(); sub_elmt; sub_elmt = sub_elmt->GetNext()) {
+      if (sub_elmt->GetType() != wxXML_ELEMENT_NODE)
+        continue;
 
-      sub_elmt = sub_elmt->GetNext();
+      ratio.x = ConfigStore::ReadDouble(sub_elmt, _T ("x"), 0.);
+      ratio.y = ConfigStore::ReadDouble(sub_elmt, _T ("y"), 0.);
+      ratio.width = ConfigStore::ReadDouble(sub_elmt, _T ("width"), 0.);
+      ratio.height = ConfigStore::ReadDouble(sub_elmt, _T ("height"), 0.);
+      combos.push_back(ratio);
     }
-    elm = elm->GetNext();
   }
 
-  elm = doc.DetachRoot();
-
-  delete elm;
+  tab_seq.swap(table);
 }
 
 void LayoutManager::CopyTable(vector<vector<RatioRect>>& dest)
@@ -166,6 +144,15 @@ void LayoutManager::SetTable(const vector<vector<RatioRect>>& source)
   tab_seq = source;
 }
 
+bool LayoutManager::GetFirstRatio(int sequence, RatioRect& result)
+{
+  if (sequence < 0 || sequence >= int(tab_seq.size()) || tab_seq[sequence].empty())
+    return false;
+
+  result = tab_seq[sequence].front();
+  return true;
+}
+
 wxRect LayoutManager::GetNext(HWND hwnd, int sequence)
 {
   wxRect result;
@@ -43,6 +43,7 @@ public:
   void CopyTable(std::vector<std::vector<RatioRect>>& destination);
   void SetTable(const std::vector<std::vector<RatioRect>>& source);
 
+  bool GetFirstRatio(int sequence, RatioRect& result);
   wxRect GetNext(HWND hwnd, int sequence);
   bool GetNearestFromCursor(std::vector<wxRect>& result);
 };
@@ -3210,7 +3210,9 @@ unsigned char Ecran_4x3[] = {
     0xfc, 0xff, 0x6f, 0x86, 0x6d, 0xe9, 0xb8, 0xaa, 0x3b, 0x20, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45,
     0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
 };
-#include <wx/image.h>
+#include "layout_screens.h"
+
+#include <wx/dcmemory.h>
 #include <wx/mstream.h>
 
 wxImage wxGetImage_Ecran_16x9()
@@ -3224,3 +3226,47 @@ wxImage wxGetImage_Ecran_4x3()
   wxMemoryInputStream _mem_i_s(Ecran_4x3, 21830);
   return wxImage(_mem_i_s, wxBITMAP_TYPE_ANY, -1);
 }
+
+LayoutScreens* LayoutScreens::p_instance = NULL;
+
+LayoutScreens* LayoutScreens::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new LayoutScreens();
+
+  return p_instance;
+}
+
+void LayoutScreens::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+const wxImage& LayoutScreens::GetImage(SCREEN_FORMAT format)
+{
+  wxImage& image = m_images[format];
+  if (!image.IsOk())
+    image = format == SCREEN_16x9 ? wxGetImage_Ecran_16x9() : wxGetImage_Ecran_4x3();
+
+  return image;
+}
+
+const wxBitmap& LayoutScreens::GetBitmap(SCREEN_FORMAT format, const wxColour& background)
+{
+  wxBitmap& bmp = m_bitmaps[format];
+  if (bmp.IsOk() && m_backgrounds[format] == background)
+    return bmp;
+
+  const wxImage& img = GetImage(format);
+  bmp = wxBitmap(img.GetWidth(), img.GetHeight());
+  wxMemoryDC mdc(bmp);
+  mdc.SetPen(wxPen(background));
+  mdc.SetBrush(wxBrush(background));
+  mdc.DrawRectangle(mdc.GetSize());
+  mdc.DrawBitmap(wxBitmap(img), 0, 0, true);
+  mdc.SelectObject(wxNullBitmap);
+
+  m_backgrounds[format] = background;
+  return bmp;
+}
@@ -1,7 +1,40 @@
 #ifndef ECRANS_PNG_H_INCLUDED
 #define ECRANS_PNG_H_INCLUDED
 
+#include <wx/bitmap.h>
+#include <wx/colour.h>
+#include <wx/image.h>
+
+// Decode the embedded PNG at every call: use LayoutScreens
 wxImage wxGetImage_Ecran_16x9();
 wxImage wxGetImage_Ecran_4x3();
 
+enum SCREEN_FORMAT { SCREEN_16x9, SCREEN_4x3 };
+#define NB_SCREEN_FORMATS 2
+
+// The screens drawn by the layout preview, decoded on first use and kept for the whole
+// process: opening the layout dialog again does no PNG inflate. The bitmap over the dialog
+// background is composed again only when the background colour changes (theme change).
+// UI thread only.
+class LayoutScreens // Singleton class
+{
+private:
+  static LayoutScreens* p_instance;
+
+  wxImage m_images[NB_SCREEN_FORMATS];
+  wxBitmap m_bitmaps[NB_SCREEN_FORMATS];
+  wxColour m_backgrounds[NB_SCREEN_FORMATS]; // of m_bitmaps
+
+  LayoutScreens() {}
+  ~LayoutScreens() {}
+
+public:
+  static LayoutScreens* GetInstance();
+  static void DeleteInstance();
+
+  const wxImage& GetImage(SCREEN_FORMAT format);
+  // The screen over an opaque 'background'
+  const wxBitmap& GetBitmap(SCREEN_FORMAT format, const wxColour& background);
+};
+
 #endif // ECRANS_PNG_H_INCLUDED
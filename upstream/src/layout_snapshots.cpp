@@ -0,0 +1,351 @@
+#include "layout_snapshots.h"
+
+#include "dwm_utils.h"
+#include "functions_resize.h"
+#include "list_windows.h"
+#include "multimonitor_move.h"
+#include "window_geometry.h"
+
+#include <vector>
+
+using namespace std;
+
+LayoutSnapshots* LayoutSnapshots::p_instance = NULL;
+
+namespace {
+  // Configurations kept in memory, the least recently used one is dropped first
+  const size_t MAX_CONFIGURATIONS = 8;
+
+  // Time left to Windows to finish moving windows after a display change (ms)
+  const int SETTLE_DELAY = 1500;
+  // Moved windows are read once they have not moved for this long (ms)
+  const int CAPTURE_DELAY = 250;
+
+  enum {
+    ID_SETTLE_TIMER = 1,
+    ID_CAPTURE_TIMER
+  };
+}
+
+LayoutSnapshots::LayoutSnapshots()
+    : m_configs()
+    , m_current(0)
+    , m_useCounter(0)
+    , m_hookMove(NULL)
+    , m_hookDestroy(NULL)
+    , m_suspended(false)
+    , m_timer()
+    , m_moved()
+    , m_captureTimer()
+{
+  m_timer.SetOwner(this, ID_SETTLE_TIMER);
+  m_captureTimer.SetOwner(this, ID_CAPTURE_TIMER);
+  Connect(ID_SETTLE_TIMER, wxEVT_TIMER, wxTimerEventHandler(LayoutSnapshots::OnTimer), NULL,
+          this);
+  Connect(ID_CAPTURE_TIMER, wxEVT_TIMER, wxTimerEventHandler(LayoutSnapshots::OnCaptureTimer),
+          NULL, this);
+}
+
+LayoutSnapshots::~LayoutSnapshots()
+{
+  Stop();
+}
+
+LayoutSnapshots* LayoutSnapshots::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new LayoutSnapshots();
+
+  return p_instance;
+}
+
+void LayoutSnapshots::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+void LayoutSnapshots::Start()
+{
+  if (m_hookMove)
+    return;
+
+  m_current = MonitorTopology::GetInstance()->GetFingerprint();
+  m_suspended = false;
+
+  m_hookMove = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE,
+                               EVENT_OBJECT_LOCATIONCHANGE,
+                               NULL,
+                               WinEventProc,
+                               0,
+                               0,
+                               WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  m_hookDestroy = SetWinEventHook(EVENT_OBJECT_DESTROY,
+                                  EVENT_OBJECT_DESTROY,
+                                  NULL,
+                                  WinEventProc,
+                                  0,
+                                  0,
+                                  WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+void LayoutSnapshots::Stop()
+{
+  if (m_timer.IsRunning())
+    m_timer.Stop();
+  if (m_captureTimer.IsRunning())
+    m_captureTimer.Stop();
+  m_moved.clear();
+
+  if (m_hookMove) {
+    UnhookWinEvent(m_hookMove);
+    m_hookMove = NULL;
+  }
+
+  if (m_hookDestroy) {
+    UnhookWinEvent(m_hookDestroy);
+    m_hookDestroy = NULL;
+  }
+
+  m_configs.clear();
+}
+
+void CALLBACK LayoutSnapshots::WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                            LONG idObject, LONG idChild, DWORD idThread,
+                                            DWORD time)
+{
+  if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hwnd || !p_instance)
+    return;
+
+  WindowGeometryCache::GetInstance()->Invalidate(hwnd);
+
+  if (event == EVENT_OBJECT_DESTROY) {
+    p_instance->Forget(hwnd);
+  }
+  else if (!p_instance->m_suspended) {
+    // Read when the window settles, the delay restarts on each move
+    p_instance->m_moved.insert(hwnd);
+    p_instance->m_captureTimer.StartOnce(CAPTURE_DELAY);
+  }
+}
+
+LayoutSnapshots::Configuration& LayoutSnapshots::GetConfiguration(unsigned long long fingerprint)
+{
+  unordered_map<unsigned long long, Configuration>::iterator it = m_configs.find(fingerprint);
+
+  if (it == m_configs.end()) {
+    if (m_configs.size() >= MAX_CONFIGURATIONS) {
+      unordered_map<unsigned long long, Configuration>::iterator oldest = m_configs.begin();
+      for (it = m_configs.begin(); it != m_configs.end(); ++it) {
+        if (it->second.lastUsed < oldest->second.lastUsed)
+          oldest = it;
+      }
+      m_configs.erase(oldest);
+    }
+
+    it = m_configs.insert(make_pair(fingerprint, Configuration())).first;
+
+    // Captures happen under the fingerprint of the current topology
+    MonitorTopology* p_topology = MonitorTopology::GetInstance();
+    for (int i = 0; i < p_topology->GetCount(); ++i)
+      it->second.workAreas.push_back(p_topology->GetMonitor(i).work);
+  }
+
+  it->second.lastUsed = ++m_useCounter;
+  return it->second;
+}
+
+void LayoutSnapshots::Capture(HWND hwnd)
+{
+  if (m_suspended || !IsWindowVisible(hwnd) || IsIconic(hwnd) || !ListWindows::IsAppWindow(hwnd))
+    return;
+
+  // A display change suspends the capture (WM_DISPLAYCHANGE): the fingerprint recorded
+  // under is the current one
+  Snapshot& windows = GetConfiguration(m_current).windows;
+  Snapshot::iterator it = windows.find(hwnd);
+
+  if (IsZoomed(hwnd)) {
+    // Keep the normal position recorded before the window was maximized
+    if (it != windows.end()) {
+      it->second.maximized = true;
+      return;
+    }
+
+    WindowSnapshot snapshot = {DwmUtils::GetWindowRectCompensated(hwnd), true};
+    windows.insert(make_pair(hwnd, snapshot));
+    return;
+  }
+
+  WindowSnapshot snapshot = {DwmUtils::GetWindowRectCompensated(hwnd), false};
+  if (it != windows.end())
+    it->second = snapshot;
+  else
+    windows.insert(make_pair(hwnd, snapshot));
+}
+
+void LayoutSnapshots::Forget(HWND hwnd)
+{
+  unordered_map<unsigned long long, Configuration>::iterator it;
+
+  m_moved.erase(hwnd);
+
+  for (it = m_configs.begin(); it != m_configs.end(); ++it)
+    it->second.windows.erase(hwnd);
+}
+
+void LayoutSnapshots::OnDisplayChange()
+{
+  if (!m_hookMove)
+    return;
+
+  MonitorTopology::GetInstance()->Invalidate();
+  m_suspended = true;
+
+  // Moves seen meanwhile may be those of the new configuration
+  m_moved.clear();
+  m_captureTimer.Stop();
+
+  // Restarted on each notification: docking sends several of them
+  m_timer.StartOnce(SETTLE_DELAY);
+}
+
+void LayoutSnapshots::OnTimer(wxTimerEvent& event)
+{
+  MonitorTopology::GetInstance()->Invalidate();
+  unsigned long long fingerprint = MonitorTopology::GetInstance()->GetFingerprint();
+
+  // Same monitors (colour depth, a notification without change): the user's windows stay
+  if (fingerprint != m_current) {
+    m_current = fingerprint;
+    Restore();
+  }
+  m_suspended = false;
+
+  event.Skip(false);
+}
+
+void LayoutSnapshots::OnCaptureTimer(wxTimerEvent& event)
+{
+  unordered_set<HWND> moved;
+  moved.swap(m_moved);
+
+  for (unordered_set<HWND>::iterator it = moved.begin(); it != moved.end(); ++it)
+    Capture(*it);
+
+  event.Skip(false);
+}
+
+size_t LayoutSnapshots::Restore()
+{
+  unordered_map<unsigned long long, Configuration>::iterator conf = m_configs.find(m_current);
+  if (conf == m_configs.end())
+    return 0;
+
+  conf->second.lastUsed = ++m_useCounter;
+  Snapshot& windows = conf->second.windows;
+
+  // Geometry of all the recorded windows in one pass
+  WindowGeometryCache* p_geometry = WindowGeometryCache::GetInstance();
+  vector<HWND> hwnds;
+  vector<WindowGeometry> geometry;
+
+  p_geometry->NextEpoch();
+  hwnds.reserve(windows.size());
+  for (Snapshot::iterator it = windows.begin(); it != windows.end(); ++it)
+    hwnds.push_back(it->first);
+  p_geometry->Query(hwnds, geometry);
+
+  // All targets first, then one DeferWindowPos transaction per monitor
+  PlacementBatcher batcher;
+  vector<HWND> to_maximize;
+  vector<HWND> maximized; // placed after the transaction, without being restored before
+
+  for (size_t i = 0; i < hwnds.size(); ++i) {
+    HWND hwnd = hwnds[i];
+    Snapshot::iterator it = windows.find(hwnd);
+    const WindowSnapshot& snapshot = it->second;
+
+    if (!geometry[i].valid) {
+      windows.erase(it);
+      continue;
+    }
+
+    if (geometry[i].IsMinimized())
+      continue;
+
+    if (geometry[i].IsMaximized()) {
+      RECT target = {snapshot.rect.x,
+                     snapshot.rect.y,
+                     snapshot.rect.x + snapshot.rect.width,
+                     snapshot.rect.y + snapshot.rect.height};
+
+      // Already maximized on the right monitor
+      if (snapshot.maximized &&
+          MonitorFromRect(&target, MONITOR_DEFAULTTONEAREST) ==
+              MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST))
+        continue;
+
+      maximized.push_back(hwnd);
+      continue;
+    }
+    else if (!snapshot.maximized && geometry[i].visible == snapshot.rect) {
+      continue;
+    }
+
+    batcher.Add(hwnd, DwmUtils::AdjustForInvisibleFrame(hwnd, snapshot.rect));
+    if (snapshot.maximized)
+      to_maximize.push_back(hwnd);
+  }
+
+  size_t moved = batcher.Flush();
+
+  // Maximizing is not deferrable: done once the windows are on their monitor
+  for (size_t i = 0; i < to_maximize.size(); ++i)
+    ShowWindow(to_maximize[i], SW_MAXIMIZE);
+
+  // Windows maximized now: their normal position is set, then they are maximized there
+  // again or shown restored
+  for (size_t i = 0; i < maximized.size(); ++i) {
+    const WindowSnapshot& snapshot = windows[maximized[i]];
+    RestoreAt(maximized[i],
+              DwmUtils::AdjustForInvisibleFrame(maximized[i], snapshot.rect),
+              snapshot.maximized);
+    p_geometry->Invalidate(maximized[i]);
+    ++moved;
+  }
+
+  return moved;
+}
+
+bool LayoutSnapshots::GetLastKnownRect(HWND hwnd, wxRect& rect, wxRect& work_area) const
+{
+  unordered_map<unsigned long long, Configuration>::const_iterator it;
+  unsigned int last_used = 0;
+  bool found = false;
+
+  for (it = m_configs.begin(); it != m_configs.end(); ++it) {
+    if (it->first == m_current || it->second.lastUsed < last_used)
+      continue;
+
+    Snapshot::const_iterator window = it->second.windows.find(hwnd);
+    if (window == it->second.windows.end())
+      continue;
+
+    rect = window->second.rect;
+    last_used = it->second.lastUsed;
+    found = true;
+
+    // The work area holding the centre of the window, the first one otherwise
+    const vector<wxRect>& work_areas = it->second.workAreas;
+    work_area = work_areas.empty() ? rect : work_areas[0];
+    for (size_t i = 0; i < work_areas.size(); ++i) {
+      if (work_areas[i].Contains(rect.x + rect.width / 2, rect.y + rect.height / 2)) {
+        work_area = work_areas[i];
+        break;
+      }
+    }
+  }
+
+  return found;
+}
@@ -0,0 +1,84 @@
+#ifndef __LAYOUT_SNAPSHOTS_H__
+#define __LAYOUT_SNAPSHOTS_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/event.h>
+#include <wx/gdicmn.h>
+#include <wx/timer.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Window placements of the session, one snapshot per monitor configuration
+// (MonitorTopology fingerprint). Positions are recorded as windows move
+// (EVENT_OBJECT_LOCATIONCHANGE), never by enumerating all windows: a moving window is only
+// noted, and read once it has stopped for a moment (a drag sends an event per step). When
+// the monitor
+// configuration changes (dock / undock) and the new one was seen before, its windows
+// are put back in a single batched pass.
+class LayoutSnapshots : public wxEvtHandler // Singleton class
+{
+private:
+  struct WindowSnapshot {
+    wxRect rect; // visible bounds (DWM compensated), normal position if maximized
+    bool maximized;
+  };
+
+  typedef std::unordered_map<HWND, WindowSnapshot> Snapshot;
+
+  struct Configuration {
+    Snapshot windows;
+    std::vector<wxRect> workAreas; // of the monitors, in the coordinates of this configuration
+    unsigned int lastUsed;
+  };
+
+  static LayoutSnapshots* p_instance;
+
+  std::unordered_map<unsigned long long, Configuration> m_configs;
+  unsigned long long m_current; // fingerprint the captured moves are recorded under
+  unsigned int m_useCounter;
+
+  HWINEVENTHOOK m_hookMove;
+  HWINEVENTHOOK m_hookDestroy;
+  bool m_suspended; // configuration changing or restore in progress
+  wxTimer m_timer;  // end of a display change
+  std::unordered_set<HWND> m_moved; // windows moved since the last capture
+  wxTimer m_captureTimer;
+
+  LayoutSnapshots();
+  ~LayoutSnapshots();
+
+  static void CALLBACK WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                    LONG idChild, DWORD idThread, DWORD time);
+  void Capture(HWND hwnd);
+  void Forget(HWND hwnd);
+  Configuration& GetConfiguration(unsigned long long fingerprint);
+  void OnTimer(wxTimerEvent& event);
+  void OnCaptureTimer(wxTimerEvent& event);
+
+public:
+  static LayoutSnapshots* GetInstance();
+  static void DeleteInstance();
+
+  void Start();
+  void Stop();
+
+  // Called on WM_DISPLAYCHANGE: capture is suspended until the system has finished
+  // moving windows around, then the snapshot of the new configuration is restored
+  void OnDisplayChange();
+
+  // Put back the windows of the current configuration, return the number of windows moved
+  size_t Restore();
+
+  // Position of the window in the most recently used other configuration, false if unknown.
+  // 'rect' and 'work_area' (of the monitor the window was on) are in the coordinates of that
+  // configuration, which may not be those of the current one.
+  bool GetLastKnownRect(HWND hwnd, wxRect& rect, wxRect& work_area) const;
+};
+
+#endif // __LAYOUT_SNAPSHOTS_H__
@@ -18,6 +18,18 @@ bool ListWindows::ValidateWindow(HWND hwnd, bool accept_tmw)
   return false;
 }
 
+bool ListWindows::IsAppWindow(HWND hwnd)
+{
+  if (!hwnd || GetAncestor(hwnd, GA_ROOT) != hwnd || GetWindow(hwnd, GW_OWNER) != NULL)
+    return false;
+
+  LONG style = GetWindowLong(hwnd, GWL_STYLE);
+  if ((style & WS_CHILD) || !(style & WS_CAPTION))
+    return false;
+
+  return (GetWindowLong(hwnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) == 0;
+}
+
 bool CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam)
 {
   if (ListWindows::ValidateWindow(hwnd, false)) {
@@ -41,3 +53,20 @@ HWND ListWindows::ListWindow()
   EnumWindows((WNDENUMPROC)EnumWindowsProc, (LPARAM)&hwnd_window);
   return hwnd_window;
 }
+
+static bool CALLBACK EnumAppWindowsProc(HWND hwnd, LPARAM lParam)
+{
+  bool accept_tmw = SettingsManager::Get().AcceptTopMostWindows();
+
+  if (ListWindows::ValidateWindow(hwnd, accept_tmw) && !IsIconic(hwnd) &&
+      ListWindows::IsAppWindow(hwnd))
+    ((std::vector<HWND>*)lParam)->push_back(hwnd);
+
+  return true;
+}
+
+void ListWindows::ListAppWindows(std::vector<HWND>& windows)
+{
+  windows.clear();
+  EnumWindows((WNDENUMPROC)EnumAppWindowsProc, (LPARAM)&windows);
+}
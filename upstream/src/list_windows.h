@@ -6,12 +6,19 @@
 #endif
 #include <windows.h>
 
+#include <vector>
+
 class ListWindows {
 private:
 public:
   ListWindows() {}
   static bool ValidateWindow(HWND hwnd, bool accept_tmw = true);
+  // Unowned top-level application window (no child, tool or caption-less window).
+  // Cheap enough to filter WinEvent notifications.
+  static bool IsAppWindow(HWND hwnd);
   static HWND ListWindow();
+  // Application windows that can be placed (not minimized), in Z order
+  static void ListAppWindows(std::vector<HWND>& windows);
 };
 
 #endif // __LISTER_FENETRE_H__
@@ -1,38 +1,34 @@
 #include "lmpreview.h"
 
 #include "layout_screens.h"
+#include "wallpaper_thumbnails.h"
 
+#include <wx/dcmemory.h>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/msw/registry.h>
 
 LMPreview::LMPreview(wxWindow* parent)
     : wxPanel(parent, -1)
+    , p_stScr(NULL)
+    , m_thumbnailRequest(0)
 {
   wxScreenDC scrDC;
 
   wxSize screen_size = scrDC.GetSize();
 
-  wxImage img;
-
+  SCREEN_FORMAT format;
   if (double(screen_size.GetWidth()) / screen_size.GetHeight() > 1.5) {
-    img = wxGetImage_Ecran_16x9();
+    format = SCREEN_16x9;
     m_vp = wxRect(13, 10, 226, 126);
   }
   else {
-    img = wxGetImage_Ecran_4x3();
+    format = SCREEN_4x3;
     m_vp = wxRect(12, 10, 171, 126);
   }
 
-  wxBitmap bmp(img.GetWidth(), img.GetHeight());
-  wxMemoryDC mdc(bmp);
   wxColour col = wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE);
-  mdc.SetPen(wxPen(col));
-  mdc.SetBrush(wxBrush(col));
-  mdc.DrawRectangle(mdc.GetSize());
-  mdc.DrawBitmap(wxBitmap(img), 0, 0, true);
-
-  mdc.SelectObject(wxNullBitmap);
+  wxBitmap bmp = LayoutScreens::GetInstance()->GetBitmap(format, col);
 
   // Load of the wallpaper image (suppress error dialogs for optional registry reads)
   wxString sScrBg;
@@ -53,19 +49,6 @@ LMPreview::LMPreview(wxWindow* parent)
     }
   }
 
-  wxBitmap scrBmp;
-  wxImage bgImg;
-
-  bool bFileExist = wxFileName::FileExists(sScrBg);
-
-  if (bFileExist)
-    bgImg = wxImage(sScrBg, wxBITMAP_TYPE_ANY);
-
-  if (bgImg.IsOk() && bFileExist)
-    scrBmp = wxBitmap(bgImg.Scale(m_vp.width, m_vp.height, wxIMAGE_QUALITY_HIGH));
-  else
-    scrBmp = wxNullBitmap;
-
   wxBoxSizer* szr = new wxBoxSizer(wxVERTICAL);
   p_stBmp = new wxStaticBitmap(this, -1, bmp);
   szr->Add(p_stBmp, 0, wxALL | wxCENTER, 5);
@@ -73,14 +56,28 @@ LMPreview::LMPreview(wxWindow* parent)
   szr->SetSizeHints(this);
 
   wxStaticBitmap* prnt;
-  if (!scrBmp.IsOk()) {
+  if (sScrBg.IsEmpty() || !wxFileName::FileExists(sScrBg)) {
     prnt = p_stBmp;
   }
   else {
-    p_stScr = new wxStaticBitmap(p_stBmp, -1, scrBmp, wxPoint(m_vp.x, m_vp.y));
+    // The colour of the desktop until the thumbnail of the wallpaper is ready
+    wxBitmap placeholder(m_vp.width, m_vp.height);
+    {
+      wxMemoryDC mdc(placeholder);
+      mdc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_DESKTOP)));
+      mdc.Clear();
+    }
+    p_stScr = new wxStaticBitmap(p_stBmp, -1, placeholder, wxPoint(m_vp.x, m_vp.y));
     m_vp.x = 0;
     m_vp.y = 0;
     prnt = p_stScr;
+
+    m_thumbnailRequest = WallpaperThumbnails::GetInstance()->Request(
+        sScrBg, m_vp.GetSize(), [this](const wxBitmap& thumbnail) {
+          m_thumbnailRequest = 0;
+          if (thumbnail.IsOk())
+            p_stScr->SetBitmap(thumbnail);
+        });
   }
 
   p_Wnd = new wxPanel(prnt, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxBORDER_RAISED);
@@ -93,7 +90,9 @@ LMPreview::LMPreview(wxWindow* parent)
 
 LMPreview::~LMPreview()
 {
-  // dtor
+  // Closed before the thumbnail was ready
+  if (m_thumbnailRequest)
+    WallpaperThumbnails::GetInstance()->Cancel(m_thumbnailRequest);
 }
 
 void LMPreview::SetWndPos(double dX, double dY, double dW, double dH)
@@ -14,6 +14,7 @@ private:
   wxStaticBitmap *p_stBmp, *p_stScr;
   wxPanel* p_Wnd;
   wxRect m_vp;
+  int m_thumbnailRequest; // of the wallpaper, 0 once ready
 };
 
 #endif // LMPREVIEW_H_INCLUDED
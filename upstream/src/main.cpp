@@ -22,17 +22,19 @@ namespace {
   }
 }
 
+#include "config_store.h"
+#include "config_writer.h"
 #include "dialog_activewndtools.h"
 #include "dwm_utils.h"
 #include "frame_hook.h"
 #include "main.h"
 #include "settingsmanager.h"
+#include "startup_profiler.h"
 #include "tray_icon.h"
 
 #include <wx/image.h>
 #include <wx/msgdlg.h>
 #include <wx/snglinst.h>
-#include <wx/socket.h>
 #include <wx/stdpaths.h>
 
 using namespace std;
@@ -50,10 +52,16 @@ WinSplitApp::~WinSplitApp() {}
 
 bool WinSplitApp::OnInit()
 {
+  // Tray ready as soon as possible at logon: the numpad, the image handlers and the menu
+  // images wait for their first use
+  StartupProfiler::Start();
+
   // Initialize DPI awareness for proper scaling on Windows 10/11
+  StartupProfiler::Phase("dpi awareness");
   DwmUtils::InitializeDpiAwareness();
 
   // Security: Warn if running with unnecessary elevated privileges
+  StartupProfiler::Phase("elevation check");
   if (IsRunningElevated()) {
     wxMessageBox(_("WinSplit Revolution is running with administrator privileges.\n\n"
                    "This is not required for normal operation and reduces security.\n"
@@ -65,7 +73,8 @@ bool WinSplitApp::OnInit()
   setlocale(LC_NUMERIC, "C");
   SetAppName(_T ("Winsplit Revolution"));
 
-  // Check if another instance is running
+  // Check if another instance is running (reads the settings for the user name)
+  StartupProfiler::Phase("settings");
   if (IsAlreadyRunning()) {
     wxMessageBox(_("Program already running!"), _("WinSplit message"), wxOK | wxICON_INFORMATION);
     return false;
@@ -80,22 +89,34 @@ bool WinSplitApp::OnInit()
   }
 
   // If the settings specify it, delete any temporary files from previous screen shots
+  StartupProfiler::Phase("temp files");
   if ((options.getAutoDeleteTempFiles()) && (options.getAutoDeleteTime() == 0))
     ActiveWndToolsDialog::DeleteTempFiles();
 
-  wxInitAllImageHandlers();
-  wxSocketBase::Initialize();
-
   // Creation of TrayIcon that will manage the launch / management of the program
+  StartupProfiler::Phase("drag'n'go hook");
   p_frameHook = new FrameHook();
 
   p_frameHook->Show();
 
+  StartupProfiler::Phase("tray icon");
   p_tray = new TrayIcon();
 
+  StartupProfiler::Finish();
+
   return true;
 }
 
+void WinSplitApp::InitImageHandlers()
+{
+  // All the formats: the wallpaper and the screenshots can be any of them
+  static bool initialized = false;
+  if (!initialized) {
+    wxInitAllImageHandlers();
+    initialized = true;
+  }
+}
+
 void WinSplitApp::OnQueryEndSession(wxCloseEvent& event)
 {
   // Allow the session to end - we will clean up in OnCloseSession
@@ -111,6 +132,11 @@ void WinSplitApp::OnCloseSession(wxCloseEvent& event)
     p_tray->Cleanup();
   }
 
+  // OnExit() may never run once the session is over: the settings and the writes
+  // still pending reach the disk now
+  SettingsManager::Get().SaveIfModified();
+  ConfigWriter::GetInstance()->Flush();
+
   ExitMainLoop();
 }
 
@@ -130,6 +156,9 @@ int WinSplitApp::OnExit()
     ActiveWndToolsDialog::DeleteTempFiles();
   // Destroy SettingsManager
   SettingsManager::Kill();
+  ConfigStore::DeleteInstance();
+  // Last: writes what the singletons above saved
+  ConfigWriter::DeleteInstance();
   // Destroy wxSingleInstanceChecker
   delete p_checker;
   p_checker = NULL;
@@ -27,6 +27,8 @@ public:
   WinSplitApp();
   ~WinSplitApp();
   void ShowTrayIcon();
+  // Before the first image file is read or written; once is enough
+  void InitImageHandlers();
 
   bool IsAlreadyRunning();
   virtual bool OnInit();
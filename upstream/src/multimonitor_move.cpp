@@ -3,15 +3,24 @@
 #endif
 #include <windows.h>
 
+#include "animator.h"
+#include "dpi_move.h"
 #include "dwm_utils.h"
+#include "functions_resize.h"
 #include "functions_special.h"
+#include "layout_snapshots.h"
+#include "list_windows.h"
 #include "multimonitor_move.h"
 #include "settingsmanager.h"
+#include "window_geometry.h"
 
 #include <wx/msgdlg.h>
 
+#include <algorithm>
 #include <fstream>
 #include <math.h>
+#include <stdlib.h>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -28,40 +37,63 @@ wxRect RectTowXRect(RECT rect)
   return val_tmp;
 }
 
-void MoveToScreen(HWND hwnd, wxRect current_screen, wxRect dest_screen)
+static ScreenRect wxRectToScreenRect(const wxRect& rect)
 {
-  wxRect wnd_dest_wx;
-  wxRect wnd_current_wx;
-
-  double proportion_x;
-  double proportion_y;
-  bool flag_resizable;
-  bool flag_topmost;
-  bool maximized = false;
-  WINDOWPLACEMENT placement;
+  ScreenRect val_tmp = {rect.x, rect.y, rect.width, rect.height};
+  return val_tmp;
+}
 
-  proportion_x = double(dest_screen.GetRight() - dest_screen.GetLeft()) /
-                 (current_screen.GetRight() - current_screen.GetLeft());
-  proportion_y = double(dest_screen.GetBottom() - dest_screen.GetTop()) /
-                 (current_screen.GetBottom() - current_screen.GetTop());
+static ScreenInfo MonitorToScreenInfo(const MonitorNode& monitor)
+{
+  ScreenInfo val_tmp = {wxRectToScreenRect(monitor.work), monitor.dpi};
+  return val_tmp;
+}
 
-  // Use DWM-compensated window rect for accurate positioning on Win10/11
-  wnd_current_wx = DwmUtils::GetWindowRectCompensated(hwnd);
+namespace {
+  // Real window behind the DPI aware move logic of dpi_move.cpp
+  class Win32WindowMove : public WindowMoveBackend {
+  private:
+    HWND m_hwnd;
+    HWND m_insertAfter;
+
+  public:
+    Win32WindowMove(HWND hwnd, HWND insert_after)
+        : m_hwnd(hwnd)
+        , m_insertAfter(insert_after)
+    {
+    }
 
-  wnd_dest_wx = wnd_current_wx;
+    ScreenRect GetRect()
+    {
+      // Use DWM-compensated window rect for accurate positioning on Win10/11
+      return wxRectToScreenRect(DwmUtils::GetWindowRectCompensated(m_hwnd));
+    }
 
-  wnd_dest_wx.x = dest_screen.GetLeft() +
-                  (int)round((wnd_current_wx.x - current_screen.GetLeft()) * proportion_x);
-  wnd_dest_wx.y = dest_screen.GetTop() +
-                  (int)round((wnd_current_wx.y - current_screen.GetTop()) * proportion_y);
+    void SetRect(const ScreenRect& rect, bool resize)
+    {
+      // Adjust for invisible frame borders before positioning
+      wxRect adjusted = DwmUtils::AdjustForInvisibleFrame(
+          m_hwnd, wxRect(rect.x, rect.y, rect.width, rect.height));
+
+      SetWindowPos(m_hwnd,
+                   m_insertAfter,
+                   adjusted.x,
+                   adjusted.y,
+                   adjusted.width,
+                   adjusted.height,
+                   resize ? SWP_SHOWWINDOW : SWP_NOSIZE);
+    }
 
-  wnd_dest_wx.width = int(round(wnd_current_wx.width * proportion_x));
-  wnd_dest_wx.height = int(round(wnd_current_wx.height * proportion_y));
+    bool IsPerMonitorDpiAware() { return DwmUtils::IsPerMonitorDpiAware(m_hwnd); }
+  };
+}
 
-  if (!dest_screen.Contains(wnd_dest_wx)) {
-    wnd_dest_wx.x = dest_screen.x;
-    wnd_dest_wx.y = dest_screen.y;
-  }
+void MoveToScreen(HWND hwnd, const MonitorNode& current_screen, const MonitorNode& dest_screen)
+{
+  bool flag_resizable;
+  bool flag_topmost;
+  bool maximized = false;
+  WINDOWPLACEMENT placement;
 
   flag_resizable = ((GetWindowLong(hwnd, GWL_STYLE) & WS_SIZEBOX) != 0);
   flag_topmost = ((GetWindowLong(hwnd, GWL_EXSTYLE) & WS_EX_TOPMOST) != 0);
@@ -73,155 +105,551 @@ void MoveToScreen(HWND hwnd, wxRect current_screen, wxRect dest_screen)
     maximized = true;
   }
 
-  // Adjust for invisible frame borders before positioning
-  wxRect adjusted = DwmUtils::AdjustForInvisibleFrame(hwnd, wnd_dest_wx);
-
+  // Kept by the transition: another window's move landing meanwhile has its own
   bool bMoveMouse = SettingsManager::Get().getMouseFollowWindow();
+  MouseAnchor anchor = {0, 0, 0, 0};
   if (bMoveMouse)
-    StoreOrSetMousePosition(true, hwnd);
-  SetWindowPos(hwnd,
-               flag_topmost ? HWND_TOPMOST : HWND_TOP,
-               adjusted.x,
-               adjusted.y,
-               adjusted.width,
-               adjusted.height,
-               flag_resizable ? SWP_SHOWWINDOW : SWP_NOSIZE);
-  if (bMoveMouse)
-    StoreOrSetMousePosition(false, hwnd);
+    anchor = StoreMousePosition(hwnd);
+
+  // Scale factors come from the topology cache, not from a query per move
+  ScreenInfo from = MonitorToScreenInfo(current_screen);
+  ScreenInfo to = MonitorToScreenInfo(dest_screen);
+  wxRect visible = DwmUtils::GetWindowRectCompensated(hwnd);
+  ScreenRect target = MapRectToScreen(wxRectToScreenRect(visible), from, to);
+
+  // Played on a thumbnail when enabled: the DPI aware move runs once, at the end
+  Animator::GetInstance()->AnimateSnap(
+      hwnd, visible, wxRect(target.x, target.y, target.width, target.height), [=]() {
+        Win32WindowMove window(hwnd, flag_topmost ? HWND_TOPMOST : HWND_TOP);
+        MoveWindowToScreen(window, from, to, flag_resizable);
+
+        if (bMoveMouse)
+          RestoreMousePosition(hwnd, anchor);
+
+        if (maximized)
+          ShowWindow(hwnd, SW_SHOWMAXIMIZED);
+      });
+}
+
+MonitorTopology* MonitorTopology::p_instance = NULL;
 
-  if (maximized)
-    ShowWindow(hwnd, SW_SHOWMAXIMIZED);
+MonitorTopology::MonitorTopology()
+    : m_monitors()
+    , m_fingerprint(0)
+    , m_valid(false)
+{
+}
+
+MonitorTopology* MonitorTopology::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new MonitorTopology();
+
+  return p_instance;
+}
+
+void MonitorTopology::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
 }
 
 bool CALLBACK EnumCallBack(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData)
 {
-  RECT rect_sreen;
-  vector<wxRect>* p_vec_screen = ((vector<wxRect>*)dwData);
+  vector<MonitorNode>* p_vec_screen = ((vector<MonitorNode>*)dwData);
+  MonitorNode node;
 
   MONITORINFO m_monitor_info;
   m_monitor_info.cbSize = sizeof(MONITORINFO);
-  GetMonitorInfo(hMonitor, &m_monitor_info);
+  if (!GetMonitorInfo(hMonitor, &m_monitor_info))
+    return true;
+
+  node.handle = hMonitor;
+  node.monitor = RectTowXRect(m_monitor_info.rcMonitor);
+  node.work = RectTowXRect(m_monitor_info.rcWork);
+  node.dpi = DwmUtils::GetDpiForPoint(node.monitor.x + node.monitor.width / 2,
+                                      node.monitor.y + node.monitor.height / 2);
 
-  p_vec_screen->push_back(RectTowXRect(m_monitor_info.rcWork));
+  for (int i = 0; i < NB_DIRECTIONS; ++i)
+    node.neighbour[i] = -1;
+
+  p_vec_screen->push_back(node);
 
   return true;
 }
 
-int GetCurrentScreen(const vector<wxRect>& vec_screen, HWND hwnd_window)
+// Distance from the centre of 'from' to the middle of the edge of 'screen' facing it
+double DistanceCentreToMiddleEdge(DIRECTION sens, wxRect screen, wxRect from)
 {
-  int i;
-  int nb_screen;
+  double d_x, d_y;
+  int centre_x, centre_y;
+  int screen_edge_x, screen_edge_y;
 
-  MONITORINFO m_monitor_info;
-  HMONITOR hMonitor;
-  wxRect current_screen;
+  centre_x = from.x + from.width / 2;
+  centre_y = from.y + from.height / 2;
 
-  hMonitor = MonitorFromWindow(hwnd_window, MONITOR_DEFAULTTONEAREST);
+  // Middle of the screen, not its half-height
+  screen_edge_x = screen.x + screen.width / 2;
+  screen_edge_y = screen.y + screen.height / 2;
 
-  m_monitor_info.cbSize = sizeof(MONITORINFO);
-  GetMonitorInfo(hMonitor, &m_monitor_info);
+  if (sens == RIGHT_SCREEN)
+    screen_edge_x = screen.GetLeft();
+  else if (sens == LEFT_SCREEN)
+    screen_edge_x = screen.GetRight();
+  else if (sens == DOWN_SCREEN)
+    screen_edge_y = screen.GetTop();
+  else // UP_SCREEN
+    screen_edge_y = screen.GetBottom();
 
-  current_screen = RectTowXRect(m_monitor_info.rcWork);
+  d_x = fabs(double(centre_x - screen_edge_x));
+  d_y = fabs(double(centre_y - screen_edge_y));
 
-  nb_screen = GetSystemMetrics(SM_CMONITORS);
-  for (i = 0; i < nb_screen; ++i) {
-    if (current_screen == vec_screen[i])
-      return i;
+  return sqrt(d_x * d_x + d_y * d_y);
+}
+
+// True if 'screen' lies entirely beyond the 'sens' edge of 'from'
+static bool IsInDirection(DIRECTION sens, const wxRect& screen, const wxRect& from)
+{
+  switch (sens) {
+  case RIGHT_SCREEN:
+    return screen.GetLeft() > from.GetRight();
+  case LEFT_SCREEN:
+    return screen.GetRight() < from.GetLeft();
+  case DOWN_SCREEN:
+    return screen.GetTop() > from.GetBottom();
+  case UP_SCREEN:
+    return screen.GetBottom() < from.GetTop();
   }
 
-  return -1;
+  return false;
 }
 
-double DistanceCentreToMiddleEdge(DIRECTION sens, wxRect screen, wxRect window)
+void MonitorTopology::Rebuild()
 {
-  double distance;
-  double d_x, d_y;
-  int win_centre_x, win_centre_y;
-  int screen_edge_x, screen_edge_y;
+  m_monitors.clear();
+  EnumDisplayMonitors(NULL, NULL, (MONITORENUMPROC)EnumCallBack, (LPARAM)&m_monitors);
 
-  win_centre_x = (window.GetRight() + window.GetLeft()) / 2;
-  win_centre_y = (window.GetBottom() + window.GetTop()) / 2;
+  // The nearest monitor in each direction, computed once per display configuration
+  for (size_t i = 0; i < m_monitors.size(); ++i) {
+    for (int sens = 0; sens < NB_DIRECTIONS; ++sens) {
+      double distance_min = 0;
 
-  if (sens == RIGHT_SCREEN) {
-    screen_edge_x = screen.GetLeft();
+      for (size_t j = 0; j < m_monitors.size(); ++j) {
+        if (j == i || !IsInDirection(DIRECTION(sens), m_monitors[j].monitor, m_monitors[i].monitor))
+          continue;
+
+        double distance = DistanceCentreToMiddleEdge(
+            DIRECTION(sens), m_monitors[j].monitor, m_monitors[i].monitor);
+
+        if (m_monitors[i].neighbour[sens] == -1 || distance < distance_min) {
+          m_monitors[i].neighbour[sens] = int(j);
+          distance_min = distance;
+        }
+      }
+    }
   }
-  else //(sens == LEFT_SCREEN) Future implementation of Up and down
-  {
-    screen_edge_x = screen.GetRight();
+
+  // FNV-1a over the monitors sorted by position, so the enumeration order does not matter
+  vector<MonitorNode> sorted(m_monitors);
+  sort(sorted.begin(), sorted.end(), [](const MonitorNode& a, const MonitorNode& b) {
+    return a.monitor.x != b.monitor.x ? a.monitor.x < b.monitor.x : a.monitor.y < b.monitor.y;
+  });
+
+  m_fingerprint = 14695981039346656037ULL;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    int values[] = {sorted[i].monitor.x,
+                    sorted[i].monitor.y,
+                    sorted[i].monitor.width,
+                    sorted[i].monitor.height,
+                    int(sorted[i].dpi)};
+
+    // Byte by byte, least significant first: the same value on every platform
+    for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); ++v) {
+      unsigned int value = (unsigned int)values[v];
+      for (int byte = 0; byte < 4; ++byte) {
+        m_fingerprint ^= (value >> (8 * byte)) & 0xFF;
+        m_fingerprint *= 1099511628211ULL;
+      }
+    }
   }
 
-  screen_edge_y = (screen.GetBottom() - screen.GetTop()) / 2;
+  m_valid = true;
+}
 
-  d_x = fabs(win_centre_x - screen_edge_x);
-  d_y = fabs(win_centre_y - screen_edge_y);
+void MonitorTopology::Invalidate()
+{
+  // Both are rebuilt from the next enumeration: the DPI of a node is never a stale one
+  m_valid = false;
+  DwmUtils::InvalidateDpiCache();
+}
 
-  distance = sqrt(d_x * d_x + d_y * d_y);
+unsigned long long MonitorTopology::GetFingerprint()
+{
+  if (!m_valid)
+    Rebuild();
 
-  return distance;
+  return m_fingerprint;
 }
 
-void MoveWindowToDirection(HWND hwnd, DIRECTION sens)
+int MonitorTopology::GetCount()
 {
-  int i, current;
-  int i_tmp;
-  int nb_monitor;
-  double distance, distance_tmp = 0;
-  vector<wxRect> vec_screen;
-  RECT fenetre_tmp;
-  wxRect fenetre;
+  if (!m_valid)
+    Rebuild();
 
-  nb_monitor = GetSystemMetrics(SM_CMONITORS);
-  EnumDisplayMonitors(NULL, NULL, (MONITORENUMPROC)EnumCallBack, (LPARAM)&vec_screen);
+  return int(m_monitors.size());
+}
 
-  if (nb_monitor != int(vec_screen.size())) {
-    wxMessageBox(_("Problem to enumerate all screens"), _("Error"));
-    return;
+int MonitorTopology::GetIndexFromWindow(HWND hwnd)
+{
+  return IndexOf(MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST));
+}
+
+int MonitorTopology::GetIndexFromRect(const wxRect& rect)
+{
+  RECT area = {rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+  return IndexOf(MonitorFromRect(&area, MONITOR_DEFAULTTONULL));
+}
+
+int MonitorTopology::IndexOf(HMONITOR hMonitor)
+{
+  if (!hMonitor)
+    return -1;
+
+  if (!m_valid)
+    Rebuild();
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < m_monitors.size(); ++i) {
+      if (m_monitors[i].handle == hMonitor)
+        return int(i);
+    }
+
+    // Unknown handle: the configuration changed without notification reaching us
+    Rebuild();
   }
 
-  current = GetCurrentScreen(vec_screen, hwnd);
+  return -1;
+}
+
+const MonitorNode& MonitorTopology::GetMonitor(int index)
+{
+  if (!m_valid)
+    Rebuild();
+
+  return m_monitors[index];
+}
+
+int MonitorTopology::GetNeighbour(int index, DIRECTION sens)
+{
+  if (!m_valid)
+    Rebuild();
+
+  if (index < 0 || index >= int(m_monitors.size()))
+    return -1;
+
+  return m_monitors[index].neighbour[sens];
+}
+
+void MoveWindowToDirection(HWND hwnd, DIRECTION sens)
+{
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+
+  // The source monitor is the one the previous move brought the window to
+  Animator::GetInstance()->FinishTransition(hwnd);
+
+  int current = p_topology->GetIndexFromWindow(hwnd);
   if (current == -1) {
     wxMessageBox(_("Problem to detect current screen"), _("Error"));
     return;
   }
 
-  // Use DWM-compensated rect for distance calculation
-  fenetre = DwmUtils::GetWindowRectCompensated(hwnd);
-  i_tmp = current;
+  int dest = p_topology->GetNeighbour(current, sens);
+  if (dest != -1)
+    MoveToScreen(hwnd, p_topology->GetMonitor(current), p_topology->GetMonitor(dest));
+}
+
+namespace {
+  // A window and the monitors it goes from / to
+  struct BatchMove {
+    HWND hwnd;
+    int from;
+    int to;
+  };
+
+  // Computed destination of a window of the batch
+  struct BatchTarget {
+    HWND hwnd;
+    const BatchMove* move;
+    wxRect target; // visible bounds expected once moved
+    bool resizable;
+  };
+
+  // Maximized window of the batch: restored at its new normal position after the
+  // transaction, then maximized again
+  struct BatchMaximized {
+    HWND hwnd;
+    wxRect normal; // window rect on the destination monitor
+  };
+}
+
+static bool IsNearTarget(const wxRect& rect, const wxRect& target, bool check_size)
+{
+  if (abs(rect.x - target.x) > 1 || abs(rect.y - target.y) > 1)
+    return false;
+
+  return !check_size ||
+         (abs(rect.width - target.width) <= 1 && abs(rect.height - target.height) <= 1);
+}
+
+static UINT BatchFlags(const BatchTarget& target)
+{
+  return SWP_NOZORDER | SWP_NOACTIVATE | (target.resizable ? 0 : SWP_NOSIZE);
+}
+
+// Visible size the window will accept on the destination monitor: WM_GETMINMAXINFO track
+// sizes are window rect sizes at the current DPI, a per-monitor aware window scales them
+static void ClampToTrackSize(ScreenRect& rect, const WindowGeometry& geometry, UINT from_dpi,
+                             UINT to_dpi)
+{
+  wxSize min_track = geometry.minTrack;
+  wxSize max_track = geometry.maxTrack;
+
+  if (geometry.perMonitorAware && from_dpi != to_dpi && from_dpi != 0) {
+    min_track = wxSize(MulDiv(min_track.x, to_dpi, from_dpi),
+                       MulDiv(min_track.y, to_dpi, from_dpi));
+    max_track = wxSize(MulDiv(max_track.x, to_dpi, from_dpi),
+                       MulDiv(max_track.y, to_dpi, from_dpi));
+  }
+
+  int border_x = geometry.border_left + geometry.border_right;
+  int border_y = geometry.border_top + geometry.border_bottom;
+
+  rect.width = max(min_track.x - border_x, min(rect.width, max_track.x - border_x));
+  rect.height = max(min_track.y - border_y, min(rect.height, max_track.y - border_y));
+}
+
+// Current monitor standing for a monitor of another configuration, given its work area in
+// the coordinates of that configuration: the one covering most of it (a monitor that stayed
+// keeps its coordinates, unless the primary changed), else one of the same size; -1 if none
+static int FindMonitorOfWorkArea(const wxRect& work_area)
+{
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+  int best = -1;
+  long long best_area = 0;
+
+  for (int i = 0; i < p_topology->GetCount(); ++i) {
+    wxRect common = p_topology->GetMonitor(i).work.Intersect(work_area);
+    long long area = (long long)common.width * common.height;
+    if (!common.IsEmpty() && area > best_area) {
+      best = i;
+      best_area = area;
+    }
+  }
+
+  for (int i = 0; best == -1 && i < p_topology->GetCount(); ++i) {
+    if (p_topology->GetMonitor(i).work.GetSize() == work_area.GetSize())
+      best = i;
+  }
 
-  for (i = 0; i < nb_monitor; ++i) {
-    if (i == current)
+  return best;
+}
+
+// Same proportional scaling as MoveToScreen(), but every target is computed before the
+// first window moves and all of them are committed in a single DeferWindowPos transaction
+static size_t ApplyBatch(const vector<BatchMove>& moves)
+{
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+  WindowGeometryCache* p_geometry = WindowGeometryCache::GetInstance();
+  PlacementBatcher batcher(100, false);
+  vector<BatchTarget> targets;
+  vector<BatchMaximized> maximized;
+  vector<HWND> windows;
+  vector<WindowGeometry> geometry;
+
+  windows.reserve(moves.size());
+  for (size_t i = 0; i < moves.size(); ++i)
+    windows.push_back(moves[i].hwnd);
+
+  // One pass over the whole batch
+  p_geometry->Query(windows, geometry);
+
+  targets.reserve(moves.size());
+  windows.clear();
+
+  for (size_t i = 0; i < moves.size(); ++i) {
+    if (!geometry[i].valid)
       continue;
 
-    if (sens == RIGHT_SCREEN) {
-      if (vec_screen[i].GetLeft() < vec_screen[current].GetLeft())
-        continue;
+    // The normal position is the one to scale: computed now, without showing the window
+    // restored, so nothing moves before the transaction
+    if (geometry[i].IsMaximized()) {
+      ScreenRect normal =
+          MapRectToScreen(wxRectToScreenRect(GetNormalPosition(moves[i].hwnd)),
+                          MonitorToScreenInfo(p_topology->GetMonitor(moves[i].from)),
+                          MonitorToScreenInfo(p_topology->GetMonitor(moves[i].to)));
+      BatchMaximized window = {moves[i].hwnd,
+                               wxRect(normal.x, normal.y, normal.width, normal.height)};
+      maximized.push_back(window);
+      continue;
+    }
 
-      distance = DistanceCentreToMiddleEdge(RIGHT_SCREEN, vec_screen[i], fenetre);
-      if (i_tmp == current) {
-        i_tmp = i;
-        distance_tmp = distance;
-        continue;
-      }
+    BatchTarget target;
+    target.hwnd = moves[i].hwnd;
+    target.move = &moves[i];
+    target.resizable = geometry[i].IsResizable();
+
+    targets.push_back(target);
+    windows.push_back(target.hwnd);
+  }
+
+  // Same epoch: the geometry of the windows kept, in the order of 'targets', with the
+  // track sizes of the windows (one WM_GETMINMAXINFO each)
+  p_geometry->Query(windows, geometry, GEOMETRY_ALL);
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    BatchTarget& target = targets[i];
+    const MonitorNode& from = p_topology->GetMonitor(target.move->from);
+    const MonitorNode& to = p_topology->GetMonitor(target.move->to);
+
+    ScreenRect mapped = MapRectToScreen(wxRectToScreenRect(geometry[i].visible),
+                                        MonitorToScreenInfo(from),
+                                        MonitorToScreenInfo(to));
+
+    // A constrained window is aimed at the size it will take, not corrected afterwards
+    if (target.resizable)
+      ClampToTrackSize(mapped, geometry[i], from.dpi, to.dpi);
+
+    ScreenRect sent = mapped;
+
+    // Per-monitor aware windows rescale themselves on WM_DPICHANGED, see dpi_move.cpp
+    if (target.resizable && from.dpi != to.dpi && geometry[i].perMonitorAware)
+      sent = PreScaleForDpi(mapped, from.dpi, to.dpi);
+
+    target.target = wxRect(mapped.x, mapped.y, mapped.width, mapped.height);
+    batcher.Add(target.hwnd,
+                geometry[i].WindowRectFor(wxRect(sent.x, sent.y, sent.width, sent.height)),
+                BatchFlags(target));
+  }
 
-      if (distance < distance_tmp)
-        i_tmp = i;
+  size_t moved = batcher.Flush();
+
+  // Moved windows were invalidated by the flush: this pass reads them once more.
+  // Those that did not end where expected (application ignoring WM_DPICHANGED, size
+  // constraints) get a second, smaller transaction.
+  p_geometry->Query(windows, geometry);
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const BatchTarget& target = targets[i];
+
+    if (!geometry[i].valid || IsNearTarget(geometry[i].visible, target.target, target.resizable))
+      continue;
+
+    // A missed target may come from borders measured before a frame change: measured again
+    DwmUtils::InvalidateFrameBorders(target.hwnd);
+    p_geometry->Invalidate(target.hwnd);
+    WindowGeometry current = p_geometry->Query(target.hwnd);
+    if (!current.valid || IsNearTarget(current.visible, target.target, target.resizable))
+      continue;
+
+    batcher.Add(target.hwnd, current.WindowRectFor(target.target), BatchFlags(target));
+  }
+  batcher.Flush();
+
+  // Maximizing is not deferrable: done once the other windows are on their monitor
+  for (size_t i = 0; i < maximized.size(); ++i) {
+    if (!IsWindow(maximized[i].hwnd))
+      continue;
+
+    RestoreAt(maximized[i].hwnd, maximized[i].normal, true);
+    p_geometry->Invalidate(maximized[i].hwnd);
+    ++moved;
+  }
+
+  return moved;
+}
+
+size_t GatherWindows(int monitor)
+{
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+
+  if (monitor < 0 || monitor >= p_topology->GetCount())
+    return 0;
+
+  WindowGeometryCache::GetInstance()->NextEpoch();
+
+  vector<HWND> windows;
+  ListWindows::ListAppWindows(windows);
+
+  vector<BatchMove> moves;
+  for (size_t i = 0; i < windows.size(); ++i) {
+    int current = p_topology->GetIndexFromWindow(windows[i]);
+
+    if (current != -1 && current != monitor) {
+      BatchMove move = {windows[i], current, monitor};
+      moves.push_back(move);
+    }
+  }
+
+  return ApplyBatch(moves);
+}
+
+size_t SpreadWindows(SPREAD_POLICY policy)
+{
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+  int nb_monitors = p_topology->GetCount();
+
+  if (nb_monitors < 2)
+    return 0;
+
+  WindowGeometryCache::GetInstance()->NextEpoch();
+
+  // Z order: the foreground window comes first
+  vector<HWND> windows;
+  ListWindows::ListAppWindows(windows);
+
+  vector<BatchMove> moves;
+  unordered_map<DWORD, int> process_monitor;
+  int next = 0;
+
+  for (size_t i = 0; i < windows.size(); ++i) {
+    HWND hwnd = windows[i];
+    int current = p_topology->GetIndexFromWindow(hwnd);
+    int dest = -1;
+
+    if (current == -1)
+      continue;
+
+    switch (policy) {
+    case SPREAD_ROUND_ROBIN:
+      dest = next++ % nb_monitors;
+      break;
+
+    case SPREAD_BY_PROCESS: {
+      DWORD process_id = 0;
+      GetWindowThreadProcessId(hwnd, &process_id);
+
+      unordered_map<DWORD, int>::iterator it = process_monitor.find(process_id);
+      if (it == process_monitor.end())
+        it = process_monitor.insert(make_pair(process_id, next++ % nb_monitors)).first;
+
+      dest = it->second;
+      break;
+    }
+
+    case SPREAD_BY_LAST_KNOWN: {
+      // Windows never seen on another monitor configuration stay where they are
+      wxRect last_known, work_area;
+      if (LayoutSnapshots::GetInstance()->GetLastKnownRect(hwnd, last_known, work_area))
+        dest = FindMonitorOfWorkArea(work_area);
+      break;
+    }
     }
-    else if (sens == LEFT_SCREEN) {
-      if (vec_screen[i].GetRight() > vec_screen[current].GetRight())
-        continue;
-
-      distance = DistanceCentreToMiddleEdge(LEFT_SCREEN, vec_screen[i], fenetre);
-      if (i_tmp == current) {
-        i_tmp = i;
-        distance_tmp = distance;
-        continue;
-      }
 
-      if (distance < distance_tmp)
-        i_tmp = i;
+    if (dest != -1 && dest != current) {
+      BatchMove move = {hwnd, current, dest};
+      moves.push_back(move);
     }
   }
 
-  if (i_tmp != current)
-    MoveToScreen(hwnd, vec_screen[current], vec_screen[i_tmp]);
+  return ApplyBatch(moves);
 }
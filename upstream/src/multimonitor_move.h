@@ -1,13 +1,79 @@
 #ifndef __MOVE_WINDOW_H__
 #define __MOVE_WINDOW_H__
 
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/gdicmn.h>
+
+#include <vector>
+
 enum DIRECTION {
   LEFT_SCREEN,
   RIGHT_SCREEN,
-  UP_SCREEN,  // To be implemented in the future
-  DOWN_SCREEN // To be implemented in the future
+  UP_SCREEN,
+  DOWN_SCREEN
+};
+
+#define NB_DIRECTIONS 4
+
+// How SpreadWindows() distributes the windows over the monitors
+enum SPREAD_POLICY {
+  SPREAD_ROUND_ROBIN,   // one window per monitor in turn, in Z order
+  SPREAD_BY_PROCESS,    // windows of a same process stay together
+  SPREAD_BY_LAST_KNOWN  // back on the monitor of the last other configuration, if any
+};
+
+struct MonitorNode {
+  HMONITOR handle;
+  wxRect monitor; // full monitor area, used for the adjacency
+  wxRect work;    // work area (without taskbar), used for the placement
+  UINT dpi;
+  int neighbour[NB_DIRECTIONS]; // index of the nearest monitor per DIRECTION, -1 if none
+};
+
+// Monitors and their adjacency in the four directions, built once and kept until the
+// display configuration changes (WM_DISPLAYCHANGE / WM_SETTINGCHANGE call Invalidate()).
+class MonitorTopology // Singleton class
+{
+private:
+  static MonitorTopology* p_instance;
+
+  std::vector<MonitorNode> m_monitors;
+  unsigned long long m_fingerprint;
+  bool m_valid;
+
+  MonitorTopology();
+  ~MonitorTopology() {}
+
+  void Rebuild();
+  int IndexOf(HMONITOR hMonitor);
+
+public:
+  static MonitorTopology* GetInstance();
+  static void DeleteInstance();
+
+  // Only marks the cache as stale, it is rebuilt on the next lookup. The DPI cache of
+  // DwmUtils, which gives the scale factors of the monitors, is invalidated with it.
+  void Invalidate();
+
+  // Identifies the monitor configuration (areas and scale factors), stable across runs
+  unsigned long long GetFingerprint();
+
+  int GetCount();
+  int GetIndexFromWindow(HWND hwnd);
+  int GetIndexFromRect(const wxRect& rect); // -1 if the rect is on no monitor
+  const MonitorNode& GetMonitor(int index);
+  int GetNeighbour(int index, DIRECTION sens);
 };
 
 extern void MoveWindowToDirection(HWND hwnd, DIRECTION sens);
 
+// Batch moves: all targets are computed first, then applied in one DeferWindowPos
+// transaction. Return the number of windows moved.
+extern size_t GatherWindows(int monitor);
+extern size_t SpreadWindows(SPREAD_POLICY policy);
+
 #endif // __MOVE_WINDOW_H__
@@ -0,0 +1,262 @@
+#include "placement_rules.h"
+
+#include "debug_log.h"
+#include "dwm_utils.h"
+#include "list_windows.h"
+#include "multimonitor_move.h"
+#include "settingsmanager.h"
+
+#include <wx/filefn.h>
+#include <wx/xml/xml.h>
+
+#include <cmath>
+
+using namespace std;
+
+PlacementRules* PlacementRules::p_instance = NULL;
+
+namespace {
+  // Above this count, handles of destroyed windows are purged from the placed set
+  const size_t MAX_PLACED_WINDOWS = 256;
+}
+
+PlacementRules::PlacementRules()
+    : m_matcher()
+    , m_targets()
+    , m_batcher()
+    , m_hook(NULL)
+    , m_placed()
+{
+}
+
+PlacementRules::~PlacementRules()
+{
+  Stop();
+}
+
+PlacementRules* PlacementRules::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new PlacementRules();
+
+  return p_instance;
+}
+
+void PlacementRules::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+bool PlacementRules::LoadData()
+{
+  wxString path = SettingsManager::Get().GetDataDirectory() + _T ("placement_rules.xml");
+  wxXmlDocument doc;
+
+  if (!wxFileExists(path) || !doc.Load(path)) {
+    m_matcher.Clear();
+    m_targets.clear();
+    return false;
+  }
+
+  return LoadData(doc);
+}
+
+bool PlacementRules::LoadData(const wxXmlDocument& doc)
+{
+  wxXmlNode* child;
+  PlacementTarget target;
+  double val_tmp;
+  long long_tmp;
+
+  m_matcher.Clear();
+  m_targets.clear();
+
+  if (!doc.GetRoot())
+    return false;
+
+  for (child = doc.GetRoot()->GetChildren(); child; child = child->GetNext()) {
+    if (child->GetType() != wxXML_ELEMENT_NODE || child->GetName() != _T ("Rule"))
+      continue;
+
+    target.m_monitor = -1;
+    if (child->GetAttribute(_T ("monitor"), _T ("-1")).ToLong(&long_tmp))
+      target.m_monitor = int(long_tmp);
+
+    target.m_resize = child->GetAttribute(_T ("resize"), _T ("1")) != _T ("0");
+
+    target.m_layoutZone = -1;
+    if (child->GetAttribute(_T ("zone"), wxEmptyString).ToLong(&long_tmp)) {
+      if (long_tmp < 1 || long_tmp > 9)
+        continue;
+      target.m_layoutZone = int(long_tmp) - 1;
+    }
+    else {
+      target.m_zone.x = child->GetAttribute(_T ("x"), _T ("0")).ToDouble(&val_tmp) ? val_tmp : 0;
+      target.m_zone.y = child->GetAttribute(_T ("y"), _T ("0")).ToDouble(&val_tmp) ? val_tmp : 0;
+      target.m_zone.width =
+          child->GetAttribute(_T ("width"), _T ("100")).ToDouble(&val_tmp) ? val_tmp : 100;
+      target.m_zone.height =
+          child->GetAttribute(_T ("height"), _T ("100")).ToDouble(&val_tmp) ? val_tmp : 100;
+    }
+
+    // Patterns are compiled here, once; an invalid rule is skipped
+    if (m_matcher.AddRule(child->GetAttribute(_T ("process"), wxEmptyString).ToStdWstring(),
+                          child->GetAttribute(_T ("class"), wxEmptyString).ToStdWstring(),
+                          child->GetAttribute(_T ("title"), wxEmptyString).ToStdWstring()) < 0) {
+      DEBUG_LOG_FMT("placement_rules.xml: invalid regex in rule %d", int(m_targets.size()));
+      continue;
+    }
+
+    m_targets.push_back(target);
+  }
+
+  return !m_targets.empty();
+}
+
+void PlacementRules::Start()
+{
+  if (m_hook || m_matcher.IsEmpty())
+    return;
+
+  // Out of context: the callback runs on this thread's message loop, no DLL injection
+  m_hook = SetWinEventHook(EVENT_OBJECT_SHOW,
+                           EVENT_OBJECT_SHOW,
+                           NULL,
+                           WinEventProc,
+                           0,
+                           0,
+                           WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+void PlacementRules::Stop()
+{
+  if (m_hook) {
+    UnhookWinEvent(m_hook);
+    m_hook = NULL;
+  }
+
+  m_batcher.Cancel();
+  m_placed.clear();
+}
+
+void CALLBACK PlacementRules::WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                           LONG idObject, LONG idChild, DWORD idThread, DWORD time)
+{
+  // Cheap filters first: this is called for every window shown in the session
+  if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !p_instance)
+    return;
+
+  if (!ListWindows::IsAppWindow(hwnd))
+    return;
+
+  p_instance->Apply(hwnd);
+}
+
+bool PlacementRules::GetProcessName(HWND hwnd, wstring& name)
+{
+  DWORD process_id = 0;
+  wchar_t path[MAX_PATH] = {0};
+  DWORD size = MAX_PATH;
+
+  GetWindowThreadProcessId(hwnd, &process_id);
+
+  HANDLE process_handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process_id);
+  if (!process_handle)
+    return false;
+
+  BOOL ok = QueryFullProcessImageNameW(process_handle, 0, path, &size);
+  CloseHandle(process_handle);
+
+  if (!ok)
+    return false;
+
+  name = path;
+  size_t pos = name.find_last_of(L'\\');
+  if (pos != wstring::npos)
+    name.erase(0, pos + 1);
+
+  return true;
+}
+
+bool PlacementRules::GetWorkArea(HWND hwnd, int monitor, RECT& work_area)
+{
+  // The topology is cached until the display configuration changes: no enumeration here
+  MonitorTopology* p_topology = MonitorTopology::GetInstance();
+
+  // Unknown index (monitor unplugged...): stay on the current one
+  if (monitor < 0 || monitor >= p_topology->GetCount())
+    monitor = p_topology->GetIndexFromWindow(hwnd);
+  if (monitor == -1)
+    return false;
+
+  const wxRect& work = p_topology->GetMonitor(monitor).work;
+  work_area.left = work.x;
+  work_area.top = work.y;
+  work_area.right = work.x + work.width;
+  work_area.bottom = work.y + work.height;
+  return true;
+}
+
+bool PlacementRules::Apply(HWND hwnd)
+{
+  if (m_matcher.IsEmpty() || m_placed.count(hwnd) || IsIconic(hwnd))
+    return false;
+
+  if (m_placed.size() > MAX_PLACED_WINDOWS) {
+    for (unordered_set<HWND>::iterator it = m_placed.begin(); it != m_placed.end();) {
+      if (!IsWindow(*it))
+        it = m_placed.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  wstring process;
+  if (!GetProcessName(hwnd, process))
+    return false;
+
+  wchar_t buffer[256] = {0};
+  GetClassNameW(hwnd, buffer, 255);
+  wstring wnd_class(buffer);
+
+  buffer[0] = L'\0';
+  GetWindowTextW(hwnd, buffer, 255);
+  wstring title(buffer);
+
+  int rule = m_matcher.Match(process, wnd_class, title);
+  if (rule < 0)
+    return false;
+
+  m_placed.insert(hwnd);
+
+  const PlacementTarget& target = m_targets[rule];
+  RatioRect zone = target.m_zone;
+  if (target.m_layoutZone != -1 &&
+      !LayoutManager::GetInstance()->GetFirstRatio(target.m_layoutZone, zone))
+    return false;
+
+  RECT screen_rect;
+  if (!GetWorkArea(hwnd, target.m_monitor, screen_rect))
+    return false;
+
+  int screen_width = screen_rect.right - screen_rect.left;
+  int screen_height = screen_rect.bottom - screen_rect.top;
+
+  wxRect res;
+  res.x = screen_rect.left + int(round(zone.x * 0.01 * screen_width));
+  res.y = screen_rect.top + int(round(zone.y * 0.01 * screen_height));
+  res.width = int(round(zone.width * 0.01 * screen_width));
+  res.height = int(round(zone.height * 0.01 * screen_height));
+
+  if (IsZoomed(hwnd))
+    ShowWindow(hwnd, SW_RESTORE);
+
+  // Adjust target rect for invisible frame borders (Windows 10/11)
+  wxRect adjusted = DwmUtils::AdjustForInvisibleFrame(hwnd, res);
+
+  // Do not steal the focus: during a login storm the user is already typing elsewhere
+  m_batcher.Add(hwnd, adjusted, SWP_NOZORDER | SWP_NOACTIVATE | (target.m_resize ? 0 : SWP_NOSIZE));
+
+  return true;
+}
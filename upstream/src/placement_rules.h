@@ -0,0 +1,77 @@
+#ifndef __PLACEMENT_RULES_H__
+#define __PLACEMENT_RULES_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/string.h>
+#include <wx/xml/xml.h>
+
+#include <unordered_set>
+#include <vector>
+
+#include "functions_resize.h"
+#include "layout_manager.h"
+#include "rule_matcher.h"
+
+// Where a window matched by a rule is sent
+struct PlacementTarget {
+  int m_monitor;    // index in EnumDisplayMonitors() order, -1 for the window's own monitor
+  int m_layoutZone; // numpad key (0-8) of a layout sequence, -1 if m_zone is given
+  RatioRect m_zone; // in percent of the monitor work area, like the layout sequences
+  bool m_resize;
+};
+
+// Declarative placement rules (placement_rules.xml), applied automatically when a new
+// top-level window is shown:
+//
+// <PlacementRules>
+//   <Rule process="chrome.exe" class="Chrome_WidgetWin_1" title="re:.*YouTube.*"
+//         monitor="1" zone="6"/>
+//   <Rule process="putty*" x="0" y="0" width="50" height="100" resize="1"/>
+// </PlacementRules>
+//
+// "zone" is a numpad key (1-9) and picks the first position of that layout sequence, read
+// when the window is placed so an edited layout applies at once; otherwise x/y/width/height
+// give the zone in percent. Rules are tried in file order.
+class PlacementRules // Singleton class
+{
+private:
+  static PlacementRules* p_instance;
+
+  RuleMatcher m_matcher;
+  std::vector<PlacementTarget> m_targets;
+
+  // Login storms show dozens of windows at once: moves are grouped per monitor
+  PlacementBatcher m_batcher;
+
+  HWINEVENTHOOK m_hook;
+  std::unordered_set<HWND> m_placed; // windows already handled, each is placed once
+
+  PlacementRules();
+  ~PlacementRules();
+
+  static void CALLBACK WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                    LONG idChild, DWORD idThread, DWORD time);
+  static bool GetProcessName(HWND hwnd, std::wstring& name);
+  static bool GetWorkArea(HWND hwnd, int monitor, RECT& work_area);
+
+public:
+  static PlacementRules* GetInstance();
+  static void DeleteInstance();
+
+  bool LoadData();
+  // Rules of a file already parsed (hot reload)
+  bool LoadData(const wxXmlDocument& doc);
+
+  // Install / remove the window creation hook. Nothing is installed without rules.
+  void Start();
+  void Stop();
+
+  // Place the window according to the first matching rule, return false if none matched
+  bool Apply(HWND hwnd);
+};
+
+#endif // __PLACEMENT_RULES_H__
@@ -0,0 +1,231 @@
+#include "rule_matcher.h"
+
+#include <algorithm>
+#include <cwctype>
+
+using namespace std;
+
+RuleMatcher::RuleMatcher()
+    : m_rules()
+    , m_trie(1)
+    , m_unindexed()
+    , m_regex()
+{
+}
+
+void RuleMatcher::Clear()
+{
+  m_rules.clear();
+  m_trie.assign(1, TrieNode());
+  m_unindexed.clear();
+  m_regex.clear();
+}
+
+wstring RuleMatcher::ToLower(const wstring& str)
+{
+  wstring result(str);
+  for (size_t i = 0; i < result.size(); ++i)
+    result[i] = (wchar_t)towlower(result[i]);
+
+  return result;
+}
+
+bool RuleMatcher::GlobMatch(const wstring& pattern, const wstring& value)
+{
+  // Iterative matching with a single backtrack point: linear for most patterns
+  size_t p = 0, v = 0;
+  size_t star = wstring::npos, mark = 0;
+
+  while (v < value.size()) {
+    if (p < pattern.size() && (pattern[p] == L'?' || pattern[p] == value[v])) {
+      ++p;
+      ++v;
+    }
+    else if (p < pattern.size() && pattern[p] == L'*') {
+      star = p++;
+      mark = v;
+    }
+    else if (star != wstring::npos) {
+      p = star + 1;
+      v = ++mark;
+    }
+    else {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == L'*')
+    ++p;
+
+  return p == pattern.size();
+}
+
+bool RuleMatcher::Compile(const wstring& source, RulePattern& pattern)
+{
+  pattern = RulePattern();
+
+  if (source.empty() || source == L"*")
+    return true;
+
+  if (source.compare(0, 3, L"re:") == 0) {
+    try {
+      m_regex.push_back(wregex(source.substr(3),
+                               regex_constants::ECMAScript | regex_constants::icase |
+                                   regex_constants::optimize));
+    }
+    catch (const regex_error&) {
+      return false;
+    }
+
+    pattern.kind = RULE_PATTERN_REGEX;
+    pattern.text = source.substr(3);
+    pattern.regex = int(m_regex.size()) - 1;
+    return true;
+  }
+
+  pattern.text = ToLower(source);
+
+  size_t wildcard = pattern.text.find_first_of(L"*?");
+  if (wildcard == wstring::npos) {
+    pattern.kind = RULE_PATTERN_EXACT;
+  }
+  else if (wildcard == pattern.text.size() - 1 && pattern.text[wildcard] == L'*') {
+    pattern.kind = RULE_PATTERN_PREFIX;
+    pattern.text.erase(wildcard);
+  }
+  else {
+    pattern.kind = RULE_PATTERN_GLOB;
+  }
+
+  return true;
+}
+
+int RuleMatcher::TrieInsert(const wstring& key)
+{
+  int node = 0;
+
+  for (size_t i = 0; i < key.size(); ++i) {
+    vector<pair<wchar_t, int>>& next = m_trie[node].next;
+    vector<pair<wchar_t, int>>::iterator it = next.begin();
+
+    while (it != next.end() && it->first != key[i])
+      ++it;
+
+    if (it != next.end()) {
+      node = it->second;
+    }
+    else {
+      // m_trie may reallocate: do not keep references across push_back
+      int child = int(m_trie.size());
+      next.push_back(make_pair(key[i], child));
+      m_trie.push_back(TrieNode());
+      node = child;
+    }
+  }
+
+  return node;
+}
+
+int RuleMatcher::AddRule(const wstring& process, const wstring& wndClass, const wstring& title)
+{
+  Rule rule;
+  size_t nb_regex = m_regex.size();
+
+  if (!Compile(process, rule.process) || !Compile(wndClass, rule.wndClass) ||
+      !Compile(title, rule.title)) {
+    m_regex.resize(nb_regex);
+    return -1;
+  }
+
+  int index = int(m_rules.size());
+  m_rules.push_back(rule);
+
+  switch (rule.process.kind) {
+  case RULE_PATTERN_ANY:
+    m_trie[0].prefix.push_back(index);
+    break;
+  case RULE_PATTERN_EXACT:
+    m_trie[TrieInsert(rule.process.text)].exact.push_back(index);
+    break;
+  case RULE_PATTERN_PREFIX:
+    m_trie[TrieInsert(rule.process.text)].prefix.push_back(index);
+    break;
+  default:
+    m_unindexed.push_back(index);
+    break;
+  }
+
+  return index;
+}
+
+bool RuleMatcher::MatchPattern(const RulePattern& pattern, const wstring& value,
+                               const wstring& lower) const
+{
+  switch (pattern.kind) {
+  case RULE_PATTERN_ANY:
+    return true;
+  case RULE_PATTERN_EXACT:
+    return lower == pattern.text;
+  case RULE_PATTERN_PREFIX:
+    return lower.compare(0, pattern.text.size(), pattern.text) == 0;
+  case RULE_PATTERN_GLOB:
+    return GlobMatch(pattern.text, lower);
+  case RULE_PATTERN_REGEX:
+    return regex_match(value, m_regex[pattern.regex]);
+  }
+
+  return false;
+}
+
+int RuleMatcher::Match(const wstring& process, const wstring& wndClass, const wstring& title) const
+{
+  if (m_rules.empty())
+    return -1;
+
+  wstring key(ToLower(process));
+  vector<int> candidates(m_trie[0].prefix);
+
+  // Walk the trie along the process name, collecting every rule on the way
+  int node = 0;
+  size_t depth = 0;
+  for (; depth < key.size(); ++depth) {
+    const vector<pair<wchar_t, int>>& next = m_trie[node].next;
+    vector<pair<wchar_t, int>>::const_iterator it = next.begin();
+
+    while (it != next.end() && it->first != key[depth])
+      ++it;
+
+    if (it == next.end())
+      break;
+
+    node = it->second;
+    candidates.insert(candidates.end(), m_trie[node].prefix.begin(), m_trie[node].prefix.end());
+  }
+
+  if (depth == key.size())
+    candidates.insert(candidates.end(), m_trie[node].exact.begin(), m_trie[node].exact.end());
+
+  candidates.insert(candidates.end(), m_unindexed.begin(), m_unindexed.end());
+
+  // Keep the priority given by the file order
+  sort(candidates.begin(), candidates.end());
+
+  wstring lowerClass(ToLower(wndClass));
+  wstring lowerTitle(ToLower(title));
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const Rule& rule = m_rules[candidates[i]];
+
+    // Process patterns found through the trie are already matched
+    if (rule.process.kind == RULE_PATTERN_GLOB || rule.process.kind == RULE_PATTERN_REGEX) {
+      if (!MatchPattern(rule.process, process, key))
+        continue;
+    }
+
+    if (MatchPattern(rule.wndClass, wndClass, lowerClass) &&
+        MatchPattern(rule.title, title, lowerTitle))
+      return candidates[i];
+  }
+
+  return -1;
+}
@@ -0,0 +1,91 @@
+#ifndef __RULE_MATCHER_H__
+#define __RULE_MATCHER_H__
+
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Compiled matcher for window rules made of three patterns (process, class, title).
+//
+// Pattern syntax (case-insensitive):
+//   ""  or "*"       matches anything
+//   "re:<regex>"     ECMAScript regular expression, must match the whole string
+//   "foo*"           prefix
+//   "f?o*bar"        glob with '*' and '?'
+//   anything else    exact
+//
+// Process patterns that are exact or prefix are stored in a trie, so a lookup only
+// visits the rules sharing the process name instead of the whole list. Regexes are
+// compiled once when the rule is added. Rules are tried in insertion order and the
+// first match wins.
+//
+// This file only depends on the standard library.
+
+enum RulePatternKind {
+  RULE_PATTERN_ANY,
+  RULE_PATTERN_EXACT,
+  RULE_PATTERN_PREFIX,
+  RULE_PATTERN_GLOB,
+  RULE_PATTERN_REGEX
+};
+
+struct RulePattern {
+  RulePatternKind kind;
+  std::wstring text; // lower case, without the wildcard / "re:" prefix
+  int regex;         // index in RuleMatcher::m_regex for RULE_PATTERN_REGEX, -1 otherwise
+
+  RulePattern()
+      : kind(RULE_PATTERN_ANY)
+      , regex(-1)
+  {
+  }
+};
+
+class RuleMatcher {
+private:
+  struct TrieNode {
+    std::vector<std::pair<wchar_t, int>> next;
+    std::vector<int> exact;  // rules whose process pattern ends on this node
+    std::vector<int> prefix; // rules whose process pattern starts with this node
+  };
+
+  struct Rule {
+    RulePattern process;
+    RulePattern wndClass;
+    RulePattern title;
+  };
+
+  std::vector<Rule> m_rules;
+  std::vector<TrieNode> m_trie;
+  std::vector<int> m_unindexed; // rules with a glob / regex process pattern
+  std::vector<std::wregex> m_regex;
+
+  bool Compile(const std::wstring& source, RulePattern& pattern);
+  // 'lower' is 'value' in lower case, computed once per Match
+  bool MatchPattern(const RulePattern& pattern, const std::wstring& value,
+                    const std::wstring& lower) const;
+  int TrieInsert(const std::wstring& key);
+
+public:
+  RuleMatcher();
+
+  void Clear();
+
+  // Add a rule and return its index, or -1 if one of the patterns is an invalid regex.
+  int AddRule(const std::wstring& process, const std::wstring& wndClass,
+              const std::wstring& title);
+
+  // Return the index of the first rule matching the window, or -1.
+  // The process name is the executable file name (e.g. "notepad.exe").
+  int Match(const std::wstring& process, const std::wstring& wndClass,
+            const std::wstring& title) const;
+
+  size_t Size() const { return m_rules.size(); }
+  bool IsEmpty() const { return m_rules.empty(); }
+
+  static std::wstring ToLower(const std::wstring& str);
+  static bool GlobMatch(const std::wstring& pattern, const std::wstring& value);
+};
+
+#endif // __RULE_MATCHER_H__
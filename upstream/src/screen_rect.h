@@ -0,0 +1,14 @@
+#ifndef __SCREEN_RECT_H__
+#define __SCREEN_RECT_H__
+
+// Rectangle in physical screen pixels, shared by the modules that only depend on the
+// standard library (dpi_move, dpi_cache) so they can be tested without wxWidgets.
+
+struct ScreenRect {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+#endif // __SCREEN_RECT_H__
@@ -0,0 +1,136 @@
+#ifndef __SETTINGS_SCHEMA_H__
+#define __SETTINGS_SCHEMA_H__
+
+#include <wx/colour.h>
+#include <wx/string.h>
+
+#include <time.h>
+
+// Value types of the schema: default, clamping and text of the XML attribute
+struct SettingBool {
+  typedef bool Type;
+  static Type FromDefault(long value) { return value != 0; }
+  static Type Clamp(Type value, long, long) { return value; }
+  static wxString ToString(Type value);
+  static bool FromString(const wxString& text, Type& value);
+};
+
+struct SettingInt {
+  typedef int Type;
+  static Type FromDefault(long value) { return Type(value); }
+  static Type Clamp(Type value, long min, long max)
+  {
+    return value < min ? Type(min) : value > max ? Type(max) : value;
+  }
+  static wxString ToString(Type value);
+  static bool FromString(const wxString& text, Type& value);
+};
+
+struct SettingTime {
+  typedef time_t Type;
+  static Type FromDefault(long value) { return Type(value); }
+  static Type Clamp(Type value, long, long) { return value; }
+  static wxString ToString(Type value);
+  static bool FromString(const wxString& text, Type& value);
+};
+
+// Default as 0xRRGGBB, text as #RRGGBB
+struct SettingColour {
+  typedef wxColour Type;
+  static Type FromDefault(long value)
+  {
+    return wxColour((value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF);
+  }
+  static Type Clamp(const Type& value, long, long) { return value; }
+  static wxString ToString(const Type& value);
+  static bool FromString(const wxString& text, Type& value);
+};
+
+// MOD_xxx flags, text as the name of the modifier key
+struct SettingModifier {
+  typedef unsigned int Type;
+  static Type FromDefault(long value) { return Type(value); }
+  static Type Clamp(Type value, long, long) { return value; }
+  static wxString ToString(Type value);
+  static bool FromString(const wxString& text, Type& value);
+};
+
+// The settings saved in WinSplit_Settings, one line each. SettingsManager generates from it
+// the members, the accessors, the defaults, the XML reading and writing, and a SETTING_xxx
+// identifier for the change notifications:
+//
+//   X(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE, DEFAULT, MIN, MAX)
+//
+// is saved as <SECTION><ELEMENT ATTRIBUTE="..."/></SECTION>, settings of the same element
+// sharing it. The setters clamp to [MIN, MAX] (SettingInt only).
+#define SETTINGS_SCHEMA(X)                                                                       \
+  /* General */                                                                                  \
+  X(ACCEPT_TOPMOST, SettingBool, m_bAcceptTopmostWindows, AcceptTopMostWindows,                  \
+    setAcceptTopMostWindows, _T ("General"), _T ("AcceptTopMostWindow"), _T ("Value"), false, 0, \
+    1)                                                                                           \
+  X(SHOW_HK_WARNINGS, SettingBool, m_bShowHKWarnings, hasToShowHotkeysWarnings,                  \
+    setShowHotkeysWarnings, _T ("General"), _T ("ShowHotKeysWarnings"), _T ("Value"), true, 0,   \
+    1)                                                                                           \
+  X(AUTO_DEL_TMP_FILES, SettingBool, m_bAutoDelTmpFiles, getAutoDeleteTempFiles,                 \
+    setAutoDeleteTempFiles, _T ("General"), _T ("TempFiles"), _T ("AutoDelete"), true, 0, 1)     \
+  /* 0 = delete the files when WinSplit starts, 1 = when WinSplit finishes */                    \
+  X(AUTO_DEL_TIME, SettingInt, m_iAutoDelTime, getAutoDeleteTime, setAutoDeleteTime,             \
+    _T ("General"), _T ("TempFiles"), _T ("AutoDelTime"), 0, 0, 1)                               \
+  /* Virtual Numpad */                                                                           \
+  X(NUMPAD_POS_X, SettingInt, m_iVN_PosX, getNumpadPosX, setNumpadPosX, _T ("VirtualNumpad"),    \
+    _T ("Position"), _T ("X"), 640, -10000, 10000)                                               \
+  X(NUMPAD_POS_Y, SettingInt, m_iVN_PosY, getNumpadPosY, setNumpadPosY, _T ("VirtualNumpad"),    \
+    _T ("Position"), _T ("Y"), 480, -10000, 10000)                                               \
+  X(NUMPAD_REDUCED, SettingBool, m_bVN_Reduced, getNumpadStyle, setNumpadStyle,                  \
+    _T ("VirtualNumpad"), _T ("Style"), _T ("Reduced"), false, 0, 1)                             \
+  X(NUMPAD_TRANSPARENCY, SettingInt, m_iVN_Transparency, getNumpadTransparency,                  \
+    setNumpadTransparency, _T ("VirtualNumpad"), _T ("Style"), _T ("Transparency"), 65, 0, 100)  \
+  X(NUMPAD_AT_BOOT, SettingBool, m_bVN_ShownAtBoot, getShowNumpadAtBoot, setShowNumpadAtBoot,    \
+    _T ("VirtualNumpad"), _T ("Comportment"), _T ("ShowAtBoot"), false, 0, 1)                    \
+  X(NUMPAD_SAVE_POS, SettingBool, m_bVN_SavePosOnExit, getSaveNumpadPosOnExit,                   \
+    setSaveNumpadPosOnExit, _T ("VirtualNumpad"), _T ("Comportment"), _T ("SaveAtExit"), true,   \
+    0, 1)                                                                                        \
+  X(NUMPAD_AUTO_HIDE, SettingBool, m_bVN_AutoHide, getNumpadAutoHide, setNumpadAutoHide,         \
+    _T ("VirtualNumpad"), _T ("Comportment"), _T ("AutoHide"), false, 0, 1)                      \
+  /* Web Update */                                                                               \
+  X(CHECK_UPDATES, SettingBool, m_bCheckForUpdates, hasToCheckForUpdates, setCheckForUpdates,    \
+    _T ("WebUpdate"), _T ("AutoCheck"), _T ("Value"), true, 0, 1)                                \
+  X(UPDATE_FREQUENCY, SettingInt, m_iUpdateCheckFrequency, getUpdateCheckFrequency,              \
+    setUpdateCheckFrequency, _T ("WebUpdate"), _T ("Frequency"), _T ("Value"),                   \
+    CHECK_UPDATES_ON_START, CHECK_UPDATES_ON_START, CHECK_UPDATES_MONTHLY)                       \
+  X(LAST_UPDATE_CHECK, SettingTime, m_tLastUpdateCheck, getLastCheckDate, setLastCheckDate,      \
+    _T ("WebUpdate"), _T ("LastCheck"), _T ("Value"), 0, 0, 0)                                   \
+  /* Drag'N'Go */                                                                                \
+  X(DNG_ENABLED, SettingBool, m_bDNG_Enabled, IsDragNGoEnabled, EnableDragNGo,                   \
+    _T ("Drag_N_Go"), _T ("Enabled"), _T ("Value"), true, 0, 1)                                  \
+  X(DNG_TIMER, SettingInt, m_iDNG_timer, getDnGTimerFrequency, setDnGTimerFrequency,             \
+    _T ("Drag_N_Go"), _T ("TimerFrequency"), _T ("Value"), 100, 10, 1000)                        \
+  X(DNG_RADIUS, SettingInt, m_iDNG_Radius, getDnGDetectionRadius, setDnGDetectionRadius,         \
+    _T ("Drag_N_Go"), _T ("DetectionRadius"), _T ("Value"), 100, 10, 500)                        \
+  X(DNG_ZONE_BG, SettingColour, m_cDNG_BgColor, getDnGZoneBgColor, setDnGZoneBgColor,            \
+    _T ("Drag_N_Go"), _T ("ZoneColors"), _T ("Background"), 0x4169E1, 0, 0)                      \
+  X(DNG_ZONE_FG, SettingColour, m_cDNG_FgColor, getDnGZoneFgColor, setDnGZoneFgColor,            \
+    _T ("Drag_N_Go"), _T ("ZoneColors"), _T ("Foreground"), 0xFFFFFF, 0, 0)                      \
+  X(DNG_TRANSPARENCY, SettingInt, m_iDNG_Transparency, getDngZoneTransparency,                   \
+    setDnGZoneTransparency, _T ("Drag_N_Go"), _T ("Transparency"), _T ("Value"), 45, 0, 100)     \
+  X(DNG_MOD1, SettingModifier, m_modDNG1, getDnGMod1, setDnGMod1, _T ("Drag_N_Go"),              \
+    _T ("Modifiers"), _T ("Modifier1"), 0x02 /* MOD_CONTROL */, 0, 0)                            \
+  X(DNG_MOD2, SettingModifier, m_modDNG2, getDnGMod2, setDnGMod2, _T ("Drag_N_Go"),              \
+    _T ("Modifiers"), _T ("Modifier2"), 0x01 /* MOD_ALT */, 0, 0)                                \
+  /* Miscellaneous */                                                                            \
+  X(MOUSE_FOLLOW, SettingBool, m_bMouseFollowWnd, getMouseFollowWindow, setMouseFollowWindow,    \
+    _T ("Miscellaneous"), _T ("MouseFollowWindow"), _T ("Value"), false, 0, 1)                   \
+  X(MOUSE_FOLLOW_ONLY_IN, SettingBool, m_bMouseFollowOnlyWhenIn, getMouseFollowOnlyWhenIn,       \
+    setMouseFollowOnlyWhenIn, _T ("Miscellaneous"), _T ("MouseFollowWindowOnlyWhenIn"),          \
+    _T ("Value"), true, 0, 1)                                                                    \
+  X(MIN_MAX_CYCLE, SettingBool, m_bMinMaxCycle, getMinMaxCycle, setMinMaxCycle,                  \
+    _T ("Miscellaneous"), _T ("MinMaxCycle"), _T ("Value"), false, 0, 1)                         \
+  X(ANIMATE_SNAP, SettingBool, m_bAnimateSnap, getAnimateSnap, setAnimateSnap,                   \
+    _T ("Miscellaneous"), _T ("AnimateSnap"), _T ("Value"), false, 0, 1)                         \
+  /* TILING_ALGORITHM (tiling.h) */                                                             \
+  X(TILING_ALGORITHM, SettingInt, m_iTilingAlgorithm, getTilingAlgorithm, setTilingAlgorithm,    \
+    _T ("Miscellaneous"), _T ("TilingAlgorithm"), _T ("Value"), 0, 0, 2)                         \
+  X(TILING_GAP, SettingInt, m_iTilingGap, getTilingGap, setTilingGap, _T ("Miscellaneous"),      \
+    _T ("TilingGap"), _T ("Value"), 0, 0, 50)
+
+#endif // __SETTINGS_SCHEMA_H__
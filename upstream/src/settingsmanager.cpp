@@ -1,26 +1,125 @@
 #include "settingsmanager.h"
 
+#include "config_store.h"
 #include "main.h"
 #include "virtual_key_manager.h"
 
 #include <clocale>
-#include <algorithm>  // for std::clamp (C++17) or manual clamp
 
-// Security: Helper to clamp integer values to safe ranges
-namespace {
-  template<typename T>
-  T clampValue(long value, T minVal, T maxVal) {
-    if (value < static_cast<long>(minVal)) return minVal;
-    if (value > static_cast<long>(maxVal)) return maxVal;
-    return static_cast<T>(value);
-  }
-}
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/msgdlg.h>
 #include <wx/msw/registry.h>
 #include <wx/stdpaths.h>
 
+using namespace std;
+
+namespace {
+  // <Element Attribute="..."/>. "Value" is also read from <Element>...</Element> (Settings.xml
+  // of former versions).
+  bool ReadAttribute(const wxXmlNode* node, const wxString& name, wxString& text)
+  {
+    if (node->GetAttribute(name, &text))
+      return true;
+    if (name != _T ("Value") || node->GetAttributes())
+      return false;
+
+    text = node->GetNodeContent();
+    return !text.IsEmpty();
+  }
+
+  // The child element 'name' of 'parent', added at the end if missing
+  wxXmlNode* GetChild(wxXmlNode* parent, const wxString& name)
+  {
+    wxXmlNode* last = NULL;
+    for (wxXmlNode* node = parent->GetChildren(); node; node = node->GetNext()) {
+      if (node->GetName() == name)
+        return node;
+      last = node;
+    }
+
+    wxXmlNode* child = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, name);
+    if (last)
+      last->SetNext(child);
+    else
+      parent->AddChild(child);
+    return child;
+  }
+
+  // Settings.xml of former versions stored <Opacity> as 0..255. The options are percents now.
+  int OpacityToPercent(long opacity)
+  {
+    if (opacity < 0)
+      opacity = 0;
+    else if (opacity > 255)
+      opacity = 255;
+    return int((opacity * 100 + 127) / 255);
+  }
+}
+
+wxString SettingBool::ToString(Type value)
+{
+  return value ? _T ("True") : _T ("False");
+}
+
+bool SettingBool::FromString(const wxString& text, Type& value)
+{
+  value = text == _T ("True") || text == _T ("1");
+  return true;
+}
+
+wxString SettingInt::ToString(Type value)
+{
+  return wxString::Format(_T ("%d"), value);
+}
+
+bool SettingInt::FromString(const wxString& text, Type& value)
+{
+  long l;
+  if (!text.ToLong(&l))
+    return false;
+
+  value = Type(l);
+  return true;
+}
+
+wxString SettingTime::ToString(Type value)
+{
+  // time_t is 64 bits, long 32 bits
+  return wxString::Format(_T ("%lld"), (long long)value);
+}
+
+bool SettingTime::FromString(const wxString& text, Type& value)
+{
+  wxLongLong_t l;
+  if (!text.ToLongLong(&l))
+    return false;
+
+  value = Type(l);
+  return true;
+}
+
+wxString SettingColour::ToString(const Type& value)
+{
+  return value.GetAsString(wxC2S_HTML_SYNTAX);
+}
+
+bool SettingColour::FromString(const wxString& text, Type& value)
+{
+  return value.Set(text);
+}
+
+wxString SettingModifier::ToString(Type value)
+{
+  return VirtualModifierManager().GetStringFromValue(value);
+}
+
+bool SettingModifier::FromString(const wxString& text, Type& value)
+{
+  value = VirtualModifierManager().GetValueFromString(text);
+  return true;
+}
+
 // Definition of the "singleton" object
 SettingsManager* SettingsManager::m_instance = NULL;
 
@@ -84,6 +183,8 @@ SettingsManager::SettingsManager()
   m_bInitialized = false;
   m_bPortableMode = false;
   m_bIsModified = false;
+  m_bSystemSettingsRead = false;
+  m_iNextListener = 0;
 }
 
 SettingsManager::~SettingsManager()
@@ -120,10 +221,8 @@ wxString SettingsManager::getUserName()
 
 void SettingsManager::Kill()
 {
-  if (m_instance != NULL) {
-    if (m_instance->m_bIsModified)
-      m_instance->SaveSettings();
-  }
+  if (m_instance != NULL)
+    m_instance->SaveIfModified();
   delete m_instance;
   m_instance = NULL;
 }
@@ -138,102 +237,11 @@ wxString SettingsManager::getAppPath()
   return m_sAppPath;
 }
 
-bool SettingsManager::getSaveNumpadPosOnExit()
-{
-  return m_bVN_SavePosOnExit;
-}
-
-void SettingsManager::setSaveNumpadPosOnExit(bool save)
-{
-  if (save != m_bVN_SavePosOnExit) {
-    m_bVN_SavePosOnExit = save;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getShowNumpadAtBoot()
-{
-  return m_bVN_ShownAtBoot;
-}
-
-void SettingsManager::setShowNumpadAtBoot(bool show)
-{
-  if (show != m_bVN_ShownAtBoot) {
-    m_bVN_ShownAtBoot = show;
-    m_bIsModified = true;
-  }
-}
-
 bool SettingsManager::IsPortable()
 {
   return m_bPortableMode;
 }
 
-bool SettingsManager::AcceptTopMostWindows()
-{
-  return m_bAcceptTopmostWindows;
-}
-
-void SettingsManager::setAcceptTopMostWindows(bool do_it)
-{
-  if (do_it != m_bAcceptTopmostWindows) {
-    m_bAcceptTopmostWindows = do_it;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::hasToShowHotkeysWarnings()
-{
-  return m_bShowHKWarnings;
-}
-
-void SettingsManager::setShowHotkeysWarnings(bool show)
-{
-  if (show != m_bShowHKWarnings) {
-    m_bShowHKWarnings = show;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::hasToCheckForUpdates()
-{
-  return m_bCheckForUpdates;
-}
-
-void SettingsManager::setCheckForUpdates(bool check)
-{
-  if (check != m_bCheckForUpdates) {
-    m_bCheckForUpdates = check;
-    m_bIsModified = true;
-  }
-}
-
-time_t SettingsManager::getLastCheckDate()
-{
-  return m_tLastUpdateCheck;
-}
-
-void SettingsManager::setLastCheckDate(time_t lastdate)
-{
-  if (lastdate != m_tLastUpdateCheck) {
-    m_tLastUpdateCheck = lastdate;
-    m_bIsModified = true;
-  }
-}
-
-int SettingsManager::getUpdateCheckFrequency()
-{
-  return m_iUpdateCheckFrequency;
-}
-
-void SettingsManager::setUpdateCheckFrequency(int freqIndex)
-{
-  if (freqIndex != m_iUpdateCheckFrequency) {
-    m_iUpdateCheckFrequency = freqIndex;
-    m_bIsModified = true;
-  }
-}
-
 int SettingsManager::getLanguageIndex()
 {
   return m_iLanguage;
@@ -245,6 +253,11 @@ void SettingsManager::setLanguageIndex(int index)
     wxMessageBox(_("Language non supported in WinSplit !"), _("Error"), wxICON_ERROR);
     return;
   }
+  if (!m_bInitialized) {
+    // Initialize() loads the locale once the settings are read
+    m_iLanguage = index;
+    return;
+  }
   if (index != m_iLanguage) {
     if (!m_locale.Init(AvailableLangIds[index])) {
       wxMessageBox(_T ("Unable to initialize language !"), _("Error"), wxICON_ERROR);
@@ -258,70 +271,6 @@ void SettingsManager::setLanguageIndex(int index)
   setlocale(LC_NUMERIC, "C");
 }
 
-void SettingsManager::setAutoDeleteTempFiles(bool del)
-{
-  m_bAutoDelTmpFiles = del;
-}
-
-bool SettingsManager::getAutoDeleteTempFiles()
-{
-  return m_bAutoDelTmpFiles;
-}
-
-void SettingsManager::setAutoDeleteTime(int value)
-{
-  /*
-   * the variable can have the following values:
-   * 0 = delete files when WinSplit starts
-   * 1 = delete files when WinSplit finishes
-   */
-  m_iAutoDelTime = value;
-}
-
-int SettingsManager::getAutoDeleteTime()
-{
-  return m_iAutoDelTime;
-}
-
-int SettingsManager::getNumpadTransparency()
-{
-  return m_iVN_Transparency;
-}
-
-void SettingsManager::setNumpadTransparency(int value)
-{
-  if (value != m_iVN_Transparency) {
-    m_iVN_Transparency = value;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getNumpadStyle()
-{
-  return m_bVN_Reduced;
-}
-
-void SettingsManager::setNumpadStyle(bool reduced)
-{
-  if (reduced != m_bVN_Reduced) {
-    m_bVN_Reduced = reduced;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getNumpadAutoHide()
-{
-  return m_bVN_AutoHide;
-}
-
-void SettingsManager::setNumpadAutoHide(bool autoHide)
-{
-  if (autoHide != m_bVN_AutoHide) {
-    m_bVN_AutoHide = autoHide;
-    m_bIsModified = true;
-  }
-}
-
 wxPoint SettingsManager::getNumpadPosition()
 {
   return wxPoint(m_iVN_PosX, m_iVN_PosY);
@@ -329,150 +278,106 @@ wxPoint SettingsManager::getNumpadPosition()
 
 void SettingsManager::setNumpadPosition(wxPoint pos)
 {
-  if ((pos.x != m_iVN_PosX) || (pos.y != m_iVN_PosY)) {
-    m_iVN_PosX = pos.x;
-    m_iVN_PosY = pos.y;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::IsDragNGoEnabled()
-{
-  return m_bDNG_Enabled;
-}
-
-void SettingsManager::EnableDragNGo(bool enable)
-{
-  if (enable != m_bDNG_Enabled) {
-    m_bDNG_Enabled = enable;
-    m_bIsModified = true;
-  }
-}
-
-int SettingsManager::getDnGTimerFrequency()
-{
-  return m_iDNG_timer;
-}
-
-void SettingsManager::setDnGTimerFrequency(int freq)
-{
-  if (freq != m_iDNG_timer) {
-    m_iDNG_timer = freq;
-    m_bIsModified = true;
-  }
-}
-
-int SettingsManager::getDnGDetectionRadius()
-{
-  return m_iDNG_Radius;
+  setNumpadPosX(pos.x);
+  setNumpadPosY(pos.y);
 }
 
-void SettingsManager::setDnGDetectionRadius(int radius)
-{
-  if (radius != m_iDNG_Radius) {
-    m_iDNG_Radius = radius;
-    m_bIsModified = true;
+// The setters of the schema: a change is saved later, and announced now
+#define SETTING_SETTER(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,              \
+                       DEFAULT, MIN, MAX)                                                          \
+  void SettingsManager::SETTER(KIND::Type value)                                                   \
+  {                                                                                                \
+    value = KIND::Clamp(value, MIN, MAX);                                                          \
+    if (value != MEMBER) {                                                                         \
+      MEMBER = value;                                                                              \
+      m_bIsModified = true;                                                                        \
+      Notify(SETTING_##ID);                                                                        \
+    }                                                                                              \
   }
-}
+SETTINGS_SCHEMA(SETTING_SETTER)
+#undef SETTING_SETTER
 
-wxColour SettingsManager::getDnGZoneBgColor()
+unsigned int SettingsManager::Subscribe(const SettingListener& listener)
 {
-  return m_cDNG_BgColor;
+  m_listeners.push_back(make_pair(++m_iNextListener, listener));
+  return m_iNextListener;
 }
 
-void SettingsManager::setDnGZoneBgColor(wxColour col)
+void SettingsManager::Unsubscribe(unsigned int id)
 {
-  if (col != m_cDNG_BgColor) {
-    m_cDNG_BgColor = col;
-    m_bIsModified = true;
+  for (size_t i = 0; i < m_listeners.size(); ++i) {
+    if (m_listeners[i].first == id) {
+      m_listeners.erase(m_listeners.begin() + i);
+      return;
+    }
   }
 }
 
-wxColour SettingsManager::getDnGZoneFgColor()
-{
-  return m_cDNG_FgColor;
-}
-
-void SettingsManager::setDnGZoneFgColor(wxColour col)
+void SettingsManager::Notify(SETTING_ID setting)
 {
-  if (col != m_cDNG_FgColor) {
-    m_cDNG_FgColor = col;
-    m_bIsModified = true;
-  }
-}
+  // A listener may subscribe or unsubscribe from its call
+  vector<pair<unsigned int, SettingListener>> listeners(m_listeners);
 
-int SettingsManager::getDngZoneTransparency()
-{
-  return m_iDNG_Transparency;
+  for (size_t i = 0; i < listeners.size(); ++i)
+    listeners[i].second(setting);
 }
 
-void SettingsManager::setDnGZoneTransparency(int value)
+// Helper: safely read UserPreferencesMask from HKCU\Control Panel\Desktop.
+// Returns false if the value doesn't exist or can't be read.
+static bool ReadUserPreferencesMask(wxMemoryBuffer& mBuff)
 {
-  if (value != m_iDNG_Transparency) {
-    m_iDNG_Transparency = value;
-    m_bIsModified = true;
-  }
+  wxLogNull suppressErrors;
+  wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
+  if (!rKey.Exists() || !rKey.HasValue(_T ("UserPreferencesMask")))
+    return false;
+  return rKey.QueryValue(_T ("UserPreferencesMask"), mBuff) && mBuff.GetDataLen() > 0;
 }
 
-void SettingsManager::setDnGMod1(int value)
+// The three Windows settings below are read once and cached: the registry is read again
+// only after a WM_SETTINGCHANGE (InvalidateSystemSettings)
+void SettingsManager::RefreshSystemSettings()
 {
-  if (value != (int)m_modDNG1) {
-    m_modDNG1 = value;
-    m_bIsModified = true;
-  }
-}
+  long lVal;
+  wxMemoryBuffer mBuff;
+  bool hasMask = ReadUserPreferencesMask(mBuff);
+  char c = hasMask ? *(char*)(mBuff.GetData()) : 0;
 
-void SettingsManager::setDnGMod2(int value)
-{
-  if (value != (int)m_modDNG2) {
-    m_modDNG2 = value;
-    m_bIsModified = true;
+  m_bXMouse = ((c & 1) == 1);
+  wxRegKey mouseKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Mouse"));
+  if (mouseKey.HasValue(_T ("ActiveWindowTracking"))) {
+    if (mouseKey.QueryValue(_T ("ActiveWindowTracking"), &lVal))
+      m_bXMouse = lVal != 0;
   }
-}
 
-unsigned int SettingsManager::getDnGMod1()
-{
-  return m_modDNG1;
-}
+  m_bAutoZOrder = ((c & 0x40) == 0x40);
 
-unsigned int SettingsManager::getDnGMod2()
-{
-  return m_modDNG2;
-}
+  wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
+  lVal = 0;
+  if (rKey.HasValue(_T ("ActiveWndTrackTimeout")))
+    rKey.QueryValue(_T ("ActiveWndTrackTimeout"), &lVal);
+  else if (rKey.HasValue(_T ("ActiveWndTrkTimeout")))
+    rKey.QueryValue(_T ("ActiveWndTrkTimeout"), &lVal);
+  m_iAutoZOrderDelay = (int)lVal;
 
-void SettingsManager::setDnGMod1(const unsigned int& mod)
-{
-  if (mod != m_modDNG1) {
-    m_modDNG1 = mod;
-    m_bIsModified = true;
-  }
+  m_bSystemSettingsRead = true;
 }
 
-void SettingsManager::setDnGMod2(const unsigned int& mod)
+void SettingsManager::InvalidateSystemSettings()
 {
-  if (mod != m_modDNG2) {
-    m_modDNG2 = mod;
-    m_bIsModified = true;
-  }
-}
-
-// Helper: safely read UserPreferencesMask from HKCU\Control Panel\Desktop.
-// Returns false if the value doesn't exist or can't be read.
-static bool ReadUserPreferencesMask(wxMemoryBuffer& mBuff)
-{
-  wxLogNull suppressErrors;
-  wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
-  if (!rKey.Exists() || !rKey.HasValue(_T ("UserPreferencesMask")))
-    return false;
-  return rKey.QueryValue(_T ("UserPreferencesMask"), mBuff) && mBuff.GetDataLen() > 0;
+  m_bSystemSettingsRead = false;
 }
 
 void SettingsManager::setXMouseActivation(bool enable)
 {
+  if (enable == IsXMouseActivated())
+    return;
+
+  // The cache only takes what the registry got
   long lVal = (enable) ? 1 : 0;
   wxRegKey mouseKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Mouse"));
   if (mouseKey.HasValue(_T ("ActiveWindowTracking"))) {
-    mouseKey.SetValue(_T ("ActiveWindowTracking"), lVal);
+    if (mouseKey.SetValue(_T ("ActiveWindowTracking"), lVal))
+      m_bXMouse = enable;
     return;
   }
 
@@ -486,27 +391,23 @@ void SettingsManager::setXMouseActivation(bool enable)
     c &= 0xfe;
   *(unsigned char*)(mBuff.GetData()) = c;
   wxRegKey desktopKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
-  desktopKey.SetValue(_T ("UserPreferencesMask"), mBuff);
+  if (desktopKey.SetValue(_T ("UserPreferencesMask"), mBuff))
+    m_bXMouse = enable;
 }
 
 bool SettingsManager::IsXMouseActivated()
 {
-  long lVal;
-  wxRegKey mouseKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Mouse"));
-  if (mouseKey.HasValue(_T ("ActiveWindowTracking"))) {
-    if (mouseKey.QueryValue(_T ("ActiveWindowTracking"), &lVal))
-      return lVal != 0;
-  }
-
-  wxMemoryBuffer mBuff;
-  if (!ReadUserPreferencesMask(mBuff))
-    return false;
-  char c = *(char*)(mBuff.GetData());
-  return ((c & 1) == 1);
+  if (!m_bSystemSettingsRead)
+    RefreshSystemSettings();
+  return m_bXMouse;
 }
 
 void SettingsManager::setAutoZOrderActivation(bool enable)
 {
+  if (enable == IsAutoZOrderActivated())
+    return;
+
+  // The cache only takes what the registry got
   wxMemoryBuffer mBuff;
   if (!ReadUserPreferencesMask(mBuff))
     return;
@@ -517,20 +418,23 @@ void SettingsManager::setAutoZOrderActivation(bool enable)
     c &= 0xbf;
   *(unsigned char*)(mBuff.GetData()) = c;
   wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
-  rKey.SetValue(_T ("UserPreferencesMask"), mBuff);
+  if (rKey.SetValue(_T ("UserPreferencesMask"), mBuff))
+    m_bAutoZOrder = enable;
 }
 
 bool SettingsManager::IsAutoZOrderActivated()
 {
-  wxMemoryBuffer mBuff;
-  if (!ReadUserPreferencesMask(mBuff))
-    return false;
-  char c = *(char*)(mBuff.GetData());
-  return ((c & 0x40) == 0x40);
+  if (!m_bSystemSettingsRead)
+    RefreshSystemSettings();
+  return m_bAutoZOrder;
 }
 
 void SettingsManager::setAutoZOrderDelay(int value)
 {
+  if (value == getAutoZOrderDelay())
+    return;
+  m_iAutoZOrderDelay = value;
+
   wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
   if (rKey.HasValue(_T ("ActiveWndTrackTimeout")))
     rKey.SetValue(_T ("ActiveWndTrackTimeout"), (long)value);
@@ -540,52 +444,9 @@ void SettingsManager::setAutoZOrderDelay(int value)
 
 int SettingsManager::getAutoZOrderDelay()
 {
-  wxRegKey rKey(_T ("HKEY_CURRENT_USER\\Control Panel\\Desktop"));
-  long lVal = 0;
-  if (rKey.HasValue(_T ("ActiveWndTrackTimeout")))
-    rKey.QueryValue(_T ("ActiveWndTrackTimeout"), &lVal);
-  else if (rKey.HasValue(_T ("ActiveWndTrkTimeout")))
-    rKey.QueryValue(_T ("ActiveWndTrkTimeout"), &lVal);
-  return (int)lVal;
-}
-
-void SettingsManager::setMouseFollowWindow(bool value)
-{
-  if (value != m_bMouseFollowWnd) {
-    m_bMouseFollowWnd = value;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getMouseFollowWindow()
-{
-  return m_bMouseFollowWnd;
-}
-
-void SettingsManager::setMouseFollowOnlyWhenIn(bool value)
-{
-  if (value != m_bMouseFollowOnlyWhenIn) {
-    m_bMouseFollowOnlyWhenIn = value;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getMouseFollowOnlyWhenIn()
-{
-  return m_bMouseFollowOnlyWhenIn;
-}
-
-void SettingsManager::setMinMaxCycle(bool value)
-{
-  if (value != m_bMinMaxCycle) {
-    m_bMinMaxCycle = value;
-    m_bIsModified = true;
-  }
-}
-
-bool SettingsManager::getMinMaxCycle()
-{
-  return m_bMinMaxCycle;
+  if (!m_bSystemSettingsRead)
+    RefreshSystemSettings();
+  return m_iAutoZOrderDelay;
 }
 
 void SettingsManager::Initialize()
@@ -603,9 +464,14 @@ void SettingsManager::Initialize()
 
   // Set working directory to the directory of the application
   wxSetWorkingDirectory(m_sAppPath);
-  // Check if settings file exists in the application directory. If it is, we are in portable mode.
-  FName.SetFullName(_T ("Settings.xml"));
+  // Check if a settings file exists in the application directory. If it is, we are in portable
+  // mode (Settings.xml: not migrated yet)
+  FName.SetFullName(_T ("WinSplit.xml"));
   m_bPortableMode = FName.FileExists();
+  if (!m_bPortableMode) {
+    FName.SetFullName(_T ("Settings.xml"));
+    m_bPortableMode = FName.FileExists();
+  }
 
   if (!m_bPortableMode) {
     // We are in "Classic" mode
@@ -616,572 +482,214 @@ void SettingsManager::Initialize()
   }
   m_sUserDataDir = FName.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
 
-  // Default values of variables
-  // Warn about errors with Hotkeys
-  m_bShowHKWarnings = true;
-  // Update checking uses secure HTTPS via GitHub Releases API
-  m_bCheckForUpdates = true;
-  m_iUpdateCheckFrequency = CHECK_UPDATES_ON_START;
+  // Default values of the settings of the schema
+#define SETTING_DEFAULT(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,             \
+                        DEFAULT, MIN, MAX)                                                         \
+  MEMBER = KIND::FromDefault(DEFAULT);
+  SETTINGS_SCHEMA(SETTING_DEFAULT)
+#undef SETTING_DEFAULT
+  // The first update check is one period after the first run
+  m_tLastUpdateCheck = time(NULL);
+
   // Default language = system language
   m_iLanguage = wxLANGUAGE_DEFAULT;
   // The path where the language files are located
   wxLocale::AddCatalogLookupPathPrefix(m_sAppPath + _T ("languages"));
 
-  // Initialize the variable wxLocale with the default language of the system
-  // Defaults to English if the language is not supported by wxWidgets so just ignore errors
-  m_locale.Init(wxLANGUAGE_DEFAULT);
-
-  m_locale.AddCatalog(_T ("winsplit"));
   // Check if the system language corresponds to a language supported by Winsplit
+  int iSystemLanguage = wxLocale::GetSystemLanguage();
   int iCount = GetAvailableLanguagesCount();
   for (int i = 0; i < iCount; i++) {
-    if (AvailableLangIds[i] == m_locale.GetLanguage()) {
+    if (AvailableLangIds[i] == iSystemLanguage) {
       m_iLanguage = i;
       break;
     }
   }
+  int iDefaultLanguage = m_iLanguage;
+
+  // Read the whole configuration once (or migrate the former files), then the options.
+  // setLanguageIndex only records the saved language until m_bInitialized.
+  ConfigStore::GetInstance()->Load(m_sUserDataDir);
+  LoadSettings();
+
+  // The locale and its catalog are loaded once: the saved language, or the language of the
+  // system (English if wxWidgets does not support it, so just ignore errors)
+  if (m_iLanguage == iDefaultLanguage || !m_locale.Init(AvailableLangIds[m_iLanguage]))
+    m_locale.Init(wxLANGUAGE_DEFAULT);
+  m_locale.AddCatalog(_T ("winsplit"));
 
   // Use decimal numeric separators
   setlocale(LC_NUMERIC, "C");
-  // Behaviour of temporary screen shot files
-  m_bAutoDelTmpFiles = true; // Auto delete
-  m_iAutoDelTime = 0;        // Supress winsplit start up
-  // Position, style, behaviour and transparency of Virtual Numpad
-  m_iVN_Transparency = 65;
-  m_iVN_PosX = 640;
-  m_iVN_PosY = 480;
-  m_bVN_Reduced = false;
-  m_bVN_AutoHide = false;
-  m_bVN_ShownAtBoot = false;
-  m_bVN_SavePosOnExit = true;
-  // Do not take into account the "TopMost" windows
-  m_bAcceptTopmostWindows = false;
-  m_tLastUpdateCheck = time(NULL);
-
-  // Drag'N'Go settings
-  m_bDNG_Enabled = true;
-  m_iDNG_Radius = 100;
-  m_iDNG_timer = 100;
-  m_cDNG_BgColor = wxColour(65, 105, 225);
-  m_cDNG_FgColor = *wxWHITE;
-  m_iDNG_Transparency = 45;
-  m_modDNG1 = 0x02; // MOD_CONTROL
-  m_modDNG2 = 0x01; // MOD_ALT
-
-  // By default, activate the option "Mouse follows window"
-  m_bMouseFollowWnd = false;
-  // By default the mouse only follows the window if it is in its client area
-  m_bMouseFollowOnlyWhenIn = true;
-  // By default, the "Minimize" and "Maximize" Hotkeys keep their classic operation
-  m_bMinMaxCycle = false;
-
-  // Try to read the options from the xml file
-  LoadSettings();
 
   m_bInitialized = true;
 }
 
 void SettingsManager::LoadSettings()
 {
-  // The name of the file containing the settings
-  wxFileName fname(m_sUserDataDir + _T ("Settings.xml"));
-  // If the settings file does not exist
-  if (!fname.FileExists()) {
-    // make sure that Winsplit creates it and declare the default settings as having been modified
+  // The settings section of the configuration store, already in memory
+  const wxXmlNode* section = ConfigStore::GetInstance()->GetSection(CONFIG_SETTINGS);
+  // If the settings were never saved
+  if (!section) {
+    // make sure that Winsplit saves them and declare the default settings as having been modified
     m_bIsModified = true;
     return;
   }
 
-  wxXmlDocument doc;
-  wxXmlNode* node;
-  wxString sValue;
-
-  // Try to load the file containing the settings
-  doc.Load(fname.GetFullPath());
-  if (!doc.IsOk()) {
-    // If there was an error loading, we make sure that settings are rewritten
-    m_bIsModified = true;
-    return;
-  }
+  // Through the setters: the values are clamped, and a reload notifies what changed
+  for (const wxXmlNode* container = section->GetChildren(); container;
+       container = container->GetNext()) {
+    wxString sectionName = container->GetName();
 
-  node = doc.GetRoot()->GetChildren();
-  while (node) {
-    wxString sectionName = node->GetName();
+    // Section names of former versions
+    if (sectionName == _T ("Numpad"))
+      sectionName = _T ("VirtualNumpad");
+    else if (sectionName == _T ("WebUpdates"))
+      sectionName = _T ("WebUpdate");
+    else if (sectionName == _T ("DragAndGo"))
+      sectionName = _T ("Drag_N_Go");
 
-    if (sectionName == _T ("General")) {
-      ReadGeneralSettings(node);
-    }
-    else if (sectionName == _T ("VirtualNumpad") || sectionName == _T ("Numpad")) {
-      ReadPopupSettings(node);
+    for (const wxXmlNode* node = container->GetChildren(); node; node = node->GetNext()) {
+      ReadSetting(sectionName, node);
+      ReadOtherSetting(sectionName, node);
     }
-    else if (sectionName == _T ("WebUpdate") || sectionName == _T ("WebUpdates")) {
-      ReadWebUpdateSettings(node);
-    }
-    else if (sectionName == _T ("Drag_N_Go") || sectionName == _T ("DragAndGo")) {
-      ReadDragNGoSettings(node);
-    }
-    else if (sectionName == _T ("Miscellaneous")) {
-      ReadMiscSettings(node);
-    }
-
-    node = node->GetNext();
   }
   m_bIsModified = false;
 }
 
 void SettingsManager::SaveSettings()
 {
-  wxXmlDocument doc;
-  wxXmlNode *node, *root;
-  wxXmlAttribute* prop;
-
-  root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WinSplit_Settings"));
-  prop = new wxXmlAttribute(_T ("Version"), _T ("1.0"));
-  root->SetAttributes(prop);
-
-  root->AddChild(node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("General")));
-  SaveGeneralSettings(node);
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("VirtualNumpad")));
-  node = node->GetNext();
-  SavePopupSettings(node);
+  wxXmlNode* root = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WinSplit_Settings"));
+  root->AddAttribute(_T ("Version"), _T ("1.0"));
 
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("WebUpdate")));
-  node = node->GetNext();
-  SaveWebUpdateSettings(node);
+  // Sections and elements in the order of the schema
+#define SETTING_SAVE(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,                \
+                     DEFAULT, MIN, MAX)                                                            \
+  GetChild(GetChild(root, SECTION), ELEMENT)->AddAttribute(ATTRIBUTE, KIND::ToString(MEMBER));
+  SETTINGS_SCHEMA(SETTING_SAVE)
+#undef SETTING_SAVE
 
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Drag_N_Go")));
-  node = node->GetNext();
-  SaveDragNGoSettings(node);
+  GetChild(GetChild(root, _T ("General")), _T ("Language"))
+      ->AddAttribute(_T ("Value"), wxString::Format(_T ("%d"), m_iLanguage));
 
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Miscellaneous")));
-  node = node->GetNext();
-  SaveMiscSettings(node);
-
-  wxFileName fname(m_sUserDataDir + _T ("Settings.xml"));
-  if (fname.FileExists())
-    wxRemoveFile(fname.GetFullPath());
-
-  doc.SetRoot(root);
-  doc.Save(fname.GetFullPath(), 2);
+  ConfigStore::GetInstance()->SetSection(CONFIG_SETTINGS, root);
 }
 
-void SettingsManager::ReadGeneralSettings(wxXmlNode* container)
+void SettingsManager::SaveIfModified()
 {
-  wxXmlNode* node = container->GetChildren();
-  wxString nodName, sValue;
-  long l;
-
-  // Helper to safely get node value (supports both attribute and text content formats)
-  auto getNodeValue = [](wxXmlNode* n) -> wxString {
-    // First try attribute format: <Node Value="x"/>
-    if (n->GetAttributes()) {
-      return n->GetAttributes()->GetValue();
-    }
-    // Fall back to text content format: <Node>x</Node>
-    return n->GetNodeContent();
-  };
-
-  while (node) {
-    nodName = node->GetName();
-
-    if (nodName == _T ("AcceptTopMostWindow")) {
-      m_bAcceptTopmostWindows = (getNodeValue(node) == _T ("True") || getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("ShowHotKeysWarnings")) {
-      m_bShowHKWarnings = (getNodeValue(node) == _T ("True") || getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("Language")) {
-      if (getNodeValue(node).ToLong(&l)) {
-        // Security: Validate language index is within bounds
-        if (l >= 0 && l < GetAvailableLanguagesCount()) {
-          setLanguageIndex(static_cast<int>(l));
-        }
-      }
-    }
-    else if (nodName == _T ("TempFiles")) {
-      if (node->GetAttribute(_T ("AutoDelete"), &sValue)) {
-        m_bAutoDelTmpFiles = (sValue == _T ("True"));
-      }
-      if (node->GetAttribute(_T ("AutoDelTime"), &sValue)) {
-        sValue.ToLong(&l);
-        m_iAutoDelTime = int(l);
-      }
-    }
-    // Handle Settings.xml format with different node names
-    else if (nodName == _T ("TopmostWindows")) {
-      m_bAcceptTopmostWindows = (getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("CheckForUpdates")) {
-      m_bCheckForUpdates = (getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("UpdateCheckFrequency")) {
-      if (getNodeValue(node).ToLong(&l)) {
-        m_iUpdateCheckFrequency = static_cast<int>(l);
-      }
-    }
-    else if (nodName == _T ("DeleteScreenshotsAtStart")) {
-      if (getNodeValue(node) == _T ("1")) {
-        m_bAutoDelTmpFiles = true;
-        m_iAutoDelTime = 0;
-      }
-    }
-    else if (nodName == _T ("DeleteScreenshotsAtEnd")) {
-      if (getNodeValue(node) == _T ("1")) {
-        m_bAutoDelTmpFiles = true;
-        m_iAutoDelTime = 1;
-      }
-    }
-
-    node = node->GetNext();
+  if (m_bIsModified) {
+    SaveSettings();
+    m_bIsModified = false;
   }
 }
 
-void SettingsManager::SaveGeneralSettings(wxXmlNode* container)
-{
-  wxXmlNode* node;
-  container->AddChild(
-      node = new wxXmlNode(
-          NULL,
-          wxXML_ELEMENT_NODE,
-          _T ("AcceptTopMostWindow"),
-          wxEmptyString,
-          new wxXmlAttribute(_T ("Value"), m_bAcceptTopmostWindows ? _T ("True") : _T ("False"))));
-
-  node->SetNext(new wxXmlNode(
-      NULL,
-      wxXML_ELEMENT_NODE,
-      _T ("ShowHotKeysWarnings"),
-      wxEmptyString,
-      new wxXmlAttribute(_T ("Value"), m_bShowHKWarnings ? _T ("True") : _T ("False"))));
-  node = node->GetNext();
-
-  node->SetNext(
-      new wxXmlNode(NULL,
-                    wxXML_ELEMENT_NODE,
-                    _T ("Language"),
-                    wxEmptyString,
-                    new wxXmlAttribute(_T ("Value"), wxString::Format(_T ("%0d"), m_iLanguage))));
-  node = node->GetNext();
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("TempFiles")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("AutoDelete"), m_bAutoDelTmpFiles ? _T ("True") : _T ("False"));
-  node->AddAttribute(_T ("AutoDelTime"), wxString::Format(_T ("%0d"), m_iAutoDelTime));
-}
-
-void SettingsManager::ReadPopupSettings(wxXmlNode* container)
+void SettingsManager::ReadSetting(const wxString& section, const wxXmlNode* node)
 {
-  wxXmlNode* node = container->GetChildren();
-  wxString nodName, sValue;
-  long l;
+  wxString name = node->GetName();
+  wxString text;
 
-  // Helper to safely get node value (supports both attribute and text content formats)
-  auto getNodeValue = [](wxXmlNode* n) -> wxString {
-    if (n->GetAttributes()) return n->GetAttributes()->GetValue();
-    return n->GetNodeContent();
-  };
-
-  while (node) {
-    nodName = node->GetName();
-
-    // Original format with attributes
-    if (nodName == _T ("Position")) {
-      if (node->GetAttribute(_T ("X"), &sValue)) {
-        sValue.ToLong(&l);
-        m_iVN_PosX = clampValue<int>(l, -10000, 10000);
-      }
-      if (node->GetAttribute(_T ("Y"), &sValue)) {
-        sValue.ToLong(&l);
-        m_iVN_PosY = clampValue<int>(l, -10000, 10000);
-      }
-    }
-    else if (nodName == _T ("Style")) {
-      // Could be attribute or text content
-      if (node->GetAttribute(_T ("Reduced"), &sValue)) {
-        m_bVN_Reduced = (sValue == _T ("True"));
-      }
-      if (node->GetAttribute(_T ("Transparency"), &sValue)) {
-        sValue.ToLong(&l);
-        m_iVN_Transparency = clampValue<int>(l, 0, 100);
-      }
-      // Settings.xml format: <Style>1</Style>
-      wxString val = getNodeValue(node);
-      if (!val.IsEmpty() && val.IsNumber()) {
-        val.ToLong(&l);
-        m_bVN_Reduced = (l == 1);
-      }
-    }
-    else if (nodName == _T ("Comportment")) {
-      if (node->GetAttribute(_T ("ShowAtBoot"), &sValue)) {
-        m_bVN_ShownAtBoot = (sValue == _T ("True"));
-      }
-      if (node->GetAttribute(_T ("SaveAtExit"), &sValue)) {
-        m_bVN_SavePosOnExit = (sValue == _T ("True"));
-      }
-      if (node->GetAttribute(_T ("AutoHide"), &sValue)) {
-        m_bVN_AutoHide = (sValue == _T ("True"));
-      }
-    }
-    // Settings.xml format (text content nodes)
-    else if (nodName == _T ("PosX")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iVN_PosX = clampValue<int>(l, -10000, 10000);
-    }
-    else if (nodName == _T ("PosY")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iVN_PosY = clampValue<int>(l, -10000, 10000);
-    }
-    else if (nodName == _T ("Opacity")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iVN_Transparency = clampValue<int>(l, 0, 255);
-    }
-    else if (nodName == _T ("SaveState")) {
-      m_bVN_SavePosOnExit = (getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("ShowAtStartup")) {
-      m_bVN_ShownAtBoot = (getNodeValue(node) == _T ("1"));
-    }
-    else if (nodName == _T ("HideAfterSelection")) {
-      m_bVN_AutoHide = (getNodeValue(node) == _T ("1"));
-    }
-
-    node = node->GetNext();
+#define SETTING_READ(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,                \
+                     DEFAULT, MIN, MAX)                                                            \
+  if (section == SECTION && name == ELEMENT && ReadAttribute(node, ATTRIBUTE, text)) {             \
+    KIND::Type value = KIND::Type();                                                               \
+    if (KIND::FromString(text, value))                                                             \
+      SETTER(value);                                                                               \
   }
+  SETTINGS_SCHEMA(SETTING_READ)
+#undef SETTING_READ
 }
 
-void SettingsManager::SavePopupSettings(wxXmlNode* container)
-{
-  wxXmlNode* node;
-
-  container->AddChild(node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Position")));
-  node->AddAttribute(_T ("X"), wxString::Format(_T ("%0d"), m_iVN_PosX));
-  node->AddAttribute(_T ("Y"), wxString::Format(_T ("%0d"), m_iVN_PosY));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Style")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Reduced"), m_bVN_Reduced ? _T ("True") : _T ("False"));
-  node->AddAttribute(_T ("Transparency"), wxString::Format(_T ("%0d"), m_iVN_Transparency));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Comportment")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("ShowAtBoot"), (m_bVN_ShownAtBoot ? _T ("True") : _T ("False")));
-  node->AddAttribute(_T ("SaveAtExit"), (m_bVN_SavePosOnExit ? _T ("True") : _T ("False")));
-  wxString sTmp = (m_bVN_AutoHide ? _T ("True") : _T ("False"));
-  node->AddAttribute(_T ("AutoHide"), sTmp);
-}
-
-void SettingsManager::ReadWebUpdateSettings(wxXmlNode* container)
+void SettingsManager::ReadOtherSetting(const wxString& section, const wxXmlNode* node)
 {
-  wxXmlNode* node = container->GetChildren();
-  wxString nodName, sValue;
+  wxString name = node->GetName();
+  wxString text;
   long l;
 
-  // Helper to safely get node value (supports both attribute and text content formats)
-  auto getNodeValue = [](wxXmlNode* n) -> wxString {
-    if (n->GetAttributes()) return n->GetAttributes()->GetValue();
-    return n->GetNodeContent();
-  };
-
-  while (node) {
-    nodName = node->GetName();
-    wxString val = getNodeValue(node);
+  if (!ReadAttribute(node, _T ("Value"), text))
+    text = wxEmptyString;
 
-    if (nodName == _T ("AutoCheck")) {
-      m_bCheckForUpdates = (val == _T ("True") || val == _T ("1"));
+  if (section == _T ("General")) {
+    if (name == _T ("Language")) {
+      // Security: Validate language index is within bounds
+      if (text.ToLong(&l) && l >= 0 && l < GetAvailableLanguagesCount())
+        setLanguageIndex(int(l));
     }
-    else if (nodName == _T ("Frequency")) {
-      if (val.ToLong(&l))
-        m_iUpdateCheckFrequency = static_cast<int>(l);
+    // Settings.xml format with different node names
+    else if (name == _T ("TopmostWindows")) {
+      setAcceptTopMostWindows(text == _T ("1"));
     }
-    else if (nodName == _T ("LastCheck")) {
-      if (val.ToLong(&l))
-        m_tLastUpdateCheck = static_cast<time_t>(l);
-    }
-
-    node = node->GetNext();
-  }
-}
-
-void SettingsManager::SaveWebUpdateSettings(wxXmlNode* container)
-{
-  wxXmlNode* node;
-
-  container->AddChild(node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("AutoCheck")));
-  node->AddAttribute(_T ("Value"), m_bCheckForUpdates ? _T ("True") : _T ("False"));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Frequency")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Value"), wxString::Format(_T ("%0d"), m_iUpdateCheckFrequency));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("LastCheck")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Value"), wxString::Format(_T ("%0ld"), m_tLastUpdateCheck));
-}
-
-void SettingsManager::ReadDragNGoSettings(wxXmlNode* container)
-{
-  wxXmlNode* node = container->GetChildren();
-  wxString nodName, sValue;
-  long l;
-  VirtualModifierManager modManager;
-
-  // Helper to safely get node value (supports both attribute and text content formats)
-  auto getNodeValue = [](wxXmlNode* n) -> wxString {
-    if (n->GetAttributes()) return n->GetAttributes()->GetValue();
-    return n->GetNodeContent();
-  };
-
-  while (node) {
-    nodName = node->GetName();
-    if (nodName == _T ("Enabled")) {
-      wxString val = getNodeValue(node);
-      m_bDNG_Enabled = (val == _T ("True") || val == _T ("1"));
+    else if (name == _T ("CheckForUpdates")) {
+      setCheckForUpdates(text == _T ("1"));
     }
-    else if (nodName == _T ("TimerFrequency")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iDNG_timer = clampValue<int>(l, 10, 1000);
+    else if (name == _T ("UpdateCheckFrequency")) {
+      if (text.ToLong(&l))
+        setUpdateCheckFrequency(int(l));
     }
-    else if (nodName == _T ("DetectionRadius")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iDNG_Radius = clampValue<int>(l, 10, 500);
+    else if (name == _T ("DeleteScreenshotsAtStart") || name == _T ("DeleteScreenshotsAtEnd")) {
+      if (text == _T ("1")) {
+        setAutoDeleteTempFiles(true);
+        setAutoDeleteTime(name == _T ("DeleteScreenshotsAtStart") ? 0 : 1);
+      }
     }
-    else if (nodName == _T ("ZoneColors")) {
-      if (node->GetAttribute(_T ("Background"), &sValue))
-        m_cDNG_BgColor.Set(sValue);
-      if (node->GetAttribute(_T ("Foreground"), &sValue))
-        m_cDNG_FgColor.Set(sValue);
+  }
+  else if (section == _T ("VirtualNumpad")) {
+    // Settings.xml format: <Style>1</Style>
+    if (name == _T ("Style")) {
+      if (!text.IsEmpty() && text.IsNumber() && text.ToLong(&l))
+        setNumpadStyle(l == 1);
     }
-    else if (nodName == _T ("Transparency") || nodName == _T ("Opacity")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_iDNG_Transparency = clampValue<int>(l, 0, 255);
+    else if (name == _T ("PosX")) {
+      if (text.ToLong(&l))
+        setNumpadPosX(int(l));
     }
-    else if (nodName == _T ("Modifiers")) {
-      if (node->GetAttribute(_T ("Modifier1"), &sValue))
-        m_modDNG1 = modManager.GetValueFromString(sValue);
-      if (node->GetAttribute(_T ("Modifier2"), &sValue))
-        m_modDNG2 = modManager.GetValueFromString(sValue);
+    else if (name == _T ("PosY")) {
+      if (text.ToLong(&l))
+        setNumpadPosY(int(l));
     }
-    // Handle Settings.xml format
-    else if (nodName == _T ("BackgroundColor")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_cDNG_BgColor.Set(static_cast<unsigned long>(l));
+    else if (name == _T ("Opacity")) {
+      if (text.ToLong(&l))
+        setNumpadTransparency(OpacityToPercent(l));
     }
-    else if (nodName == _T ("TextColor")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_cDNG_FgColor.Set(static_cast<unsigned long>(l));
+    else if (name == _T ("SaveState")) {
+      setSaveNumpadPosOnExit(text == _T ("1"));
     }
-    else if (nodName == _T ("Modifier1")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_modDNG1 = static_cast<int>(l);
+    else if (name == _T ("ShowAtStartup")) {
+      setShowNumpadAtBoot(text == _T ("1"));
     }
-    else if (nodName == _T ("Modifier2")) {
-      if (getNodeValue(node).ToLong(&l))
-        m_modDNG2 = static_cast<int>(l);
+    else if (name == _T ("HideAfterSelection")) {
+      setNumpadAutoHide(text == _T ("1"));
     }
-
-    node = node->GetNext();
   }
-}
-
-void SettingsManager::SaveDragNGoSettings(wxXmlNode* container)
-{
-  wxXmlNode* node;
-  wxString strMod;
-  VirtualModifierManager modManager;
-
-  container->AddChild(node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Enabled")));
-  node->AddAttribute(_T ("Value"), m_bDNG_Enabled ? _T ("True") : _T ("False"));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("TimerFrequency")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Value"), wxString::Format(_T ("%0d"), m_iDNG_timer));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("DetectionRadius")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Value"), wxString::Format(_T ("%0d"), m_iDNG_Radius));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("ZoneColors")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Background"), m_cDNG_BgColor.GetAsString(wxC2S_HTML_SYNTAX));
-  node->AddAttribute(_T ("Foreground"), m_cDNG_FgColor.GetAsString(wxC2S_HTML_SYNTAX));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Transparency")));
-  node = node->GetNext();
-  node->AddAttribute(_T ("Value"), wxString::Format(_T ("%0d"), m_iDNG_Transparency));
-
-  node->SetNext(new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("Modifiers")));
-  node = node->GetNext();
-
-  strMod = modManager.GetStringFromValue(m_modDNG1);
-  node->AddAttribute(_T ("Modifier1"), strMod);
-
-  strMod = modManager.GetStringFromValue(m_modDNG2);
-  node->AddAttribute(_T ("Modifier2"), strMod);
-}
-
-void SettingsManager::ReadMiscSettings(wxXmlNode* container)
-{
-  wxXmlNode* node = container->GetChildren();
-  wxString nodName, sValue;
-  long l;
-
-  // Helper to safely get node value (supports both attribute and text content formats)
-  auto getNodeValue = [](wxXmlNode* n) -> wxString {
-    if (n->GetAttributes()) return n->GetAttributes()->GetValue();
-    return n->GetNodeContent();
-  };
-
-  while (node) {
-    nodName = node->GetName();
-    wxString val = getNodeValue(node);
-
-    if (nodName == _T ("MouseFollowWindow")) {
-      m_bMouseFollowWnd = (val == _T ("True") || val == _T ("1"));
+  else if (section == _T ("Drag_N_Go")) {
+    // Settings.xml format
+    if (name == _T ("Opacity")) {
+      if (text.ToLong(&l))
+        setDnGZoneTransparency(OpacityToPercent(l));
     }
-    else if (nodName == _T ("MouseFollowWindowOnlyWhenIn") || nodName == _T ("MouseFollowOnlyIfOver")) {
-      m_bMouseFollowOnlyWhenIn = (val == _T ("True") || val == _T ("1"));
+    else if (name == _T ("BackgroundColor")) {
+      if (text.ToLong(&l))
+        setDnGZoneBgColor(wxColour(static_cast<unsigned long>(l)));
     }
-    else if (nodName == _T ("MinMaxCycle")) {
-      m_bMinMaxCycle = (val == _T ("True") || val == _T ("1"));
+    else if (name == _T ("TextColor")) {
+      if (text.ToLong(&l))
+        setDnGZoneFgColor(wxColour(static_cast<unsigned long>(l)));
     }
-    // Handle Settings.xml format
-    else if (nodName == _T ("ShowHKWarnings")) {
-      m_bShowHKWarnings = (val == _T ("1"));
+    else if (name == _T ("Modifier1")) {
+      if (text.ToLong(&l))
+        setDnGMod1(static_cast<unsigned int>(l));
     }
-    else if (nodName == _T ("AWT_Enabled")) {
-      // Active Window Tools setting - store if we have a member for it
+    else if (name == _T ("Modifier2")) {
+      if (text.ToLong(&l))
+        setDnGMod2(static_cast<unsigned int>(l));
     }
-    else if (nodName == _T ("AWT_BringToTop")) {
-      // Active Window Tools setting
+  }
+  else if (section == _T ("Miscellaneous")) {
+    // Settings.xml format. AWT_Enabled, AWT_BringToTop and AWT_Delay (Active Window Tools)
+    // are ignored.
+    if (name == _T ("MouseFollowOnlyIfOver")) {
+      setMouseFollowOnlyWhenIn(text == _T ("True") || text == _T ("1"));
     }
-    else if (nodName == _T ("AWT_Delay")) {
-      // Active Window Tools delay
+    else if (name == _T ("ShowHKWarnings")) {
+      setShowHotkeysWarnings(text == _T ("1"));
     }
-
-    node = node->GetNext();
   }
 }
-
-void SettingsManager::SaveMiscSettings(wxXmlNode* container)
-{
-  wxXmlNode* node;
-
-  container->AddChild(node = new wxXmlNode(NULL, wxXML_ELEMENT_NODE, _T ("MouseFollowWindow")));
-  node->AddAttribute(_T ("Value"), m_bMouseFollowWnd ? _T ("True") : _T ("False"));
-
-  node->SetNext(new wxXmlNode(
-      NULL,
-      wxXML_ELEMENT_NODE,
-      _T ("MouseFollowWindowOnlyWhenIn"),
-      wxEmptyString,
-      new wxXmlAttribute(_T ("Value"), m_bMouseFollowOnlyWhenIn ? _T ("True") : _T ("False"))));
-  node = node->GetNext();
-
-  node->SetNext(
-      new wxXmlNode(NULL,
-                    wxXML_ELEMENT_NODE,
-                    _T ("MinMaxCycle"),
-                    wxEmptyString,
-                    new wxXmlAttribute(_T ("Value"), m_bMinMaxCycle ? _T ("True") : _T ("False"))));
-}
@@ -8,8 +8,26 @@
 
 #include <time.h>
 
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "settings_schema.h"
+
 enum { CHECK_UPDATES_ON_START = 1, CHECK_UPDATES_WEEKLY, CHECK_UPDATES_MONTHLY };
 
+// One identifier per setting of the schema: SETTING_ACCEPT_TOPMOST, SETTING_DNG_ZONE_BG...
+enum SETTING_ID {
+#define SETTING_ENUM(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,                \
+                     DEFAULT, MIN, MAX)                                                            \
+  SETTING_##ID,
+  SETTINGS_SCHEMA(SETTING_ENUM)
+#undef SETTING_ENUM
+  NB_SETTINGS
+};
+
+typedef std::function<void(SETTING_ID)> SettingListener;
+
 class SettingsManager {
 public:
   SettingsManager();
@@ -29,56 +47,19 @@ public:
 
   // Accessors
   wxString getAppPath();
+  // The settings of the schema: bool AcceptTopMostWindows(), void setAcceptTopMostWindows(bool)...
+#define SETTING_ACCESSORS(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,           \
+                          DEFAULT, MIN, MAX)                                                       \
+  KIND::Type GETTER() { return MEMBER; }                                                           \
+  void SETTER(KIND::Type value);
+  SETTINGS_SCHEMA(SETTING_ACCESSORS)
+#undef SETTING_ACCESSORS
   // General options
-  bool AcceptTopMostWindows();
-  void setAcceptTopMostWindows(bool do_it);
-  bool hasToShowHotkeysWarnings();
-  void setShowHotkeysWarnings(bool show);
   int getLanguageIndex();
   void setLanguageIndex(int index);
-  void setAutoDeleteTempFiles(bool del);
-  bool getAutoDeleteTempFiles();
-  void setAutoDeleteTime(int value);
-  int getAutoDeleteTime();
   // Virtual Numpad
-  int getNumpadTransparency();
-  void setNumpadTransparency(int value);
-  bool getNumpadStyle(); // Reduced or not
-  void setNumpadStyle(bool reduced);
-  bool getNumpadAutoHide();
-  void setNumpadAutoHide(bool autoHide);
-  bool getSaveNumpadPosOnExit();
-  void setSaveNumpadPosOnExit(bool save);
-  bool getShowNumpadAtBoot();
-  void setShowNumpadAtBoot(bool show);
   wxPoint getNumpadPosition();
   void setNumpadPosition(wxPoint pos);
-  // Web Update
-  bool hasToCheckForUpdates();
-  void setCheckForUpdates(bool check);
-  time_t getLastCheckDate();
-  void setLastCheckDate(time_t lastdate);
-  int getUpdateCheckFrequency();
-  void setUpdateCheckFrequency(int freqIndex);
-  // Drag'N'Go
-  bool IsDragNGoEnabled();
-  void EnableDragNGo(bool enable);
-  int getDnGTimerFrequency();
-  void setDnGTimerFrequency(int freq);
-  int getDnGDetectionRadius();
-  void setDnGDetectionRadius(int radius);
-  wxColour getDnGZoneBgColor();
-  void setDnGZoneBgColor(wxColour col);
-  wxColour getDnGZoneFgColor();
-  void setDnGZoneFgColor(wxColour col);
-  int getDngZoneTransparency();
-  void setDnGZoneTransparency(int value);
-  void setDnGMod1(int value);
-  void setDnGMod2(int value);
-  unsigned int getDnGMod1();
-  unsigned int getDnGMod2();
-  void setDnGMod1(const unsigned int& mod);
-  void setDnGMod2(const unsigned int& mod);
   // Various
   void setXMouseActivation(bool enable);
   bool IsXMouseActivated();
@@ -86,60 +67,49 @@ public:
   bool IsAutoZOrderActivated();
   void setAutoZOrderDelay(int value);
   int getAutoZOrderDelay();
-  void setMouseFollowWindow(bool value);
-  bool getMouseFollowWindow();
-  void setMouseFollowOnlyWhenIn(bool value);
-  bool getMouseFollowOnlyWhenIn();
-  void setMinMaxCycle(bool value);
-  bool getMinMaxCycle();
+  // Read the three settings above from the registry again on next access
+  void InvalidateSystemSettings();
+
+  // Called on the UI thread after a setting of the schema changed, by a setter or a reload.
+  // Returns the id to give to Unsubscribe.
+  unsigned int Subscribe(const SettingListener& listener);
+  void Unsubscribe(unsigned int id);
 
   void Initialize();
   void LoadSettings();
   void SaveSettings();
+  // Save only if a setting changed since the last load or save
+  void SaveIfModified();
   static const wxLanguage AvailableLangIds[];
   static const wxString AvailableLangNames[];
   int GetAvailableLanguagesCount();
 
 protected:
 private:
-  void ReadGeneralSettings(wxXmlNode* container);
-  void SaveGeneralSettings(wxXmlNode* container);
-  void ReadPopupSettings(wxXmlNode* container);
-  void SavePopupSettings(wxXmlNode* container);
-  void ReadWebUpdateSettings(wxXmlNode* container);
-  void SaveWebUpdateSettings(wxXmlNode* container);
-  void ReadDragNGoSettings(wxXmlNode* container);
-  void SaveDragNGoSettings(wxXmlNode* container);
-  void ReadMiscSettings(wxXmlNode* container);
-  void SaveMiscSettings(wxXmlNode* container);
+  // The settings of the schema stored in 'node', a child of 'section'
+  void ReadSetting(const wxString& section, const wxXmlNode* node);
+  // The language, and the element names of the former Settings.xml
+  void ReadOtherSetting(const wxString& section, const wxXmlNode* node);
+  void Notify(SETTING_ID setting);
+  void RefreshSystemSettings();
   wxLocale m_locale;
   wxString m_sAppPath, m_sUserDataDir, m_sUserName;
   bool m_bPortableMode, m_bInitialized, m_bIsModified;
   static SettingsManager* m_instance;
+  std::vector<std::pair<unsigned int, SettingListener>> m_listeners;
+  unsigned int m_iNextListener;
 
-  // General settings
-  bool m_bShowHKWarnings, m_bAcceptTopmostWindows;
+  // Settings of the schema
+#define SETTING_MEMBER(ID, KIND, MEMBER, GETTER, SETTER, SECTION, ELEMENT, ATTRIBUTE,              \
+                       DEFAULT, MIN, MAX)                                                          \
+  KIND::Type MEMBER;
+  SETTINGS_SCHEMA(SETTING_MEMBER)
+#undef SETTING_MEMBER
   int m_iLanguage;
-  bool m_bAutoDelTmpFiles;
-  int m_iAutoDelTime;
-  // VirtualNumpad Settings
-  bool m_bVN_Reduced, m_bVN_AutoHide, m_bVN_ShownAtBoot, m_bVN_SavePosOnExit;
-  int m_iVN_PosX, m_iVN_PosY, m_iVN_Transparency;
-  // WebUpdate Settings
-  bool m_bCheckForUpdates;
-  time_t m_tLastUpdateCheck;
-  int m_iUpdateCheckFrequency;
-  // Drag'N'Go Settings
-  bool m_bDNG_Enabled;
-  int m_iDNG_timer, m_iDNG_Radius;
-  wxColour m_cDNG_BgColor, m_cDNG_FgColor;
-  int m_iDNG_Transparency;
-  unsigned int m_modDNG1;
-  unsigned int m_modDNG2;
-  // Misc Settings
-  bool m_bMouseFollowWnd;
-  bool m_bMouseFollowOnlyWhenIn;
-  bool m_bMinMaxCycle;
+  // Windows settings (registry), cached
+  bool m_bSystemSettingsRead;
+  bool m_bXMouse, m_bAutoZOrder;
+  int m_iAutoZOrderDelay;
 };
 
 #endif // SETTINGSMANAGER_H_INCLUDED
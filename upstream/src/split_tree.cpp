@@ -0,0 +1,120 @@
+#include "split_tree.h"
+
+#include <math.h>
+
+using namespace std;
+
+SplitTree::SplitTree()
+    : m_nodes()
+    , m_windows(0)
+    , m_orientation(SPLIT_SIDE_BY_SIDE)
+{
+}
+
+int SplitTree::Build(size_t begin, size_t count, size_t depth)
+{
+  if (count == 1)
+    return ~int(begin);
+
+  int index = int(m_nodes.size());
+  Node node;
+  node.begin = begin;
+  node.firstCount = count / 2;
+  node.count = count;
+  node.depth = depth;
+  node.ratio = double(node.firstCount) / count;
+  node.first = -1;
+  node.second = -1;
+  m_nodes.push_back(node);
+
+  // Children are added after their parent: no reference kept across the push_back
+  int first = Build(begin, count / 2, depth + 1);
+  int second = Build(begin + count / 2, count - count / 2, depth + 1);
+  m_nodes[index].first = first;
+  m_nodes[index].second = second;
+
+  return index;
+}
+
+void SplitTree::Build(size_t windows)
+{
+  m_nodes.clear();
+  m_windows = windows;
+
+  if (windows > 1) {
+    m_nodes.reserve(windows - 1);
+    Build(0, windows, 0);
+  }
+}
+
+SPLIT_ORIENTATION SplitTree::GetOrientation(size_t split) const
+{
+  if (split >= m_nodes.size() || m_nodes[split].depth % 2 == 0)
+    return m_orientation;
+
+  return m_orientation == SPLIT_SIDE_BY_SIDE ? SPLIT_STACKED : SPLIT_SIDE_BY_SIDE;
+}
+
+double SplitTree::GetRatio(size_t split) const
+{
+  return split < m_nodes.size() ? m_nodes[split].ratio : 0.5;
+}
+
+void SplitTree::SetRatio(size_t split, double ratio)
+{
+  if (split < m_nodes.size())
+    m_nodes[split].ratio = ratio < 0. ? 0. : (ratio > 1. ? 1. : ratio);
+}
+
+void SplitTree::ResetRatio(size_t split)
+{
+  if (split < m_nodes.size())
+    m_nodes[split].ratio = double(m_nodes[split].firstCount) / m_nodes[split].count;
+}
+
+void SplitTree::GetWindows(size_t split, size_t& begin, size_t& firstCount, size_t& count) const
+{
+  if (split >= m_nodes.size()) {
+    begin = 0;
+    firstCount = count = m_windows;
+    return;
+  }
+
+  begin = m_nodes[split].begin;
+  firstCount = m_nodes[split].firstCount;
+  count = m_nodes[split].count;
+}
+
+void SplitTree::Layout(int child, const ScreenRect& area, vector<ScreenRect>& rects) const
+{
+  if (child < 0) {
+    rects[~child] = area;
+    return;
+  }
+
+  const Node& node = m_nodes[child];
+  ScreenRect first = area;
+  ScreenRect second = area;
+
+  if (GetOrientation(child) == SPLIT_SIDE_BY_SIDE) {
+    first.width = int(floor(area.width * node.ratio + 0.5));
+    second.x = area.x + first.width;
+    second.width = area.width - first.width;
+  }
+  else {
+    first.height = int(floor(area.height * node.ratio + 0.5));
+    second.y = area.y + first.height;
+    second.height = area.height - first.height;
+  }
+
+  Layout(node.first, first, rects);
+  Layout(node.second, second, rects);
+}
+
+void SplitTree::Layout(const ScreenRect& area, vector<ScreenRect>& rects) const
+{
+  rects.assign(m_windows, area);
+
+  if (!m_nodes.empty())
+    Layout(0, area, rects);
+}
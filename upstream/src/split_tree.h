@@ -0,0 +1,70 @@
+#ifndef __SPLIT_TREE_H__
+#define __SPLIT_TREE_H__
+
+// Layout of the Fusion function: N windows sharing an area through a tree of splits.
+//
+// Every node cuts its rect in two along a line (side by side or stacked) at a ratio; the
+// leaves are the windows, in order. The tree is built balanced: each node splits its
+// windows in two halves, alternating the orientation with the depth, and its default
+// ratio gives every window the same area. Two windows make a single split, the former
+// Fusion behaviour.
+//
+// This file only depends on the standard library (ScreenRect comes from dpi_move.h),
+// the windows are handled by FusionDialog.
+
+#include "dpi_move.h"
+
+#include <stddef.h>
+#include <vector>
+
+enum SPLIT_ORIENTATION {
+  SPLIT_SIDE_BY_SIDE, // vertical line, first part on the left
+  SPLIT_STACKED       // horizontal line, first part on top
+};
+
+class SplitTree {
+private:
+  struct Node {
+    size_t begin;       // first window below the node
+    size_t firstCount;  // windows in the first part
+    size_t count;       // windows below the node
+    size_t depth;
+    double ratio;       // share of the first part, 0 to 1
+    int first;          // child node, or ~window for a leaf
+    int second;
+  };
+
+  std::vector<Node> m_nodes; // preorder, the root is the first split
+  size_t m_windows;
+  SPLIT_ORIENTATION m_orientation;
+
+  int Build(size_t begin, size_t count, size_t depth);
+  void Layout(int child, const ScreenRect& area, std::vector<ScreenRect>& rects) const;
+
+public:
+  SplitTree();
+
+  // Balanced tree for 'windows' windows, default ratios
+  void Build(size_t windows);
+
+  size_t GetWindowCount() const { return m_windows; }
+  size_t GetSplitCount() const { return m_nodes.size(); }
+
+  // Orientation of the first split, the next levels alternate
+  void SetOrientation(SPLIT_ORIENTATION orientation) { m_orientation = orientation; }
+  SPLIT_ORIENTATION GetOrientation(size_t split) const;
+
+  double GetRatio(size_t split) const;
+  void SetRatio(size_t split, double ratio);
+  // Back to equal areas for the windows on both sides
+  void ResetRatio(size_t split);
+
+  // Windows on each side of a split: [begin, begin + firstCount) and the next ones
+  // up to begin + count
+  void GetWindows(size_t split, size_t& begin, size_t& firstCount, size_t& count) const;
+
+  // One rect per window; the parts of a split share their edge, no gap nor overlap
+  void Layout(const ScreenRect& area, std::vector<ScreenRect>& rects) const;
+};
+
+#endif // __SPLIT_TREE_H__
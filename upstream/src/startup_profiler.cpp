@@ -0,0 +1,96 @@
+#include "startup_profiler.h"
+
+#include "debug_log.h"
+
+#include <psapi.h>
+
+StartupProfiler* StartupProfiler::p_instance = NULL;
+
+StartupProfiler::StartupProfiler()
+    : m_phase(NULL)
+{
+  QueryPerformanceFrequency(&m_frequency);
+  TakeSample(m_start);
+  m_phaseStart = m_start;
+}
+
+void StartupProfiler::Start()
+{
+  if (p_instance || !DebugLog::IsEnabled())
+    return;
+
+  p_instance = new StartupProfiler();
+
+  // From the creation of the process to OnInit
+  FILETIME creation, exitTime, kernel, user, now;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+    GetSystemTimeAsFileTime(&now);
+    ULONGLONG elapsed = ((ULONGLONG(now.dwHighDateTime) << 32) | now.dwLowDateTime) -
+                        ((ULONGLONG(creation.dwHighDateTime) << 32) | creation.dwLowDateTime);
+    DEBUG_LOG_FMT("Startup: %-16s %8.2f ms", "before OnInit", elapsed / 10000.0);
+  }
+}
+
+void StartupProfiler::Phase(const char* name)
+{
+  if (!p_instance)
+    return;
+
+  Sample sample;
+  TakeSample(sample);
+
+  if (p_instance->m_phase)
+    p_instance->Log(p_instance->m_phase, p_instance->m_phaseStart, sample);
+
+  p_instance->m_phase = name;
+  p_instance->m_phaseStart = sample;
+}
+
+void StartupProfiler::Finish()
+{
+  if (!p_instance)
+    return;
+
+  Phase(NULL);
+
+  Sample sample;
+  TakeSample(sample);
+  p_instance->Log("tray ready", p_instance->m_start, sample);
+
+  delete p_instance;
+  p_instance = NULL;
+}
+
+void StartupProfiler::TakeSample(Sample& sample)
+{
+  QueryPerformanceCounter(&sample.counter);
+
+  PROCESS_MEMORY_COUNTERS_EX memory;
+  memory.cb = sizeof(memory);
+  if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&memory,
+                           sizeof(memory))) {
+    sample.privateBytes = memory.PrivateUsage;
+    sample.pageFaults = memory.PageFaultCount;
+  }
+  else {
+    sample.privateBytes = 0;
+    sample.pageFaults = 0;
+  }
+}
+
+double StartupProfiler::Milliseconds(const Sample& from, const Sample& to) const
+{
+  return (to.counter.QuadPart - from.counter.QuadPart) * 1000.0 / m_frequency.QuadPart;
+}
+
+void StartupProfiler::Log(const char* name, const Sample& from, const Sample& to) const
+{
+  // Hard page faults are not told apart: under a contended disk, a phase with many faults
+  // and a long time is waiting for I/O
+  long long allocated = (long long)to.privateBytes - (long long)from.privateBytes;
+  DEBUG_LOG_FMT("Startup: %-16s %8.2f ms %+8lld KB %6lu page faults",
+                name,
+                Milliseconds(from, to),
+                allocated / 1024,
+                to.pageFaults - from.pageFaults);
+}
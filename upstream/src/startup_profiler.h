@@ -0,0 +1,47 @@
+#ifndef __STARTUP_PROFILER_H__
+#define __STARTUP_PROFILER_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+// Wall time, private bytes and page faults of each startup phase, written to the debug log:
+//
+//   StartupProfiler::Start();
+//   StartupProfiler::Phase("settings");  // ends the previous phase
+//   ...
+//   StartupProfiler::Finish();           // tray ready: totals, then the profiler is gone
+//
+// The first line is the time spent before OnInit (loader, CRT and wxWidgets startup). Does
+// nothing, and costs nothing, when the debug log is disabled or outside Start / Finish.
+class StartupProfiler // Singleton class
+{
+private:
+  struct Sample {
+    LARGE_INTEGER counter;
+    SIZE_T privateBytes;
+    DWORD pageFaults;
+  };
+
+  static StartupProfiler* p_instance;
+
+  LARGE_INTEGER m_frequency;
+  Sample m_start; // OnInit
+  Sample m_phaseStart;
+  const char* m_phase;
+
+  StartupProfiler();
+  ~StartupProfiler() {}
+
+  static void TakeSample(Sample& sample);
+  double Milliseconds(const Sample& from, const Sample& to) const;
+  void Log(const char* name, const Sample& from, const Sample& to) const;
+
+public:
+  static void Start();
+  static void Phase(const char* name);
+  static void Finish();
+};
+
+#endif // __STARTUP_PROFILER_H__
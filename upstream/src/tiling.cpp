@@ -0,0 +1,282 @@
+#include "tiling.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+
+using namespace std;
+
+// A weight below this fraction of the mean is raised to it (squarified layout)
+#define TILING_MIN_WEIGHT_SHARE 0.25
+
+namespace {
+  // Tile being computed: edges in floating point, rounded once at the end
+  struct Box {
+    double left;
+    double top;
+    double right;
+    double bottom;
+  };
+
+  struct WeightIndex {
+    double area; // share of the area, in square pixels
+    size_t index;
+
+    bool operator<(const WeightIndex& other) const { return area > other.area; }
+  };
+}
+
+// i-th of 'count' edges splitting [start, start + length] evenly
+static int Edge(int start, int length, size_t i, size_t count)
+{
+  return start + int((long long)length * (long long)i / (long long)count);
+}
+
+static ScreenRect MakeRect(int left, int top, int right, int bottom)
+{
+  ScreenRect rect = {left, top, right - left, bottom - top};
+  return rect;
+}
+
+static ScreenRect RoundBox(const Box& box)
+{
+  // Neighbours share their edge values, so they round to the same pixel
+  return MakeRect(int(floor(box.left + 0.5)),
+                  int(floor(box.top + 0.5)),
+                  int(floor(box.right + 0.5)),
+                  int(floor(box.bottom + 0.5)));
+}
+
+// Cells as square as possible, few cells left over in the last row
+static size_t GridColumns(const ScreenRect& area, size_t count)
+{
+  size_t best = 1;
+  double best_score = 0.;
+
+  for (size_t columns = 1; columns <= count; ++columns) {
+    size_t rows = (count + columns - 1) / columns;
+    double aspect = (double(area.width) / columns) / (double(area.height) / rows);
+    double score = fabs(log(aspect)) + 0.25 * double(rows * columns - count);
+
+    if (columns == 1 || score < best_score) {
+      best = columns;
+      best_score = score;
+    }
+  }
+
+  return best;
+}
+
+static void TileGrid(const ScreenRect& area, size_t count, vector<ScreenRect>& tiles)
+{
+  size_t columns = GridColumns(area, count);
+  size_t rows = (count + columns - 1) / columns;
+
+  for (size_t row = 0; row < rows; ++row) {
+    int top = Edge(area.y, area.height, row, rows);
+    int bottom = Edge(area.y, area.height, row + 1, rows);
+    size_t first = row * columns;
+    size_t cells = min(columns, count - first);
+
+    for (size_t column = 0; column < cells; ++column)
+      tiles.push_back(MakeRect(Edge(area.x, area.width, column, cells),
+                               top,
+                               Edge(area.x, area.width, column + 1, cells),
+                               bottom));
+  }
+}
+
+static void TileMasterStack(const ScreenRect& area, size_t count, int master_percent,
+                            vector<ScreenRect>& tiles)
+{
+  if (count == 1) {
+    tiles.push_back(area);
+    return;
+  }
+
+  int percent = max(10, min(90, master_percent));
+  size_t stacked = count - 1;
+
+  // The master column follows the long side of the area (on top for a portrait monitor)
+  if (area.width >= area.height) {
+    int split = area.x + int((long long)area.width * percent / 100);
+
+    tiles.push_back(MakeRect(area.x, area.y, split, area.y + area.height));
+    for (size_t i = 0; i < stacked; ++i)
+      tiles.push_back(MakeRect(split,
+                               Edge(area.y, area.height, i, stacked),
+                               area.x + area.width,
+                               Edge(area.y, area.height, i + 1, stacked)));
+  }
+  else {
+    int split = area.y + int((long long)area.height * percent / 100);
+
+    tiles.push_back(MakeRect(area.x, area.y, area.x + area.width, split));
+    for (size_t i = 0; i < stacked; ++i)
+      tiles.push_back(MakeRect(Edge(area.x, area.width, i, stacked),
+                               split,
+                               Edge(area.x, area.width, i + 1, stacked),
+                               area.y + area.height));
+  }
+}
+
+// Worst aspect ratio of a row of tiles of total 'sum', laid along a side of length 'side'
+static double WorstAspect(double sum, double smallest, double largest, double side)
+{
+  double side2 = side * side;
+  double sum2 = sum * sum;
+
+  return max(side2 * largest / sum2, sum2 / (side2 * smallest));
+}
+
+// Squarified treemap (Bruls, Huizing, van Wijk): windows sorted by decreasing area fill
+// rows along the short side of the remaining space, a row is closed as soon as adding
+// the next window would make its worst tile less square
+static void TileSquarified(const ScreenRect& area, const vector<double>& weights,
+                           vector<ScreenRect>& tiles)
+{
+  size_t count = weights.size();
+  vector<WeightIndex> items(count);
+  double total = 0.;
+
+  for (size_t i = 0; i < count; ++i)
+    total += max(weights[i], 0.);
+
+  double mean = total > 0. ? total / count : 1.;
+  double floor_weight = mean * TILING_MIN_WEIGHT_SHARE;
+
+  total = 0.;
+  for (size_t i = 0; i < count; ++i) {
+    items[i].area = weights[i] > floor_weight ? weights[i] : floor_weight;
+    items[i].index = i;
+    total += items[i].area;
+  }
+
+  // Weights become areas in square pixels
+  double scale = double(area.width) * double(area.height) / total;
+  for (size_t i = 0; i < count; ++i)
+    items[i].area *= scale;
+
+  stable_sort(items.begin(), items.end());
+
+  vector<Box> boxes(count);
+  Box free_space = {double(area.x),
+                    double(area.y),
+                    double(area.x + area.width),
+                    double(area.y + area.height)};
+  size_t first = 0;
+
+  while (first < count) {
+    double width = free_space.right - free_space.left;
+    double height = free_space.bottom - free_space.top;
+    bool vertical = width >= height; // the row is a column on the left of the free space
+    double side = vertical ? height : width;
+
+    // Sorted by decreasing area: the first item is the largest, the last the smallest
+    size_t last = first + 1;
+    double sum = items[first].area;
+    double worst = WorstAspect(sum, items[first].area, items[first].area, side);
+
+    while (last < count) {
+      double next_sum = sum + items[last].area;
+      double next_worst = WorstAspect(next_sum, items[last].area, items[first].area, side);
+
+      if (next_worst > worst)
+        break;
+
+      sum = next_sum;
+      worst = next_worst;
+      ++last;
+    }
+
+    // Thickness of the row; the last one takes whatever is left
+    bool final_row = last == count;
+    double position = vertical ? free_space.left : free_space.top;
+    double limit = final_row ? (vertical ? free_space.right : free_space.bottom)
+                             : position + sum / side;
+    double start = vertical ? free_space.top : free_space.left;
+    double end = vertical ? free_space.bottom : free_space.right;
+
+    for (size_t i = first; i < last; ++i) {
+      double next = i + 1 == last ? end : start + items[i].area / (limit - position);
+      Box& box = boxes[items[i].index];
+
+      if (vertical) {
+        box.left = position;
+        box.right = limit;
+        box.top = start;
+        box.bottom = next;
+      }
+      else {
+        box.left = start;
+        box.right = next;
+        box.top = position;
+        box.bottom = limit;
+      }
+      start = next;
+    }
+
+    if (vertical)
+      free_space.left = limit;
+    else
+      free_space.top = limit;
+
+    first = last;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+    tiles.push_back(RoundBox(boxes[i]));
+}
+
+void ComputeTiling(const ScreenRect& area, const vector<double>& weights,
+                   const TilingOptions& options, vector<ScreenRect>& tiles)
+{
+  size_t count = weights.size();
+
+  tiles.clear();
+  if (count == 0)
+    return;
+
+  tiles.reserve(count);
+
+  // Half a gap inside every tile, the other half along the edges of the area:
+  // a full gap between two tiles and around them
+  int gap = max(0, options.gap);
+  int half = gap / 2;
+  ScreenRect inner = MakeRect(area.x + gap - half,
+                              area.y + gap - half,
+                              area.x + area.width - half,
+                              area.y + area.height - half);
+
+  if (inner.width <= 0 || inner.height <= 0) {
+    tiles.assign(count, area);
+    return;
+  }
+
+  switch (options.algorithm) {
+  case TILING_MASTER_STACK:
+    TileMasterStack(inner, count, options.masterPercent, tiles);
+    break;
+  case TILING_SQUARIFIED:
+    TileSquarified(inner, weights, tiles);
+    break;
+  default:
+    TileGrid(inner, count, tiles);
+    break;
+  }
+
+  if (gap == 0)
+    return;
+
+  for (size_t i = 0; i < count; ++i) {
+    ScreenRect& tile = tiles[i];
+    int width = tile.width - gap;
+    int height = tile.height - gap;
+
+    // A tile narrower than the gap keeps one pixel
+    tile.x += half;
+    tile.y += half;
+    tile.width = max(1, width);
+    tile.height = max(1, height);
+  }
+}
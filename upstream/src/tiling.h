@@ -0,0 +1,38 @@
+#ifndef __TILING_H__
+#define __TILING_H__
+
+// Layout of the Mosaic function: one tile per window over a work area.
+//
+// Tiles cover the area exactly, without overlap: the edges are computed once and shared
+// by the neighbouring tiles, so rounding never leaves a gap of one pixel between two
+// windows. The cost is linear in the number of windows (n log n for the squarified
+// layout, which sorts them by weight).
+//
+// This file only depends on the standard library (ScreenRect comes from dpi_move.h),
+// the Win32 part lives in Mosaique().
+
+#include "dpi_move.h"
+
+#include <vector>
+
+enum TILING_ALGORITHM {
+  TILING_GRID,         // rows of equal cells, the last row shares the whole width
+  TILING_MASTER_STACK, // first window in a master column, the others stacked beside it
+  TILING_SQUARIFIED    // tile area proportional to the weight, tiles as square as possible
+};
+
+#define NB_TILING_ALGORITHMS 3
+
+struct TilingOptions {
+  TILING_ALGORITHM algorithm;
+  int masterPercent; // master-stack: share of the master column, 10 to 90 (%)
+  int gap;           // pixels between two tiles and along the edges of the area
+};
+
+// One tile per weight, in the order of the weights. The weights (window areas) are only
+// used by TILING_SQUARIFIED; a window weighing less than a quarter of the mean is given
+// a quarter of the mean, so that no tile becomes unusable.
+void ComputeTiling(const ScreenRect& area, const std::vector<double>& weights,
+                   const TilingOptions& options, std::vector<ScreenRect>& tiles);
+
+#endif // __TILING_H__
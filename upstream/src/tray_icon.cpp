@@ -2,20 +2,34 @@
 
 #include "main.h"
 
+#include "animator.h"
+#include "auto_placement.h"
+#include "config_watcher.h"
 #include "dialog_about.h"
 #include "dialog_update.h"
 #include "dialog_hotkeys.h"
 #include "dialog_layout.h"
 #include "dialog_options.h"
 #include "dialog_warnhotkeys.h"
+#include "dwm_utils.h"
 #include "frame_hook.h"
 #include "frame_virtualnumpad.h"
 #include "hotkeys_manager.h"
 #include "layout_manager.h"
+#include "layout_screens.h"
+#include "layout_snapshots.h"
+#include "multimonitor_move.h"
+#include "placement_rules.h"
 #include "settingsmanager.h"
+#include "startup_profiler.h"
 #include "update_thread.h"
+#include "wallpaper_thumbnails.h"
+#include "window_geometry.h"
 
 #include <wx/msw/registry.h>
+#include <wx/settings.h>
+
+#include <time.h>
 
 //==============
 // Image loading
@@ -28,16 +42,37 @@
 #include "../images/tray6.xpm"
 //======================
 
+namespace {
+  // "Checking for update" animation, played back and forth; the first frame is the icon
+  const char* const* TRAY_FRAMES_XPM[NB_TRAY_FRAMES] = {
+      icone_xpm, tray2_xpm, tray3_xpm, tray4_xpm, tray5_xpm, tray6_xpm};
+
+  const int TRAY_FRAME_DELAY = 200; // ms
+
+  // By MENU_IMAGE
+  const wxChar* MENU_IMAGE_FILES[NB_MENU_IMAGES] = {_T ("about.png"),
+                                                    _T ("help.png"),
+                                                    _T ("options.png"),
+                                                    _T ("layout.png"),
+                                                    _T ("hotkeys.png"),
+                                                    _T ("auto_start_false.png"),
+                                                    _T ("auto_start_true.png"),
+                                                    _T ("exit.png")};
+}
+
 BEGIN_EVENT_TABLE(TrayIcon, wxTaskBarIcon)
 
 EVT_MENU(ID_MENU_ABOUT, TrayIcon::OnMenuClickAbout)
 EVT_MENU(ID_MENU_RULE, TrayIcon::OnMenuClickRule)
 EVT_MENU(ID_MENU_LAYOUT, TrayIcon::OnMenuClickLayout)
 EVT_MENU(ID_MENU_HK, TrayIcon::OnMenuClickConfigureHK)
+EVT_MENU_RANGE(ID_MENU_GATHER, ID_MENU_GATHER_LAST, TrayIcon::OnMenuClickGather)
+EVT_MENU_RANGE(ID_MENU_SPREAD_ROUND_ROBIN, ID_MENU_SPREAD_LAST_KNOWN, TrayIcon::OnMenuClickSpread)
 EVT_MENU(ID_MENU_HELP, TrayIcon::OnMenuClickHelp)
 EVT_MENU(ID_MENU_AUTOBOOT, TrayIcon::OnMenuClickAutoStart)
 EVT_MENU(ID_MENU_QUIT, TrayIcon::OnMenuClickQuit)
 EVT_TIMER(ID_TIMER, TrayIcon::OnTimer)
+EVT_THREAD(ID_UPDATE_CHECKED, TrayIcon::OnUpdateChecked)
 
 EVT_TASKBAR_LEFT_DOWN(TrayIcon::OnLeftClick)
 
@@ -46,33 +81,51 @@ END_EVENT_TABLE()
 TrayIcon::TrayIcon()
     : m_options(SettingsManager::Get())
     , m_cleanedUp(false)
+    , m_imagesLoaded(false)
+    , m_settingsListener(0)
+    , m_iconSize(0)
+    , m_frame(0)
+    , m_frameStep(1)
 {
   ReadRegisterAutoStart();
-  SetIcon(wxIcon(icone_xpm), _T ("WinSplit Revolution ") + wxGetApp().GetVersion());
+  ShowIcon();
 
+  StartupProfiler::Phase("hotkeys");
   p_hotkeys = new HotkeysManager(this);
-  p_virtNumpad = new VirtualNumpad();
+  // Created on first use (GetVirtualNumpad), most sessions never show it
+  p_virtNumpad = NULL;
 
   p_updateThread = NULL;
 
   SetHotkeys();
 
-  if (m_options.getSaveNumpadPosOnExit()) {
-    p_virtNumpad->SetPosition(m_options.getNumpadPosition());
-    p_virtNumpad->SetReduced(m_options.getNumpadStyle());
-    p_virtNumpad->SetCheckValue(!m_options.getNumpadAutoHide());
-    p_virtNumpad->SetTransparency(m_options.getNumpadTransparency());
+  if (m_options.getShowNumpadAtBoot()) {
+    StartupProfiler::Phase("virtual numpad");
+    GetVirtualNumpad()->Show();
   }
 
-  if (m_options.getShowNumpadAtBoot())
-    p_virtNumpad->Show();
-
-  LoadImages();
+  // Options applied as they change, from the options dialog or a reload
+  m_settingsListener =
+      m_options.Subscribe([this](SETTING_ID setting) { OnSettingChanged(setting); });
 
+  StartupProfiler::Phase("layouts");
   LayoutManager::GetInstance()->LoadData();
 
+  // Rules may reference layout zones: load them after the layout
+  if (PlacementRules::GetInstance()->LoadData())
+    PlacementRules::GetInstance()->Start();
+
+  StartupProfiler::Phase("watchers");
+  LayoutSnapshots::GetInstance()->Start();
+
+  // Configuration pushed into the data directory is applied without restart
+  ConfigWatcher::GetInstance()->Start(m_options.GetDataDirectory(),
+                                      [this]() { OnConfigReloaded(); });
+
+  // Animation frames while an update check is in flight, no timer otherwise
   m_timer.SetOwner(this, ID_TIMER);
-  m_timer.Start(200);
+  // Once the event loop runs
+  CallAfter(&TrayIcon::StartUpdateCheck);
 }
 
 TrayIcon::~TrayIcon()
@@ -86,8 +139,11 @@ void TrayIcon::Cleanup()
     return;
   m_cleanedUp = true;
 
-  // 1. Stop timer first to prevent OnTimer firing during cleanup
+  // 1. Stop timer, configuration watcher and settings notifications first to prevent OnTimer
+  //    or a reload firing during cleanup
   m_timer.Stop();
+  ConfigWatcher::DeleteInstance();
+  m_options.Unsubscribe(m_settingsListener);
 
   // 2. Stop and delete hotkeys manager
   if (p_hotkeys) {
@@ -119,54 +175,161 @@ void TrayIcon::Cleanup()
   // 5. Remove tray icon
   RemoveIcon();
 
-  // 6. Delete layout manager singleton
+  // 6. Delete layout and placement singletons (removes the window creation hook)
   LayoutManager::DeleteInstance();
+  AutoPlacementManager::DeleteInstance();
+  PlacementRules::DeleteInstance();
+  LayoutSnapshots::DeleteInstance();
+  MonitorTopology::DeleteInstance();
+  WindowGeometryCache::DeleteInstance();
+  Animator::DeleteInstance();
+  LayoutScreens::DeleteInstance();
+  WallpaperThumbnails::DeleteInstance();
 }
 
-void TrayIcon::LoadImages()
+void TrayIcon::OnConfigReloaded()
 {
-  im_about.LoadFile(_T ("images\\about.png"), wxBITMAP_TYPE_PNG);
+  // Every manager takes its section of the new store; the hotkeys are registered again
+  m_options.LoadSettings();
+  // Placement rules are not in the store: the watcher applied their own file, and they
+  // read their layout zones when a window is placed
+  LayoutManager::GetInstance()->LoadData();
 
-  im_help.LoadFile(_T ("images\\help.png"), wxBITMAP_TYPE_PNG);
+  p_hotkeys->Stop();
+  SetHotkeys();
+}
 
-  im_options.LoadFile(_T ("images\\options.png"), wxBITMAP_TYPE_PNG);
+void TrayIcon::OnSettingChanged(SETTING_ID setting)
+{
+  FrameHook* frameHook = wxGetApp().GetFrameHook();
+
+  switch (setting) {
+  case SETTING_NUMPAD_TRANSPARENCY:
+    if (p_virtNumpad)
+      p_virtNumpad->SetTransparency(m_options.getNumpadTransparency());
+    break;
+  case SETTING_NUMPAD_AUTO_HIDE:
+    if (p_virtNumpad)
+      p_virtNumpad->SetCheckValue(!m_options.getNumpadAutoHide());
+    break;
+  case SETTING_DNG_ENABLED:
+    // Do we need to reactivate or deactivate the Drag'N'Go hook?
+    if (frameHook->IsHookInstalled() != m_options.IsDragNGoEnabled()) {
+      if (m_options.IsDragNGoEnabled())
+        frameHook->SetHook();
+      else
+        frameHook->UnSetHook();
+    }
+    break;
+  default:
+    break;
+  }
+}
 
-  im_layout_settings.LoadFile(_T ("images\\layout.png"), wxBITMAP_TYPE_PNG);
+VirtualNumpad* TrayIcon::GetVirtualNumpad()
+{
+  if (!p_virtNumpad) {
+    p_virtNumpad = new VirtualNumpad();
+
+    if (m_options.getSaveNumpadPosOnExit()) {
+      p_virtNumpad->SetPosition(m_options.getNumpadPosition());
+      p_virtNumpad->SetReduced(m_options.getNumpadStyle());
+      p_virtNumpad->SetCheckValue(!m_options.getNumpadAutoHide());
+      p_virtNumpad->SetTransparency(m_options.getNumpadTransparency());
+    }
+  }
+
+  return p_virtNumpad;
+}
+
+// Read when the menu opens for the first time, not at startup
+void TrayIcon::LoadImages()
+{
+  if (m_imagesLoaded)
+    return;
+  m_imagesLoaded = true;
 
-  im_hotkeys.LoadFile(_T ("images\\hotkeys.png"), wxBITMAP_TYPE_PNG);
+  wxGetApp().InitImageHandlers();
 
-  im_startwin_false.LoadFile(_T ("images\\auto_start_false.png"), wxBITMAP_TYPE_PNG);
+  for (int i = 0; i < NB_MENU_IMAGES; ++i)
+    m_menuImages[i].LoadFile(wxString(_T ("images\\")) + MENU_IMAGE_FILES[i], wxBITMAP_TYPE_PNG);
+}
 
-  im_startwin_true.LoadFile(_T ("images\\auto_start_true.png"), wxBITMAP_TYPE_PNG);
+const wxBitmap& TrayIcon::GetMenuBitmap(MENU_IMAGE image, unsigned int dpi)
+{
+  // One set per DPI met: with monitors at different scales, going from one to the other
+  // does not scale again. A new scale factor is a new entry.
+  std::vector<wxBitmap>& bitmaps = m_menuBitmaps[dpi];
+  if (bitmaps.empty())
+    bitmaps.resize(NB_MENU_IMAGES);
+
+  wxBitmap& bmp = bitmaps[image];
+  if (bmp.IsOk() || !m_menuImages[image].IsOk())
+    return bmp;
+
+  wxImage img = m_menuImages[image];
+  int width = MulDiv(img.GetWidth(), dpi, 96);
+  int height = MulDiv(img.GetHeight(), dpi, 96);
+  if (width != img.GetWidth() || height != img.GetHeight()) {
+    // Whole factors (200%, 300%) repeat the pixels and stay sharp; others are resampled
+    bool whole = dpi % 96 == 0;
+    img.Rescale(width, height, whole ? wxIMAGE_QUALITY_NEAREST : wxIMAGE_QUALITY_HIGH);
+  }
 
-  im_exit.LoadFile(_T ("images\\exit.png"), wxBITMAP_TYPE_PNG);
+  bmp = wxBitmap(img);
+  return bmp;
 }
 
 wxMenu* TrayIcon::CreatePopupMenu()
 {
+  LoadImages();
+
+  // The menu opens on the monitor of the cursor (the notification area or the numpad)
+  POINT cursor;
+  GetCursorPos(&cursor);
+  UINT dpi = DwmUtils::GetDpiForPoint(cursor.x, cursor.y);
+
   wxMenu* main_menu = new wxMenu;
 
   wxMenuItem* menu_about = new wxMenuItem(main_menu, ID_MENU_ABOUT, _("About WinSplit Revolution"));
-  menu_about->SetBitmap(wxBitmap(im_about));
+  menu_about->SetBitmap(GetMenuBitmap(MENU_IMG_ABOUT, dpi));
 
   wxMenuItem* menu_help = new wxMenuItem(main_menu, ID_MENU_HELP, _("Help"));
-  menu_help->SetBitmap(wxBitmap(im_help));
+  menu_help->SetBitmap(GetMenuBitmap(MENU_IMG_HELP, dpi));
 
   wxMenuItem* menu_layout_settings =
       new wxMenuItem(main_menu, ID_MENU_LAYOUT, _("Layout settings"));
-  menu_layout_settings->SetBitmap(wxBitmap(im_layout_settings));
+  menu_layout_settings->SetBitmap(GetMenuBitmap(MENU_IMG_LAYOUT, dpi));
 
   wxMenuItem* menu_option = new wxMenuItem(main_menu, ID_MENU_RULE, _("Options"));
-  menu_option->SetBitmap(wxBitmap(im_options));
+  menu_option->SetBitmap(GetMenuBitmap(MENU_IMG_OPTIONS, dpi));
 
   wxMenuItem* menu_hk_configure = new wxMenuItem(main_menu, ID_MENU_HK, _("Hotkeys settings"));
-  menu_hk_configure->SetBitmap(wxBitmap(im_hotkeys));
+  menu_hk_configure->SetBitmap(GetMenuBitmap(MENU_IMG_HOTKEYS, dpi));
 
   wxMenuItem* menu_start = new wxMenuItem(main_menu, ID_MENU_AUTOBOOT, _("Launch with Windows"));
-  menu_start->SetBitmap(wxBitmap(m_autoStart ? im_startwin_true : im_startwin_false));
+  menu_start->SetBitmap(
+      GetMenuBitmap(m_autoStart ? MENU_IMG_AUTOSTART_TRUE : MENU_IMG_AUTOSTART_FALSE, dpi));
 
   wxMenuItem* menu_quit = new wxMenuItem(main_menu, ID_MENU_QUIT, _("Exit"));
-  menu_quit->SetBitmap(wxBitmap(im_exit));
+  menu_quit->SetBitmap(GetMenuBitmap(MENU_IMG_EXIT, dpi));
+
+  // Batch moves, only meaningful with several monitors
+  int nb_monitors = MonitorTopology::GetInstance()->GetCount();
+  wxMenu* menu_arrange = NULL;
+
+  if (nb_monitors > 1) {
+    menu_arrange = new wxMenu;
+
+    for (int i = 0; i < nb_monitors && ID_MENU_GATHER + i <= ID_MENU_GATHER_LAST; ++i)
+      menu_arrange->Append(ID_MENU_GATHER + i,
+                           wxString::Format(_("Gather all windows on screen %d"), i + 1));
+
+    menu_arrange->AppendSeparator();
+    menu_arrange->Append(ID_MENU_SPREAD_ROUND_ROBIN, _("Spread windows across screens"));
+    menu_arrange->Append(ID_MENU_SPREAD_PROCESS, _("Spread applications across screens"));
+    menu_arrange->Append(ID_MENU_SPREAD_LAST_KNOWN, _("Move windows back to their last screen"));
+  }
 
   main_menu->Append(menu_about);
   main_menu->Append(menu_help);
@@ -175,6 +338,10 @@ wxMenu* TrayIcon::CreatePopupMenu()
   main_menu->Append(menu_layout_settings);
   main_menu->Append(menu_option);
   main_menu->Append(menu_start);
+  if (menu_arrange) {
+    main_menu->AppendSeparator();
+    main_menu->AppendSubMenu(menu_arrange, _("Arrange windows"));
+  }
   main_menu->AppendSeparator();
   main_menu->Append(menu_quit);
 
@@ -187,6 +354,26 @@ void TrayIcon::OnMenuClickAbout(wxCommandEvent& event)
   dlg_about.ShowModal();
 }
 
+void TrayIcon::OnMenuClickGather(wxCommandEvent& event)
+{
+  GatherWindows(event.GetId() - ID_MENU_GATHER);
+}
+
+void TrayIcon::OnMenuClickSpread(wxCommandEvent& event)
+{
+  switch (event.GetId()) {
+  case ID_MENU_SPREAD_ROUND_ROBIN:
+    SpreadWindows(SPREAD_ROUND_ROBIN);
+    break;
+  case ID_MENU_SPREAD_PROCESS:
+    SpreadWindows(SPREAD_BY_PROCESS);
+    break;
+  default:
+    SpreadWindows(SPREAD_BY_LAST_KNOWN);
+    break;
+  }
+}
+
 void TrayIcon::OnMenuClickHelp(wxCommandEvent& event)
 {
   wxLaunchDefaultBrowser(_T ("https://dozius.github.io/winsplit-revolution/Revolution/help.html"));
@@ -195,17 +382,8 @@ void TrayIcon::OnMenuClickHelp(wxCommandEvent& event)
 void TrayIcon::OnMenuClickRule(wxCommandEvent& event)
 {
   OptionsDialog dialog_option;
-  dialog_option.SetVirtualNumPad(p_virtNumpad);
+  dialog_option.SetVirtualNumPad(GetVirtualNumpad());
   dialog_option.ShowModal();
-  // Do we need to reactivate or deactivate the Drag'N'Go hook?
-  if (wxGetApp().GetFrameHook()->IsHookInstalled() != m_options.IsDragNGoEnabled()) {
-    if (m_options.IsDragNGoEnabled()) {
-      wxGetApp().GetFrameHook()->SetHook();
-    }
-    else {
-      wxGetApp().GetFrameHook()->UnSetHook();
-    }
-  }
 }
 
 void TrayIcon::OnMenuClickConfigureHK(wxCommandEvent& event)
@@ -227,8 +405,10 @@ void TrayIcon::OnMenuClickLayout(wxCommandEvent& event)
 {
   LayoutDialog dialog;
 
-  if (dialog.ShowModal() == wxOK)
+  if (dialog.ShowModal() == wxOK) {
+    // Placement rules read their layout zones when a window is placed
     LayoutManager::GetInstance()->LoadData();
+  }
 }
 
 void TrayIcon::OnMenuClickAutoStart(wxCommandEvent& event)
@@ -314,99 +494,109 @@ void TrayIcon::SetHotkeys()
 // This is a tri-state toggle.
 void TrayIcon::OnLeftClick(wxTaskBarIconEvent& event)
 {
-  p_virtNumpad->CycleShownReduced();
+  GetVirtualNumpad()->CycleShownReduced();
 }
 
 void TrayIcon::ShowOrHideVirtualNumpad()
 {
-  p_virtNumpad->Show(!p_virtNumpad->IsShown());
+  VirtualNumpad* numpad = GetVirtualNumpad();
+  numpad->Show(!numpad->IsShown());
 }
 
-void TrayIcon::OnTimer(wxTimerEvent& event)
+void TrayIcon::StartUpdateCheck()
 {
-  static int iconupdate = 0;
-  static int sens = 1;
+  if (p_updateThread || m_cleanedUp)
+    return;
 
-  if (!p_updateThread) {
-    p_updateThread = new ReadVersionThread(60);
-    p_updateThread->Create();
-    p_updateThread->Run();
+  // Most startups have nothing to check: no thread and no animation then
+  p_updateThread = new ReadVersionThread(60, this, ID_UPDATE_CHECKED);
+  if (!p_updateThread->IsCheckDue() || p_updateThread->Create() != wxTHREAD_NO_ERROR ||
+      p_updateThread->Run() != wxTHREAD_NO_ERROR) {
+    delete p_updateThread;
+    p_updateThread = NULL;
+    return;
   }
 
-  if (p_updateThread->IsRunning()) {
-    switch (iconupdate) {
-      case 0:
-        sens = 1;
-        ++iconupdate;
-        SetIcon(wxIcon(icone_xpm), _("Checking for update"));
-        break;
-      case 1:
-        if (sens > 0)
-          ++iconupdate;
-        else
-          --iconupdate;
-        SetIcon(wxIcon(tray2_xpm), _("Checking for update"));
-        break;
-      case 2:
-        if (sens > 0)
-          ++iconupdate;
-        else
-          --iconupdate;
-        SetIcon(wxIcon(tray3_xpm), _("Checking for update"));
-        break;
-      case 3:
-        if (sens > 0)
-          ++iconupdate;
-        else
-          --iconupdate;
-        SetIcon(wxIcon(tray4_xpm), _("Checking for update"));
-        break;
-      case 4:
-        if (sens > 0)
-          ++iconupdate;
-        else
-          --iconupdate;
-        SetIcon(wxIcon(tray5_xpm), _("Checking for update"));
-        break;
-      case 5:
-        sens = -1;
-        --iconupdate;
-        SetIcon(wxIcon(tray6_xpm), _("Checking for update"));
-        break;
-      default:
-        iconupdate = 0;
-        SetIcon(wxIcon(icone_xpm), _("Checking for update"));
-        break;
-    }
+  m_frame = 0;
+  m_frameStep = 1;
+  BuildIcons();
+  SetIcon(m_icons[0], _("Checking for update"));
+  m_timer.Start(TRAY_FRAME_DELAY);
+}
+
+void TrayIcon::OnTimer(wxTimerEvent& event)
+{
+  // Back and forth over the frames
+  if (m_frame + m_frameStep < 0 || m_frame + m_frameStep >= NB_TRAY_FRAMES)
+    m_frameStep = -m_frameStep;
+  m_frame += m_frameStep;
+
+  SetIcon(m_icons[m_frame], _("Checking for update"));
+}
+
+void TrayIcon::OnUpdateChecked(wxThreadEvent& event)
+{
+  // Cleanup() already deleted the thread
+  if (!p_updateThread)
+    return;
+
+  m_timer.Stop();
+  ShowIcon();
+
+  // Entry() returned: the thread is about to exit
+  p_updateThread->Wait();
+
+  wxString newVersion = p_updateThread->GetVersionString();
+  wxString releaseUrl = p_updateThread->GetReleaseUrl();
+  wxString releaseNotes = p_updateThread->GetReleaseNotes();
+  double host_version = p_updateThread->GetHostVersion();
+  double local_version;
+
+  // The next weekly / monthly check counts from a check that got an answer. Written here:
+  // the settings notify their listeners, which are UI code
+  if (p_updateThread->HasAnswer()) {
+    time_t now;
+    time(&now);
+    m_options.setLastCheckDate(now);
   }
-  else {
-    m_timer.Stop();
-    SetIcon(wxIcon(icone_xpm), _T ("WinSplit Revolution ") + wxGetApp().GetVersion());
 
-    wxString newVersion = p_updateThread->GetVersionString();
-    wxString releaseUrl = p_updateThread->GetReleaseUrl();
-    wxString releaseNotes = p_updateThread->GetReleaseNotes();
-    double host_version = p_updateThread->GetHostVersion();
-    double local_version;
+  wxGetApp().GetVersion().ToDouble(&local_version);
 
-    wxGetApp().GetVersion().ToDouble(&local_version);
+  delete p_updateThread;
+  p_updateThread = NULL;
 
-    delete p_updateThread;
-    p_updateThread = NULL;
+  if (host_version > local_version && !newVersion.IsEmpty()) {
+    // Show update notification dialog
+    UpdateNotificationDialog dialog(NULL,
+        wxGetApp().GetVersion(),
+        newVersion,
+        releaseUrl,
+        releaseNotes);
+    dialog.ShowModal();
+  }
+}
 
-    if (host_version > local_version && !newVersion.IsEmpty()) {
-      // Show update notification dialog
-      UpdateNotificationDialog dialog(NULL,
-          wxGetApp().GetVersion(),
-          newVersion,
-          releaseUrl,
-          releaseNotes);
-      dialog.ShowModal();
-    }
+void TrayIcon::BuildIcons()
+{
+  // The notification area shows small icons: scale the frames once for the current DPI
+  int size = wxSystemSettings::GetMetric(wxSYS_SMALLICON_X);
+  if (size <= 0)
+    size = 16;
+  if (size == m_iconSize)
+    return;
+
+  for (int i = 0; i < NB_TRAY_FRAMES; ++i) {
+    wxImage img(TRAY_FRAMES_XPM[i]);
+    if (img.GetWidth() != size)
+      img.Rescale(size, size, wxIMAGE_QUALITY_HIGH);
+
+    m_icons[i].CopyFromBitmap(wxBitmap(img));
   }
+  m_iconSize = size;
 }
 
 void TrayIcon::ShowIcon()
 {
-  SetIcon(wxIcon(icone_xpm), _T ("WinSplit Revolution ") + wxGetApp().GetVersion());
+  BuildIcons();
+  SetIcon(m_icons[0], _T ("WinSplit Revolution ") + wxGetApp().GetVersion());
 }
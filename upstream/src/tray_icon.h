@@ -1,15 +1,34 @@
 #ifndef __TASKBARICON__
 #define __TASKBARICON__
 
+#include <wx/icon.h>
 #include <wx/image.h>
 #include <wx/taskbar.h>
 #include <wx/timer.h>
 
+#include <map>
+#include <vector>
+
+#include "settingsmanager.h"
+
 class VirtualNumpad;
 class HotkeysManager;
-class SettingsManager;
 class ReadVersionThread;
 
+#define NB_TRAY_FRAMES 6
+
+enum MENU_IMAGE {
+  MENU_IMG_ABOUT,
+  MENU_IMG_HELP,
+  MENU_IMG_OPTIONS,
+  MENU_IMG_LAYOUT,
+  MENU_IMG_HOTKEYS,
+  MENU_IMG_AUTOSTART_FALSE,
+  MENU_IMG_AUTOSTART_TRUE,
+  MENU_IMG_EXIT
+};
+#define NB_MENU_IMAGES 8
+
 enum Identifiers_tray {
   ID_MENU_ABOUT = 1000,
   ID_MENU_HK,
@@ -18,32 +37,47 @@ enum Identifiers_tray {
   ID_MENU_AUTOBOOT,
   ID_MENU_QUIT,
   ID_TIMER,
-  ID_MENU_HELP
+  ID_MENU_HELP,
+  ID_MENU_SPREAD_ROUND_ROBIN,
+  ID_MENU_SPREAD_PROCESS,
+  ID_MENU_SPREAD_LAST_KNOWN,
+  ID_MENU_GATHER, // one id per monitor, up to ID_MENU_GATHER_LAST
+  ID_MENU_GATHER_LAST = ID_MENU_GATHER + 15,
+  ID_UPDATE_CHECKED
 };
 
 class TrayIcon : public wxTaskBarIcon {
 private:
   bool m_autoStart;
   bool m_cleanedUp;
+  bool m_imagesLoaded;
   VirtualNumpad* p_virtNumpad;
   HotkeysManager* p_hotkeys;
   SettingsManager& m_options;
   ReadVersionThread* p_updateThread;
+  unsigned int m_settingsListener;
 
+  // Update check animation
   wxTimer m_timer;
-  // int iconupdate;
+  wxIcon m_icons[NB_TRAY_FRAMES];
+  int m_iconSize; // of m_icons, 0 until built
+  int m_frame;
+  int m_frameStep;
 
-  wxImage im_about;
-  wxImage im_help;
-  wxImage im_hotkeys;
-  wxImage im_layout_settings;
-  wxImage im_options;
-  wxImage im_startwin_true;
-  wxImage im_startwin_false;
-  wxImage im_exit;
+  // Menu images as read (drawn for 96 DPI), then scaled once per DPI on first use
+  wxImage m_menuImages[NB_MENU_IMAGES];
+  std::map<unsigned int, std::vector<wxBitmap> > m_menuBitmaps;
 
 private:
   void OnTimer(wxTimerEvent& event);
+  // Start the thread and the animation if an update check is due
+  void StartUpdateCheck();
+  // Posted by the update thread once done
+  void OnUpdateChecked(wxThreadEvent& event);
+  // The icon and the animation frames at the current DPI (rebuilt if it changed)
+  void BuildIcons();
+  // A menu image at 'dpi', from the cache
+  const wxBitmap& GetMenuBitmap(MENU_IMAGE image, unsigned int dpi);
   virtual wxMenu* CreatePopupMenu();
   void OnMenuClickAbout(wxCommandEvent&);
   void OnMenuClickHelp(wxCommandEvent&);
@@ -51,7 +85,15 @@ private:
   void OnMenuClickLayout(wxCommandEvent& event);
   void OnMenuClickAutoStart(wxCommandEvent&);
   void OnMenuClickConfigureHK(wxCommandEvent& event);
+  void OnMenuClickGather(wxCommandEvent& event);
+  void OnMenuClickSpread(wxCommandEvent& event);
   void OnMenuClickQuit(wxCommandEvent&);
+  // The directory watcher replaced the configuration store
+  void OnConfigReloaded();
+  // A setting changed: the numpad and the Drag'N'Go hook follow it
+  void OnSettingChanged(SETTING_ID setting);
+  // The virtual numpad, created on first use
+  VirtualNumpad* GetVirtualNumpad();
 
 public:
   TrayIcon();
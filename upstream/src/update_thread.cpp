@@ -29,16 +29,20 @@ static const wchar_t* GITHUB_API_HOST = L"api.github.com";
 static const wchar_t* GITHUB_API_PATH = L"/repos/x-vibe/winsplit-revolution-revived/releases/latest";
 static const wchar_t* GITHUB_RELEASES_URL = L"https://github.com/x-vibe/winsplit-revolution-revived/releases";
 
-ReadVersionThread::ReadVersionThread(const unsigned int& timeout)
+ReadVersionThread::ReadVersionThread(const unsigned int& timeout, wxEvtHandler* handler,
+                                     int eventId)
     : wxThread(wxTHREAD_JOINABLE)
     , m_options(SettingsManager::Get())
     , m_flagForceChecking(false)
     , m_host_version(0.)
+    , m_answered(false)
     , m_strVersion()
     , m_strReleaseUrl(GITHUB_RELEASES_URL)
     , m_strReleaseNotes()
     , m_timeout(timeout)
     , m_hInternet(NULL)
+    , p_handler(handler)
+    , m_eventId(eventId)
 {
 }
 
@@ -141,8 +145,18 @@ static double ParseVersion(const wxString& versionStr)
 
 void* ReadVersionThread::Entry()
 {
-  if (!HaveToCheck()) {
-    return nullptr;
+  Check();
+
+  if (p_handler)
+    wxQueueEvent(p_handler, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+
+  return nullptr;
+}
+
+void ReadVersionThread::Check()
+{
+  if (!IsCheckDue()) {
+    return;
   }
 
   // SECURITY: Use WinInet for HTTPS support
@@ -152,13 +166,13 @@ void* ReadVersionThread::Entry()
       NULL, NULL, 0);
 
   if (!m_hInternet) {
-    return nullptr;
+    return;
   }
 
   if (TestDestroy()) {
     InternetCloseHandle(m_hInternet);
     m_hInternet = NULL;
-    return nullptr;
+    return;
   }
 
   // Connect to GitHub API over HTTPS
@@ -173,14 +187,14 @@ void* ReadVersionThread::Entry()
   if (!hConnect) {
     InternetCloseHandle(m_hInternet);
     m_hInternet = NULL;
-    return nullptr;
+    return;
   }
 
   if (TestDestroy()) {
     InternetCloseHandle(hConnect);
     InternetCloseHandle(m_hInternet);
     m_hInternet = NULL;
-    return nullptr;
+    return;
   }
 
   // Create HTTPS request
@@ -199,7 +213,7 @@ void* ReadVersionThread::Entry()
     InternetCloseHandle(hConnect);
     InternetCloseHandle(m_hInternet);
     m_hInternet = NULL;
-    return nullptr;
+    return;
   }
 
   // GitHub API requires User-Agent header
@@ -222,7 +236,7 @@ void* ReadVersionThread::Entry()
     m_hInternet = NULL;
     if (h)
       InternetCloseHandle(h);
-    return nullptr;
+    return;
   }
 
   // Read response
@@ -245,7 +259,7 @@ void* ReadVersionThread::Entry()
     InternetCloseHandle(h);
 
   if (TestDestroy()) {
-    return nullptr;
+    return;
   }
 
   // Parse JSON response
@@ -257,6 +271,7 @@ void* ReadVersionThread::Entry()
     if (!tagName.IsEmpty()) {
       m_strVersion = tagName;
       m_host_version = ParseVersion(tagName);
+      m_answered = true;
     }
 
     // Extract release URL
@@ -271,8 +286,6 @@ void* ReadVersionThread::Entry()
       m_strReleaseNotes = body;
     }
   }
-
-  return nullptr;
 }
 
 void ReadVersionThread::ForceChecking()
@@ -280,9 +293,9 @@ void ReadVersionThread::ForceChecking()
   m_flagForceChecking = true;
 }
 
-bool ReadVersionThread::HaveToCheck()
+bool ReadVersionThread::IsCheckDue()
 {
-  time_t now, last, tmp;
+  time_t now, last;
   struct tm timeinfo_last;
   struct tm timeinfo_now;
 
@@ -295,7 +308,6 @@ bool ReadVersionThread::HaveToCheck()
     return true;
 
   time(&now);
-  tmp = now;
   last = m_options.getLastCheckDate();
 
   timeinfo_now = *(localtime(&now));
@@ -303,25 +315,21 @@ bool ReadVersionThread::HaveToCheck()
 
   if ((timeinfo_now.tm_mon != timeinfo_last.tm_mon) &&
       (m_options.getUpdateCheckFrequency() == CHECK_UPDATES_MONTHLY)) {
-    m_options.setLastCheckDate(tmp);
     return true;
   }
 
   if (m_options.getUpdateCheckFrequency() == CHECK_UPDATES_WEEKLY) {
     if ((timeinfo_now.tm_mday == timeinfo_last.tm_mday) &&
         ((timeinfo_now.tm_mon != timeinfo_last.tm_mon))) {
-      m_options.setLastCheckDate(tmp);
       return true;
     }
 
     if ((timeinfo_now.tm_mday - timeinfo_last.tm_mday) >= 7) {
-      m_options.setLastCheckDate(tmp);
       return true;
     }
 
     if (timeinfo_now.tm_mday < timeinfo_last.tm_mday) {
       if ((30 + timeinfo_now.tm_mday - timeinfo_last.tm_mday) >= 7) {
-        m_options.setLastCheckDate(tmp);
         return true;
       }
     }
@@ -9,6 +9,7 @@
 
 #include "settingsmanager.h"
 
+#include <wx/event.h>
 #include <wx/tokenzr.h>
 
 /**
@@ -22,18 +23,30 @@ private:
   SettingsManager& m_options;
   bool m_flagForceChecking;
   double m_host_version;
+  bool m_answered; // the release query returned a version
   wxString m_strVersion;
   wxString m_strReleaseUrl;
   wxString m_strReleaseNotes;
   unsigned int m_timeout;
   HINTERNET m_hInternet;  // Stored for external cancellation during shutdown
+  wxEvtHandler* p_handler; // Notified when the check is over, may be NULL
+  int m_eventId;
+
+  void Check();
 
 public:
-  ReadVersionThread(const unsigned int& timeout);
+  // Once done, the thread posts a wxEVT_THREAD event with 'eventId' to 'handler', so the
+  // owner does not have to poll IsRunning()
+  ReadVersionThread(const unsigned int& timeout, wxEvtHandler* handler = NULL,
+                    int eventId = wxID_ANY);
   ~ReadVersionThread();
 
   void ForceChecking();
-  bool HaveToCheck();
+  // True if a check is forced or due according to the settings; changes nothing, the
+  // owner writes the date of the last check once HasAnswer()
+  bool IsCheckDue();
+  // After Wait(): the check reached the server and got a version
+  bool HasAnswer() { return m_answered; }
 
   // Cancel blocking network I/O (safe to call from another thread)
   void Cancel();
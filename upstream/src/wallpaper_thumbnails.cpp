@@ -0,0 +1,272 @@
+#include "wallpaper_thumbnails.h"
+
+#include "debug_log.h"
+#include "main.h"
+#include "settingsmanager.h"
+
+#include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+using namespace std;
+
+WallpaperThumbnails* WallpaperThumbnails::p_instance = NULL;
+
+namespace {
+  const wxChar* THUMBNAILS_DIR = _T ("thumbnails");
+
+  // FNV-1a: the file names must stay the same from one run to the next
+  unsigned long long Hash(const wxString& text)
+  {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (wxString::const_iterator it = text.begin(); it != text.end(); ++it) {
+      hash ^= (unsigned long long)(wxChar)*it;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+}
+
+WallpaperThumbnails::WorkerThread::WorkerThread(WallpaperThumbnails& thumbnails)
+    : wxThread(wxTHREAD_JOINABLE)
+    , m_thumbnails(thumbnails)
+{
+}
+
+void* WallpaperThumbnails::WorkerThread::Entry()
+{
+  for (;;) {
+    Job job;
+    {
+      wxCriticalSectionLocker locker(m_thumbnails.m_lock);
+      if (m_thumbnails.m_exit)
+        break;
+
+      if (!m_thumbnails.m_queue.empty()) {
+        job = m_thumbnails.m_queue.front();
+        m_thumbnails.m_queue.pop_front();
+      }
+      else {
+        job.id = 0;
+      }
+    }
+
+    if (job.id == 0) {
+      // Idle until the next Request()
+      WaitForSingleObject(m_thumbnails.m_wake, INFINITE);
+      continue;
+    }
+
+    m_thumbnails.Process(job);
+
+    {
+      wxCriticalSectionLocker locker(m_thumbnails.m_lock);
+      m_thumbnails.m_done.push_back(job);
+    }
+    m_thumbnails.CallAfter(&WallpaperThumbnails::OnDone);
+  }
+
+  return NULL;
+}
+
+WallpaperThumbnails::WallpaperThumbnails()
+    : m_directory()
+    , m_wake(CreateEvent(NULL, FALSE, FALSE, NULL))
+    , p_thread(NULL)
+    , m_lock()
+    , m_queue()
+    , m_done()
+    , m_exit(false)
+    , m_bitmaps()
+    , m_requests()
+    , m_lastId(0)
+{
+  wxFileName dir(SettingsManager::Get().GetDataDirectory(), wxEmptyString);
+  dir.AppendDir(THUMBNAILS_DIR);
+  m_directory = dir.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+
+  // The worker reads and writes PNG and reads any wallpaper format
+  wxGetApp().InitImageHandlers();
+
+  p_thread = new WorkerThread(*this);
+  if (p_thread->Create() != wxTHREAD_NO_ERROR || p_thread->Run() != wxTHREAD_NO_ERROR) {
+    delete p_thread;
+    p_thread = NULL;
+  }
+}
+
+WallpaperThumbnails::~WallpaperThumbnails()
+{
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_exit = true;
+  }
+
+  // A wallpaper being loaded is finished first; the queued ones are dropped
+  if (p_thread) {
+    SetEvent(m_wake);
+    p_thread->Wait();
+    delete p_thread;
+  }
+
+  if (m_wake)
+    CloseHandle(m_wake);
+}
+
+WallpaperThumbnails* WallpaperThumbnails::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new WallpaperThumbnails();
+
+  return p_instance;
+}
+
+void WallpaperThumbnails::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+wxString WallpaperThumbnails::GetPrefix(const wxSize& size)
+{
+  return wxString::Format(_T ("wallpaper_%dx%d_"), size.GetWidth(), size.GetHeight());
+}
+
+wxString WallpaperThumbnails::GetFileName(const wxString& path, const wxDateTime& modified,
+                                          const wxSize& size)
+{
+  wxString key = path.Lower() + _T ("|") + modified.GetValue().ToString();
+  return GetPrefix(size) + wxString::Format(_T ("%016llx.png"), Hash(key));
+}
+
+int WallpaperThumbnails::Request(const wxString& path, const wxSize& size,
+                                 const ThumbnailReady& ready)
+{
+  wxDateTime modified;
+  {
+    wxLogNull noLog;
+    modified = wxFileName(path).GetModificationTime();
+  }
+  if (!modified.IsValid()) {
+    ready(wxNullBitmap);
+    return 0;
+  }
+
+  Job job;
+  job.name = GetFileName(path, modified, size);
+
+  map<wxString, wxBitmap>::const_iterator it = m_bitmaps.find(job.name);
+  if (it != m_bitmaps.end()) {
+    ready(it->second);
+    return 0;
+  }
+
+  job.id = ++m_lastId;
+  job.path = path;
+  job.size = size;
+  m_requests[job.id] = ready;
+
+  if (!p_thread) {
+    // No worker: generate it here, as before
+    Process(job);
+    m_done.push_back(job);
+    OnDone();
+    return 0;
+  }
+
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    m_queue.push_back(job);
+  }
+  SetEvent(m_wake);
+
+  return job.id;
+}
+
+void WallpaperThumbnails::Cancel(int id)
+{
+  m_requests.erase(id);
+}
+
+void WallpaperThumbnails::Process(Job& job)
+{
+  // Unreadable files stay in the debug log: no message box from this thread
+  wxLogNull noLog;
+
+  wxString file = m_directory + job.name;
+  wxImage image;
+  if (wxFileExists(file))
+    image.LoadFile(file, wxBITMAP_TYPE_PNG);
+
+  if (!image.IsOk() || image.GetSize() != job.size) {
+    wxImage wallpaper;
+    if (!wallpaper.LoadFile(job.path, wxBITMAP_TYPE_ANY)) {
+      DEBUG_LOG_FMT("WallpaperThumbnails: cannot read %ls", job.path.wc_str());
+      return;
+    }
+
+    image = wallpaper.Scale(job.size.GetWidth(), job.size.GetHeight(),
+                            wxIMAGE_QUALITY_BOX_AVERAGE);
+    Save(image, job);
+  }
+
+  // The UI thread gets the only reference: wxImage reference counts are not atomic
+  job.image = make_shared<wxImage>(image.Copy());
+}
+
+void WallpaperThumbnails::Save(const wxImage& image, const Job& job)
+{
+  if (!wxDirExists(m_directory) && !wxFileName::Mkdir(m_directory, wxS_DIR_DEFAULT,
+                                                       wxPATH_MKDIR_FULL))
+    return;
+
+  // The previous thumbnails of this size are of former wallpapers
+  wxArrayString files;
+  wxDir::GetAllFiles(m_directory, &files, GetPrefix(job.size) + _T ("*.png"), wxDIR_FILES);
+  for (size_t i = 0; i < files.GetCount(); ++i)
+    wxRemoveFile(files[i]);
+
+  // Written aside then renamed: a thumbnail is whole or missing
+  wxString file = m_directory + job.name;
+  wxString temp = file + _T (".tmp");
+  if (!image.SaveFile(temp, wxBITMAP_TYPE_PNG) || !wxRenameFile(temp, file, true)) {
+    wxRemoveFile(temp);
+    DEBUG_LOG_FMT("WallpaperThumbnails: cannot save %ls", file.wc_str());
+  }
+}
+
+void WallpaperThumbnails::OnDone()
+{
+  vector<Job> done;
+  {
+    wxCriticalSectionLocker locker(m_lock);
+    done.swap(m_done);
+  }
+
+  for (size_t i = 0; i < done.size(); ++i) {
+    wxBitmap bmp;
+    if (done[i].image) {
+      bmp = wxBitmap(*done[i].image);
+
+      // One wallpaper at a time per size
+      wxString prefix = GetPrefix(done[i].size);
+      map<wxString, wxBitmap>::iterator it = m_bitmaps.begin();
+      while (it != m_bitmaps.end()) {
+        if (it->first.StartsWith(prefix))
+          it = m_bitmaps.erase(it);
+        else
+          ++it;
+      }
+      m_bitmaps[done[i].name] = bmp;
+    }
+
+    map<int, ThumbnailReady>::iterator request = m_requests.find(done[i].id);
+    if (request == m_requests.end())
+      continue; // cancelled
+
+    ThumbnailReady ready = request->second;
+    m_requests.erase(request);
+    ready(bmp);
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef __WALLPAPER_THUMBNAILS_H__
+#define __WALLPAPER_THUMBNAILS_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/bitmap.h>
+#include <wx/event.h>
+#include <wx/image.h>
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+class wxDateTime;
+
+typedef std::function<void(const wxBitmap&)> ThumbnailReady;
+
+// Thumbnails of the desktop wallpaper for the layout preview. A wallpaper is often a large
+// JPEG: loading and scaling it on the UI thread delayed the layout dialog by a second or more.
+// A worker thread reads the thumbnail saved in the "thumbnails" folder of the data directory,
+// or loads the wallpaper, shrinks it with a box filter and saves the result. A thumbnail is
+// identified by the path, the modification time of the wallpaper and its size, so a new
+// wallpaper or an edited file makes a new one. The UI thread keeps the last thumbnail of each
+// size in memory.
+class WallpaperThumbnails : public wxEvtHandler // Singleton class
+{
+private:
+  class WorkerThread : public wxThread {
+  private:
+    WallpaperThumbnails& m_thumbnails;
+
+  public:
+    WorkerThread(WallpaperThumbnails& thumbnails);
+    void* Entry();
+  };
+
+  struct Job {
+    int id;
+    wxString path;
+    wxSize size;
+    wxString name;                  // file name of the thumbnail
+    std::shared_ptr<wxImage> image; // result, NULL if the wallpaper cannot be read
+  };
+
+  static WallpaperThumbnails* p_instance;
+
+  wxString m_directory;
+  HANDLE m_wake; // set when a job is queued or on exit
+  WorkerThread* p_thread;
+
+  wxCriticalSection m_lock; // guards the members below
+  std::deque<Job> m_queue;
+  std::vector<Job> m_done;
+  bool m_exit;
+
+  // UI thread only
+  std::map<wxString, wxBitmap> m_bitmaps; // by file name
+  std::map<int, ThumbnailReady> m_requests;
+  int m_lastId;
+
+  WallpaperThumbnails();
+  ~WallpaperThumbnails();
+
+  static wxString GetPrefix(const wxSize& size);
+  static wxString GetFileName(const wxString& path, const wxDateTime& modified,
+                              const wxSize& size);
+
+  // Worker thread
+  void Process(Job& job);
+  void Save(const wxImage& image, const Job& job);
+  // UI thread
+  void OnDone();
+
+public:
+  static WallpaperThumbnails* GetInstance();
+  static void DeleteInstance();
+
+  // The thumbnail of the image 'path' at 'size'. 'ready' is called at once when it is in
+  // memory (returns 0), otherwise later on the UI thread (returns the id of the request).
+  // The bitmap is invalid if the wallpaper cannot be read.
+  int Request(const wxString& path, const wxSize& size, const ThumbnailReady& ready);
+  // 'ready' will not be called
+  void Cancel(int id);
+};
+
+#endif // __WALLPAPER_THUMBNAILS_H__
@@ -0,0 +1,139 @@
+#include "window_geometry.h"
+
+#include "dwm_utils.h"
+
+using namespace std;
+
+WindowGeometryCache* WindowGeometryCache::p_instance = NULL;
+
+namespace {
+  // A hung window must not stall a batch: WM_GETMINMAXINFO gives up after this delay (ms)
+  const UINT MINMAXINFO_TIMEOUT = 50;
+}
+
+WindowGeometryCache::WindowGeometryCache()
+    : m_entries()
+    , m_index()
+{
+}
+
+WindowGeometryCache* WindowGeometryCache::GetInstance()
+{
+  if (!p_instance)
+    p_instance = new WindowGeometryCache();
+
+  return p_instance;
+}
+
+void WindowGeometryCache::DeleteInstance()
+{
+  delete p_instance;
+  p_instance = NULL;
+}
+
+void WindowGeometryCache::NextEpoch()
+{
+  m_entries.clear();
+  m_index.clear();
+}
+
+void WindowGeometryCache::Invalidate(HWND hwnd)
+{
+  unordered_map<HWND, size_t>::iterator it = m_index.find(hwnd);
+
+  if (it != m_index.end())
+    m_entries[it->second].fields = 0;
+}
+
+void WindowGeometryCache::Read(WindowGeometry& geometry, int fields)
+{
+  HWND hwnd = geometry.hwnd;
+  RECT window_rect;
+
+  if ((fields & GEOMETRY_BASIC) && !(geometry.fields & GEOMETRY_BASIC)) {
+    geometry.valid = IsWindow(hwnd) && GetWindowRect(hwnd, &window_rect);
+    if (!geometry.valid) {
+      geometry.fields = GEOMETRY_ALL;
+      return;
+    }
+
+    geometry.rect = wxRect(window_rect.left,
+                           window_rect.top,
+                           window_rect.right - window_rect.left,
+                           window_rect.bottom - window_rect.top);
+    geometry.style = GetWindowLong(hwnd, GWL_STYLE);
+    geometry.exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
+    geometry.dpi = DwmUtils::GetDpiForHwnd(hwnd);
+    geometry.perMonitorAware = DwmUtils::IsPerMonitorDpiAware(hwnd);
+
+    // Borders come from the frame cache: DWM is only queried for a window (or frame style,
+    // or DPI) not seen before
+    DwmUtils::GetInvisibleFrameBorders(hwnd,
+                                       geometry.border_left,
+                                       geometry.border_top,
+                                       geometry.border_right,
+                                       geometry.border_bottom);
+
+    geometry.visible = wxRect(geometry.rect.x + geometry.border_left,
+                              geometry.rect.y + geometry.border_top,
+                              geometry.rect.width - geometry.border_left - geometry.border_right,
+                              geometry.rect.height - geometry.border_top - geometry.border_bottom);
+    geometry.fields |= GEOMETRY_BASIC;
+  }
+
+  if ((fields & GEOMETRY_TRACK_SIZE) && !(geometry.fields & GEOMETRY_TRACK_SIZE)) {
+    MINMAXINFO info;
+    ZeroMemory(&info, sizeof(info));
+    info.ptMinTrackSize.x = GetSystemMetrics(SM_CXMINTRACK);
+    info.ptMinTrackSize.y = GetSystemMetrics(SM_CYMINTRACK);
+    info.ptMaxTrackSize.x = GetSystemMetrics(SM_CXMAXTRACK);
+    info.ptMaxTrackSize.y = GetSystemMetrics(SM_CYMAXTRACK);
+
+    DWORD_PTR result;
+    SendMessageTimeout(hwnd,
+                       WM_GETMINMAXINFO,
+                       0,
+                       (LPARAM)&info,
+                       SMTO_ABORTIFHUNG | SMTO_BLOCK,
+                       MINMAXINFO_TIMEOUT,
+                       &result);
+
+    geometry.minTrack = wxSize(info.ptMinTrackSize.x, info.ptMinTrackSize.y);
+    geometry.maxTrack = wxSize(info.ptMaxTrackSize.x, info.ptMaxTrackSize.y);
+    geometry.fields |= GEOMETRY_TRACK_SIZE;
+  }
+}
+
+void WindowGeometryCache::Query(const vector<HWND>& windows, vector<WindowGeometry>& result,
+                                int fields)
+{
+  result.clear();
+  result.reserve(windows.size());
+
+  for (size_t i = 0; i < windows.size(); ++i) {
+    unordered_map<HWND, size_t>::iterator it = m_index.find(windows[i]);
+
+    if (it == m_index.end()) {
+      WindowGeometry geometry = WindowGeometry();
+      geometry.hwnd = windows[i];
+
+      it = m_index.insert(make_pair(windows[i], m_entries.size())).first;
+      m_entries.push_back(geometry);
+    }
+
+    WindowGeometry& geometry = m_entries[it->second];
+    if ((geometry.fields & fields) != fields)
+      Read(geometry, fields);
+
+    result.push_back(geometry);
+  }
+}
+
+WindowGeometry WindowGeometryCache::Query(HWND hwnd, int fields)
+{
+  vector<HWND> windows(1, hwnd);
+  vector<WindowGeometry> result;
+
+  Query(windows, result, fields);
+  return result[0];
+}
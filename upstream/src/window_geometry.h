@@ -0,0 +1,84 @@
+#ifndef __WINDOW_GEOMETRY_H__
+#define __WINDOW_GEOMETRY_H__
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#include <wx/gdicmn.h>
+
+#include <unordered_map>
+#include <vector>
+
+// Attributes to gather, the track sizes cost a message to the window's thread
+#define GEOMETRY_BASIC 0x01
+#define GEOMETRY_TRACK_SIZE 0x02
+#define GEOMETRY_ALL (GEOMETRY_BASIC | GEOMETRY_TRACK_SIZE)
+
+struct WindowGeometry {
+  HWND hwnd;
+  bool valid; // false if the window no longer exists
+  wxRect rect;    // GetWindowRect
+  wxRect visible; // without the invisible frame (DWM compensated)
+  LONG border_left;
+  LONG border_top;
+  LONG border_right;
+  LONG border_bottom;
+  UINT dpi;
+  LONG style;
+  LONG exStyle;
+  bool perMonitorAware;
+  wxSize minTrack; // WM_GETMINMAXINFO, only with GEOMETRY_TRACK_SIZE
+  wxSize maxTrack;
+  int fields; // GEOMETRY_* gathered in this epoch
+
+  bool IsMaximized() const { return (style & WS_MAXIMIZE) != 0; }
+  bool IsMinimized() const { return (style & WS_MINIMIZE) != 0; }
+  bool IsResizable() const { return (style & WS_SIZEBOX) != 0; }
+  bool IsTopMost() const { return (exStyle & WS_EX_TOPMOST) != 0; }
+
+  // Window rect giving these visible bounds, from the borders already gathered
+  wxRect WindowRectFor(const wxRect& bounds) const
+  {
+    return wxRect(bounds.x - border_left,
+                  bounds.y - border_top,
+                  bounds.width + border_left + border_right,
+                  bounds.height + border_top + border_bottom);
+  }
+};
+
+// Geometry of many windows gathered in one pass. Results are kept for the current
+// event epoch: the actions touching several windows (hotkey, batch move, layout restore)
+// start a new epoch, and the windows moved through PlacementBatcher are invalidated,
+// so an action reads each window once whatever the number of helpers involved.
+class WindowGeometryCache // Singleton class
+{
+private:
+  static WindowGeometryCache* p_instance;
+
+  std::vector<WindowGeometry> m_entries;    // contiguous, one per window read
+  std::unordered_map<HWND, size_t> m_index; // hwnd -> position in m_entries
+
+  WindowGeometryCache();
+  ~WindowGeometryCache() {}
+
+  void Read(WindowGeometry& geometry, int fields);
+
+public:
+  static WindowGeometryCache* GetInstance();
+  static void DeleteInstance();
+
+  // Everything read before is stale from now on (storage is kept for the next pass)
+  void NextEpoch();
+  // A window moved or changed style within the epoch
+  void Invalidate(HWND hwnd);
+
+  // Geometry of the windows, in the order given; only the windows not read yet in this
+  // epoch (or missing 'fields') are queried
+  void Query(const std::vector<HWND>& windows, std::vector<WindowGeometry>& result,
+             int fields = GEOMETRY_BASIC);
+  WindowGeometry Query(HWND hwnd, int fields = GEOMETRY_BASIC);
+};
+
+#endif // __WINDOW_GEOMETRY_H__